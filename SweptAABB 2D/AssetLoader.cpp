@@ -0,0 +1,648 @@
+/*
+Title: Swept AABB-2D
+File Name: AssetLoader.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _ASSET_LOADER_CPP
+#define _ASSET_LOADER_CPP
+
+#include "AssetLoader.h"
+#include "FramePacer.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+// Reads the text mesh format described in AssetLoader.h.
+static bool readMeshFile(const std::string& path, MeshData& mesh, std::string& error)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		error = "couldn't open " + path;
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		std::istringstream words(line);
+		std::string kind;
+		if (!(words >> kind) || kind[0] == '#')
+		{
+			continue;
+		}
+
+		if (kind == "v")
+		{
+			VertexFormat vertex;
+			if (!(words >> vertex.position.x >> vertex.position.y >> vertex.position.z >> vertex.color.r >> vertex.color.g >> vertex.color.b >> vertex.color.a))
+			{
+				error = path + ":" + std::to_string(lineNumber) + ": a vertex needs a position and a color";
+				return false;
+			}
+			mesh.vertices.push_back(vertex);
+		}
+		else if (kind == "f")
+		{
+			GLuint triangle[3];
+			if (!(words >> triangle[0] >> triangle[1] >> triangle[2]))
+			{
+				error = path + ":" + std::to_string(lineNumber) + ": a triangle needs three indices";
+				return false;
+			}
+			mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+		}
+		else
+		{
+			error = path + ":" + std::to_string(lineNumber) + ": unknown line '" + kind + "'";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The folder a file is in, with the trailing slash, or empty if the path has none.
+static std::string directoryOf(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+AssetLoader::AssetLoader(ModelRegistry& models) : registry(models)
+{
+	stopping = false;
+	dropCPUData = false;
+}
+
+AssetLoader::~AssetLoader()
+{
+	// The models need OpenGL to be released, so that's left to Cleanup(). The threads mustn't outlive us, though.
+	std::unique_lock<std::mutex> guard(lock);
+	stopping = true;
+	guard.unlock();
+	jobAdded.notify_all();
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void AssetLoader::Init(unsigned int threads)
+{
+	if (threads == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threads = cores > 1 ? cores - 1 : 1;
+	}
+
+	stopping = false;
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		workers.push_back(std::thread(&AssetLoader::WorkerLoop, this));
+	}
+}
+
+void AssetLoader::Cleanup()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	stopping = true;
+	jobs.clear();
+	guard.unlock();
+	jobAdded.notify_all();
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+
+	for (unsigned int i = 0; i < assets.size(); i++)
+	{
+		if (assets[i]->model != nullptr)
+		{
+			registry.Release(assets[i]->model);
+		}
+		delete(assets[i]);
+	}
+	for (unsigned int i = 0; i < scenes.size(); i++)
+	{
+		delete(scenes[i]);
+	}
+	assets.clear();
+	scenes.clear();
+	decoded.clear();
+}
+
+void AssetLoader::WorkerLoop()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		jobAdded.wait(guard, [this] { return stopping || !jobs.empty(); });
+		if (stopping)
+		{
+			return;
+		}
+
+		Job job = jobs.front();
+		jobs.pop_front();
+		guard.unlock();
+
+		if (job.scene)
+		{
+			DecodeScene(job.id);
+		}
+		else
+		{
+			Decode(job.id);
+		}
+	}
+}
+
+void AssetLoader::Enqueue(bool scene, unsigned int id)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	Job job = { scene, id };
+	jobs.push_back(job);
+	guard.unlock();
+	jobAdded.notify_one();
+}
+
+AssetLoader::Asset* AssetLoader::GetAsset(AssetId id)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return id < assets.size() ? assets[id] : nullptr;
+}
+
+AssetLoader::Scene* AssetLoader::GetScene(SceneId id)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return id < scenes.size() ? scenes[id] : nullptr;
+}
+
+AssetId AssetLoader::AddAsset(const std::string& path, MeshDecoder decoder, VertexLayout layout)
+{
+	Asset* asset = new Asset();
+	asset->path = path;
+	asset->decoder = decoder;
+	asset->layout = layout;
+	asset->state = ASSET_QUEUED;
+	asset->model = nullptr;
+	asset->shared = false;
+	asset->vertexBytesDone = 0;
+	asset->indexBytesDone = 0;
+
+	std::unique_lock<std::mutex> guard(lock);
+	AssetId id = (AssetId)assets.size();
+	assets.push_back(asset);
+	guard.unlock();
+
+	Enqueue(false, id);
+	return id;
+}
+
+AssetId AssetLoader::LoadMesh(const std::string& path, VertexLayout layout)
+{
+	return AddAsset(path, MeshDecoder(), layout);
+}
+
+AssetId AssetLoader::LoadMesh(const std::string& name, MeshDecoder decoder, VertexLayout layout)
+{
+	return AddAsset(name, decoder, layout);
+}
+
+SceneId AssetLoader::LoadScene(const std::string& path)
+{
+	Scene* scene = new Scene();
+	scene->path = path;
+	scene->state = ASSET_QUEUED;
+
+	std::unique_lock<std::mutex> guard(lock);
+	SceneId id = (SceneId)scenes.size();
+	scenes.push_back(scene);
+	guard.unlock();
+
+	Enqueue(true, id);
+	return id;
+}
+
+// Runs on a loader thread: reads the mesh, makes its (CPU only) model, and packs the bytes the GPU buffers will hold.
+// What's left for Update() is only the copy into OpenGL, unless the registry already has the mesh, in which case there's nothing left at all.
+void AssetLoader::Decode(AssetId id)
+{
+	Asset* asset = GetAsset(id);
+	asset->state = ASSET_DECODING;
+
+	// The model takes the decoded vertices and indices over as they are instead of copying them, and lets go of them (by dropping
+	// its reference) when it's deleted or drops its CPU copy.
+	std::shared_ptr<MeshData> decodedMesh = std::make_shared<MeshData>();
+	MeshData& mesh = *decodedMesh;
+	bool decodedOK = asset->decoder ? asset->decoder(mesh) : readMeshFile(asset->path, mesh, asset->error);
+	if (decodedOK && mesh.vertices.empty())
+	{
+		asset->error = asset->path + ": no vertices";
+		decodedOK = false;
+	}
+	if (decodedOK)
+	{
+		for (unsigned int i = 0; i < mesh.indices.size(); i++)
+		{
+			if (mesh.indices[i] >= mesh.vertices.size())
+			{
+				asset->error = asset->path + ": index " + std::to_string(mesh.indices[i]) + " is past the last vertex";
+				decodedOK = false;
+				break;
+			}
+		}
+	}
+	if (!decodedOK)
+	{
+		if (asset->error.empty())
+		{
+			asset->error = asset->path + ": couldn't be decoded";
+		}
+		asset->state = ASSET_FAILED;
+		return;
+	}
+
+	ModelSpan<VertexFormat> vertices = { mesh.vertices.data(), (int)mesh.vertices.size() };
+	ModelSpan<GLuint> indices = { mesh.indices.empty() ? nullptr : mesh.indices.data(), (int)mesh.indices.size() };
+	Model* model = new Model(vertices, indices, [decodedMesh]() mutable { decodedMesh.reset(); }, asset->layout, false);
+	unsigned long long hash = ModelRegistry::Hash(model);
+	model->Stage(asset->staging);
+
+	// Interning and queueing happen together, so a mesh is always queued before any duplicate of it that comes along later.
+	// That way, by the time Update() gets to a duplicate, the original is already on the GPU.
+	std::lock_guard<std::mutex> guard(lock);
+	asset->model = registry.Intern(model, hash);
+	asset->shared = asset->model != model;
+	if (asset->shared)
+	{
+		asset->staging = ModelStaging();
+	}
+	asset->state = ASSET_UPLOADING;
+	decoded.push_back(id);
+}
+
+// Runs on a loader thread: reads the scene file and queues up each mesh it lists.
+void AssetLoader::DecodeScene(SceneId id)
+{
+	Scene* scene = GetScene(id);
+	scene->state = ASSET_DECODING;
+
+	std::ifstream file(scene->path);
+	if (!file)
+	{
+		scene->error = "couldn't open " + scene->path;
+		scene->state = ASSET_FAILED;
+		return;
+	}
+
+	std::string folder = directoryOf(scene->path);
+	std::map<std::string, unsigned int> meshNames;
+	std::vector<std::string> meshPaths;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		std::istringstream words(line);
+		std::string kind;
+		if (!(words >> kind) || kind[0] == '#')
+		{
+			continue;
+		}
+
+		std::string name;
+		if (kind == "mesh")
+		{
+			std::string path;
+			if (!(words >> name >> path))
+			{
+				scene->error = scene->path + ":" + std::to_string(lineNumber) + ": a mesh needs a name and a path";
+				break;
+			}
+			meshNames[name] = (unsigned int)meshPaths.size();
+			meshPaths.push_back(folder + path);
+		}
+		else if (kind == "object")
+		{
+			SceneObject object;
+			if (!(words >> name >> object.position.x >> object.position.y >> object.position.z >> object.velocity.x >> object.velocity.y >> object.velocity.z
+				>> object.scale.x >> object.scale.y >> object.scale.z))
+			{
+				scene->error = scene->path + ":" + std::to_string(lineNumber) + ": an object needs a mesh, a position, a velocity and a scale";
+				break;
+			}
+
+			std::map<std::string, unsigned int>::iterator found = meshNames.find(name);
+			if (found == meshNames.end())
+			{
+				scene->error = scene->path + ":" + std::to_string(lineNumber) + ": no mesh called '" + name + "' above this line";
+				break;
+			}
+			object.mesh = found->second;
+			scene->objects.push_back(object);
+		}
+		else
+		{
+			scene->error = scene->path + ":" + std::to_string(lineNumber) + ": unknown line '" + kind + "'";
+			break;
+		}
+	}
+
+	if (!scene->error.empty())
+	{
+		scene->state = ASSET_FAILED;
+		return;
+	}
+
+	// Every mesh goes on the queue behind us, so the other loader threads can start on them while the rest are being queued.
+	for (unsigned int i = 0; i < meshPaths.size(); i++)
+	{
+		scene->meshes.push_back(LoadMesh(meshPaths[i]));
+	}
+	scene->state = ASSET_UPLOADING;
+}
+
+unsigned int AssetLoader::Update(double budgetSeconds)
+{
+	double start = FramePacer::Now();
+	unsigned int finished = 0;
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		if (decoded.empty())
+		{
+			break;
+		}
+		Asset* asset = assets[decoded.front()];
+		guard.unlock();
+
+		// A mesh the registry already had is ready as soon as the original is, and the original is ahead of it in the queue.
+		if (asset->shared)
+		{
+			guard.lock();
+			decoded.pop_front();
+			asset->state = ASSET_READY;
+			guard.unlock();
+			finished++;
+			continue;
+		}
+
+		Model* model = asset->model;
+		ModelStaging& staging = asset->staging;
+
+		// Empty buffers of the right size first, then the data one chunk at a time. The driver only has to copy a chunk's worth
+		// per call, instead of the whole mesh in one glBufferData.
+		if (!model->HasBuffers())
+		{
+			model->CreateBuffers(staging, false);
+		}
+
+		if (asset->vertexBytesDone < staging.vertexBytes.size())
+		{
+			size_t size = std::min(UploadChunkBytes, staging.vertexBytes.size() - asset->vertexBytesDone);
+			glBindBuffer(GL_ARRAY_BUFFER, model->VertexBuffer());
+			glBufferSubData(GL_ARRAY_BUFFER, asset->vertexBytesDone, size, staging.vertexBytes.data() + asset->vertexBytesDone);
+			asset->vertexBytesDone += size;
+		}
+		else if (asset->indexBytesDone < staging.indexBytes.size())
+		{
+			// Through GL_ARRAY_BUFFER as well, for the same reason as in Model::CreateBuffers.
+			size_t size = std::min(UploadChunkBytes, staging.indexBytes.size() - asset->indexBytesDone);
+			glBindBuffer(GL_ARRAY_BUFFER, model->IndexBuffer());
+			glBufferSubData(GL_ARRAY_BUFFER, asset->indexBytesDone, size, staging.indexBytes.data() + asset->indexBytesDone);
+			asset->indexBytesDone += size;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (asset->vertexBytesDone == staging.vertexBytes.size() && asset->indexBytesDone == staging.indexBytes.size())
+		{
+			// The staged copy isn't needed any more (the model still has the decoded mesh itself).
+			std::vector<unsigned char>().swap(staging.vertexBytes);
+			std::vector<unsigned char>().swap(staging.indexBytes);
+
+			// The model's own CPU copy too, if it's not wanted. Through the registry, since a loader thread may be comparing a new mesh against it.
+			if (dropCPUData)
+			{
+				registry.DropCPUData(model);
+			}
+
+			guard.lock();
+			decoded.pop_front();
+			asset->state = ASSET_READY;
+			guard.unlock();
+			finished++;
+		}
+
+		if (FramePacer::Now() - start >= budgetSeconds)
+		{
+			break;
+		}
+	}
+
+	return finished;
+}
+
+AssetState AssetLoader::State(AssetId id)
+{
+	Asset* asset = GetAsset(id);
+	return asset != nullptr ? (AssetState)asset->state.load() : ASSET_FAILED;
+}
+
+AssetState AssetLoader::SceneState(SceneId id)
+{
+	Scene* scene = GetScene(id);
+	if (scene == nullptr)
+	{
+		return ASSET_FAILED;
+	}
+
+	// Until the file is read, the meshes list isn't either.
+	AssetState state = (AssetState)scene->state.load();
+	if (state != ASSET_UPLOADING)
+	{
+		return state;
+	}
+
+	state = ASSET_READY;
+	for (unsigned int i = 0; i < scene->meshes.size(); i++)
+	{
+		AssetState meshState = State(scene->meshes[i]);
+		if (meshState == ASSET_FAILED)
+		{
+			return ASSET_FAILED;
+		}
+		state = std::min(state, meshState);
+	}
+	return state;
+}
+
+std::string AssetLoader::Error(AssetId id)
+{
+	Asset* asset = GetAsset(id);
+	if (asset == nullptr)
+	{
+		return "no such asset";
+	}
+	return asset->state == ASSET_FAILED ? asset->error : std::string();
+}
+
+std::string AssetLoader::SceneError(SceneId id)
+{
+	Scene* scene = GetScene(id);
+	if (scene == nullptr)
+	{
+		return "no such scene";
+	}
+	if (scene->state == ASSET_FAILED)
+	{
+		return scene->error;
+	}
+
+	// The first mesh that failed, if the file itself was fine.
+	if (scene->state == ASSET_UPLOADING)
+	{
+		for (unsigned int i = 0; i < scene->meshes.size(); i++)
+		{
+			if (State(scene->meshes[i]) == ASSET_FAILED)
+			{
+				return Error(scene->meshes[i]);
+			}
+		}
+	}
+	return std::string();
+}
+
+Model* AssetLoader::GetModel(AssetId id)
+{
+	Asset* asset = GetAsset(id);
+	return asset != nullptr && asset->state == ASSET_READY ? asset->model : nullptr;
+}
+
+std::vector<AssetId> AssetLoader::SceneMeshes(SceneId id)
+{
+	Scene* scene = GetScene(id);
+	if (scene == nullptr || scene->state != ASSET_UPLOADING)
+	{
+		return std::vector<AssetId>();
+	}
+	return scene->meshes;
+}
+
+unsigned int AssetLoader::SpawnScene(SceneId id, World& world, std::vector<ObjectHandle>* outHandles)
+{
+	if (SceneState(id) != ASSET_READY)
+	{
+		return 0;
+	}
+	Scene* scene = GetScene(id);
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> velocities;
+	std::vector<glm::vec3> scales;
+	std::vector<ObjectHandle> handles;
+	unsigned int spawned = 0;
+
+	// One batch per mesh, so the world's columns grow once per mesh instead of once per object.
+	for (unsigned int m = 0; m < scene->meshes.size(); m++)
+	{
+		positions.clear();
+		velocities.clear();
+		scales.clear();
+
+		for (unsigned int i = 0; i < scene->objects.size(); i++)
+		{
+			if (scene->objects[i].mesh == m)
+			{
+				positions.push_back(scene->objects[i].position);
+				velocities.push_back(scene->objects[i].velocity);
+				scales.push_back(scene->objects[i].scale);
+			}
+		}
+		if (positions.empty())
+		{
+			continue;
+		}
+
+		handles.resize(positions.size());
+		world.SpawnBulk((unsigned int)positions.size(), GetModel(scene->meshes[m]), positions.data(), velocities.data(), scales.data(), handles.data());
+		if (outHandles != nullptr)
+		{
+			outHandles->insert(outHandles->end(), handles.begin(), handles.end());
+		}
+		spawned += (unsigned int)positions.size();
+	}
+
+	return spawned;
+}
+
+bool AssetLoader::Busy()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (!jobs.empty() || !decoded.empty())
+	{
+		return true;
+	}
+	for (unsigned int i = 0; i < assets.size(); i++)
+	{
+		if (assets[i]->state == ASSET_QUEUED || assets[i]->state == ASSET_DECODING)
+		{
+			return true;
+		}
+	}
+	for (unsigned int i = 0; i < scenes.size(); i++)
+	{
+		if (scenes[i]->state == ASSET_QUEUED || scenes[i]->state == ASSET_DECODING)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif // _ASSET_LOADER_CPP
@@ -0,0 +1,218 @@
+/*
+Title: Swept AABB-2D
+File Name: AssetLoader.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _ASSET_LOADER_H
+#define _ASSET_LOADER_H
+
+#include "Model.h"
+#include "ModelRegistry.h"
+#include "World.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where an asset is on its way from the disk to the GPU.
+enum AssetState
+{
+	ASSET_QUEUED,		// Waiting for a loader thread to pick it up.
+	ASSET_DECODING,		// A loader thread is reading and decoding it.
+	ASSET_UPLOADING,	// Decoded, and being copied to the GPU a piece at a time by Update().
+	ASSET_READY,		// On the GPU and safe to draw.
+	ASSET_FAILED,		// Couldn't be loaded. Error() says why.
+};
+
+// The vertices and indices of a mesh, as a decoder hands them over.
+struct MeshData
+{
+	std::vector<VertexFormat> vertices;
+	std::vector<GLuint> indices;
+};
+
+// Turns some source into a mesh. Runs on a loader thread, so it mustn't touch OpenGL. Returns false if it couldn't.
+typedef std::function<bool(MeshData&)> MeshDecoder;
+
+// One object placed by a scene file.
+struct SceneObject
+{
+	unsigned int mesh;		// Which of the scene's meshes it uses
+	glm::vec3 position;
+	glm::vec3 velocity;
+	glm::vec3 scale;
+};
+
+typedef unsigned int AssetId;
+typedef unsigned int SceneId;
+
+// Loads meshes and scenes without stalling the frame. Reading and decoding the files happens on a few worker threads,
+// and only the last step, copying the finished data into OpenGL buffers, happens on the thread with the context,
+// in Update(), a piece at a time within a time budget so that one big mesh can't take a whole frame.
+//
+// Meshes are plain text files, one vertex or triangle per line ('#' starts a comment). Triangles go clockwise, like everything else here (see glFrontFace in init()).
+//     v x y z r g b a
+//     f a b c
+// Scenes list the meshes they use and the objects to spawn with them:
+//     mesh name path
+//     object name px py pz vx vy vz sx sy sz
+// Models go through the registry the loader was given, so two files holding the same mesh share one model (and only upload it once).
+// The loader keeps a reference to each of its models until Cleanup().
+class AssetLoader
+{
+	struct Asset
+	{
+		std::string path;
+		MeshDecoder decoder;
+		VertexLayout layout;
+		std::atomic<int> state;
+		std::string error;
+
+		// Made by the loader thread. Only used by Update() once the state is ASSET_UPLOADING, and only handed out once it's ASSET_READY.
+		// shared means the registry already had the mesh, so there's nothing to upload.
+		Model* model;
+		bool shared;
+		ModelStaging staging;
+		size_t vertexBytesDone;
+		size_t indexBytesDone;
+	};
+
+	struct Scene
+	{
+		std::string path;
+		std::atomic<int> state;
+		std::string error;
+
+		// Filled in by the loader thread before the state leaves ASSET_DECODING.
+		std::vector<AssetId> meshes;
+		std::vector<SceneObject> objects;
+	};
+
+	struct Job
+	{
+		bool scene;
+		unsigned int id;
+	};
+
+	// Assets and scenes are never removed before Cleanup(), so an id is just an index. They're allocated one by one so the
+	// loader threads can hold on to them while the lists grow.
+	std::vector<Asset*> assets;
+	std::vector<Scene*> scenes;
+
+	ModelRegistry& registry;
+
+	// Whether models let go of their CPU copy once they're uploaded.
+	bool dropCPUData;
+
+	std::vector<std::thread> workers;
+	std::deque<Job> jobs;
+	bool stopping;
+
+	// Assets the loader threads have decoded, waiting for Update() to upload them, in the order they finished.
+	std::deque<AssetId> decoded;
+
+	// Guards assets, scenes, jobs, stopping and decoded.
+	std::mutex lock;
+	std::condition_variable jobAdded;
+
+	// How many bytes Update() copies at a time, so it can check the clock in between.
+	static const size_t UploadChunkBytes = 256 * 1024;
+
+	void WorkerLoop();
+	void Decode(AssetId);
+	void DecodeScene(SceneId);
+	void Enqueue(bool scene, unsigned int id);
+	AssetId AddAsset(const std::string& path, MeshDecoder, VertexLayout);
+	Asset* GetAsset(AssetId);
+	Scene* GetScene(SceneId);
+
+public:
+	AssetLoader(ModelRegistry&);
+	~AssetLoader();
+
+	// Starts the loader threads (0 picks one less than the number of cores, and at least one).
+	void Init(unsigned int threads = 0);
+
+	// Stops the loader threads and releases every model. Needs the OpenGL context to still be around.
+	void Cleanup();
+
+	// With drop = true, each model lets go of its CPU copy once it's on the GPU (see ModelRegistry::DropCPUData), so a loaded mesh only takes up GPU memory.
+	// Leave it off if the models are going in a GeometryArena, which copies from the CPU side.
+	void SetDropCPUData(bool drop)
+	{
+		dropCPUData = drop;
+	}
+
+	// Reads a mesh file in the background.
+	AssetId LoadMesh(const std::string& path, VertexLayout = VERTEX_LAYOUT_FULL);
+
+	// Makes a mesh from any other source in the background. name is only used in error messages.
+	AssetId LoadMesh(const std::string& name, MeshDecoder, VertexLayout = VERTEX_LAYOUT_FULL);
+
+	// Reads a scene file in the background, then loads each mesh it lists. Meshes are found relative to the scene file.
+	SceneId LoadScene(const std::string& path);
+
+	// Does up to budgetSeconds of uploading. Call once a frame on the thread with the OpenGL context.
+	// Always uploads at least one piece, so loading finishes even when the budget is tiny. Returns how many assets became ready.
+	unsigned int Update(double budgetSeconds);
+
+	AssetState State(AssetId);
+
+	// ASSET_READY once the scene file and all of its meshes are, ASSET_FAILED if any of them failed, otherwise the earliest stage any of them is at.
+	AssetState SceneState(SceneId);
+
+	// Why the asset or scene failed, or empty if it didn't.
+	std::string Error(AssetId);
+	std::string SceneError(SceneId);
+
+	// The model, once the asset is ASSET_READY (otherwise nullptr).
+	Model* GetModel(AssetId);
+
+	// The scene's meshes, in the order the file lists them.
+	std::vector<AssetId> SceneMeshes(SceneId);
+
+	// Spawns every object of a ready scene into the world, with one SpawnBulk per mesh. Returns how many it spawned.
+	unsigned int SpawnScene(SceneId, World&, std::vector<ObjectHandle>* outHandles = nullptr);
+
+	// Whether anything is still queued, decoding or uploading.
+	bool Busy();
+};
+
+#endif //_ASSET_LOADER_H
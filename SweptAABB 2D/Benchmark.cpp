@@ -0,0 +1,1683 @@
+/*
+Title: Swept AABB-2D
+File Name: Benchmark.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BENCHMARK_CPP
+#define _BENCHMARK_CPP
+
+#include "Benchmark.h"
+#include "BenchmarkBaseline.h"
+#include "BodyBuffer.h"
+#include "BoundsBatch.h"
+#include "FramePacer.h"
+#include "PhysicsWorld.h"
+#include "RenderQueue.h"
+#include "ShaderLoader.h"
+#include "SweptBatch.h"
+#include "SweptCapture.h"
+#include "TrajectoryRecorder.h"
+#include "TransformBatch.h"
+#include "World.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+double benchmarkTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// How long each timed section of a benchmark runs for, in seconds.
+static const double benchmarkDuration = 0.5;
+
+// Opened by --counters. They count the thread running the benchmarks, so anything timed with them has to run on that thread.
+static PerfCounters benchmarkCounters;
+
+// The counters' totals right now (all zero without --counters). Take them before and after the timed work and give the difference
+// to the BenchmarkResult.
+static PerfCounts benchmarkCounts()
+{
+	return benchmarkCounters.Read();
+}
+
+// One physics thread publishes snapshots as fast as it can while a number of reader threads keep acquiring the latest one and reading every position.
+// This shows how much readers slow down publishing (and each other) as more of them are added.
+static void benchmarkSnapshotContention(std::vector<BenchmarkResult>& results)
+{
+	const int numObjects = 10000;
+	const int readerCounts[] = { 0, 1, 2, 4, 8 };
+
+	for (int r = 0; r < 5; r++)
+	{
+		int numReaders = readerCounts[r];
+
+		SnapshotBuffer buffer;
+		std::atomic<bool> running(true);
+		std::atomic<unsigned long long> reads(0);
+		unsigned long long publishes = 0;
+		unsigned long long skipped = 0;
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < numReaders; i++)
+		{
+			readers.push_back(std::thread([&]()
+			{
+				unsigned long long localReads = 0;
+				float sum = 0.0f;
+
+				while (running.load(std::memory_order_relaxed))
+				{
+					SnapshotReader reader(buffer);
+
+					if (reader.IsValid())
+					{
+						for (int j = 0; j < reader->NumObjects(); j++)
+						{
+							sum += reader->positions[j].x;
+						}
+
+						localReads++;
+					}
+				}
+
+				// Use the sum so the compiler can't throw the reads away.
+				if (sum == 12345.0f)
+				{
+					printf(" ");
+				}
+
+				reads += localReads;
+			}));
+		}
+
+		double start = benchmarkTime();
+		double end = start;
+
+		while (end - start < benchmarkDuration)
+		{
+			WorldSnapshot* snapshot = buffer.BeginWrite();
+
+			if (snapshot != nullptr)
+			{
+				snapshot->step = (unsigned int)publishes;
+				snapshot->positions.resize(numObjects);
+				snapshot->velocities.resize(numObjects);
+				snapshot->boxes.resize(numObjects);
+
+				for (int j = 0; j < numObjects; j++)
+				{
+					snapshot->positions[j] = glm::vec3((float)j, (float)publishes, 0.0f);
+				}
+
+				buffer.Publish(snapshot);
+				publishes++;
+			}
+			else
+			{
+				skipped++;
+			}
+
+			end = benchmarkTime();
+		}
+
+		running = false;
+		for (unsigned int i = 0; i < readers.size(); i++)
+		{
+			readers[i].join();
+		}
+
+		std::string suffix = "/readers=" + std::to_string(numReaders);
+		results.push_back(BenchmarkResult("snapshot_publish" + suffix, publishes, end - start));
+		results.push_back(BenchmarkResult("snapshot_skipped" + suffix, skipped, end - start));
+		if (numReaders > 0)
+		{
+			results.push_back(BenchmarkResult("snapshot_read" + suffix, reads.load(), end - start));
+		}
+	}
+}
+
+// Bullet-heavy game modes keep spawning and despawning objects. This keeps a world at a steady population
+// and replaces a random live object every operation: one Destroy, one Spawn, and a validity check of the stale handle.
+static void benchmarkPoolChurn(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int population = 10000;
+	const unsigned int numOperations = 1000000;
+
+	World world;
+	world.Reserve(population);
+
+	std::vector<ObjectHandle> live;
+	for (unsigned int i = 0; i < population; i++)
+	{
+		live.push_back(world.Spawn(nullptr, glm::vec3((float)i, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.05f)));
+	}
+
+	// A simple linear congruential generator, so every run replaces the same objects.
+	unsigned int random = 12345;
+	unsigned int staleHits = 0;
+
+	double start = benchmarkTime();
+
+	for (unsigned int i = 0; i < numOperations; i++)
+	{
+		random = random * 1664525u + 1013904223u;
+		unsigned int victim = random % population;
+
+		ObjectHandle old = live[victim];
+		world.Destroy(old);
+		live[victim] = world.Spawn(nullptr, glm::vec3((float)i, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.05f));
+
+		// The slot was most likely reused right away, so this is exactly the stale handle case the generation has to catch.
+		if (world.IsValid(old))
+		{
+			staleHits++;
+		}
+	}
+
+	double end = benchmarkTime();
+
+	if (staleHits > 0 || world.NumObjects() != population)
+	{
+		printf("pool_churn: %u stale handles were still valid!\n", staleHits);
+	}
+
+	results.push_back(BenchmarkResult("pool_churn/spawn+destroy", numOperations, end - start));
+}
+
+// Spawns a million small bodies spread over a 1000 x 1000 area, first one at a time with Spawn and then in one SpawnBulk call.
+// Then destroys all of them, again one at a time and with DestroyBulk.
+static void benchmarkBulkSpawn(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 1000000;
+
+	std::vector<glm::vec3> positions(numBodies);
+	std::vector<glm::vec3> velocities(numBodies, glm::vec3(0.0f, -1.0f, 0.0f));
+	std::vector<glm::vec3> scales(numBodies, glm::vec3(0.05f));
+	std::vector<ObjectHandle> handles(numBodies);
+
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		positions[i] = glm::vec3((float)(i % 1000), (float)(i / 1000), 0.0f);
+	}
+
+	{
+		World world;
+
+		double start = benchmarkTime();
+		for (unsigned int i = 0; i < numBodies; i++)
+		{
+			handles[i] = world.Spawn(nullptr, positions[i], velocities[i], scales[i]);
+		}
+		double middle = benchmarkTime();
+		for (unsigned int i = 0; i < numBodies; i++)
+		{
+			world.Destroy(handles[i]);
+		}
+		double end = benchmarkTime();
+
+		results.push_back(BenchmarkResult("bulk_spawn/single_spawn", numBodies, middle - start));
+		results.push_back(BenchmarkResult("bulk_spawn/single_destroy", numBodies, end - middle));
+	}
+
+	{
+		World world;
+
+		double start = benchmarkTime();
+		world.SpawnBulk(numBodies, nullptr, positions.data(), velocities.data(), scales.data(), handles.data());
+		double middle = benchmarkTime();
+		world.DestroyBulk(numBodies, handles.data());
+		double end = benchmarkTime();
+
+		results.push_back(BenchmarkResult("bulk_spawn/bulk_spawn", numBodies, middle - start));
+		results.push_back(BenchmarkResult("bulk_spawn/bulk_destroy", numBodies, end - middle));
+	}
+}
+
+// The usual run-time way of making the same choices as the PhysicsWorld policies: an interface per policy, called through a virtual function
+// for every object and pair. The Virtual*Policy adapters plug these into PhysicsWorld, so both sides of the comparison run exactly the same step.
+class BroadphaseInterface
+{
+public:
+	virtual ~BroadphaseInterface()
+	{
+	}
+	virtual void Candidates(World&, const AABB&, std::vector<ObjectHandle>&) = 0;
+};
+class GridBroadphaseInterface : public BroadphaseInterface
+{
+public:
+	void Candidates(World& world, const AABB& box, std::vector<ObjectHandle>& out)
+	{
+		world.Query(box, out);
+	}
+};
+
+class ResponseInterface
+{
+public:
+	virtual ~ResponseInterface()
+	{
+	}
+	virtual float Respond(glm::vec3&, float, float) = 0;
+};
+class BounceResponseInterface : public ResponseInterface
+{
+	BounceResponse bounce;
+
+public:
+	float Respond(glm::vec3& velocity, float normalx, float normaly)
+	{
+		return bounce.Respond(velocity, normalx, normaly);
+	}
+};
+
+class EventSinkInterface
+{
+public:
+	virtual ~EventSinkInterface()
+	{
+	}
+	virtual void OnContact(ObjectHandle, ObjectHandle, float, float, float) = 0;
+};
+class NullEventSinkInterface : public EventSinkInterface
+{
+public:
+	void OnContact(ObjectHandle, ObjectHandle, float, float, float)
+	{
+	}
+};
+
+struct VirtualBroadphasePolicy
+{
+	BroadphaseInterface* impl;
+	std::vector<ObjectHandle> found;
+
+	template <typename Visitor>
+	void ForEachCandidate(World& world, const AABB& box, Visitor& visit)
+	{
+		found.clear();
+		impl->Candidates(world, box, found);
+
+		for (unsigned int i = 0; i < found.size(); i++)
+		{
+			visit(world.DenseIndex(found[i]));
+		}
+	}
+};
+struct VirtualResponsePolicy
+{
+	ResponseInterface* impl;
+
+	float Respond(glm::vec3& velocity, float normalx, float normaly)
+	{
+		return impl->Respond(velocity, normalx, normaly);
+	}
+};
+struct VirtualEventSinkPolicy
+{
+	EventSinkInterface* impl;
+
+	void OnContact(ObjectHandle moving, ObjectHandle other, float time, float normalx, float normaly)
+	{
+		impl->OnContact(moving, other, time, normalx, normaly);
+	}
+};
+
+typedef PhysicsConfig<float, VirtualBroadphasePolicy, VirtualResponsePolicy, VirtualEventSinkPolicy, false> VirtualPhysicsConfig;
+
+// Fills a world with a grid of small squares where every other one is moving, so there are plenty of hits every step.
+static void fillStepWorld(World& world, unsigned int numBodies)
+{
+	unsigned int random = 12345;
+
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		glm::vec3 velocity(0.0f);
+
+		if (i % 2 == 0)
+		{
+			random = random * 1664525u + 1013904223u;
+			velocity.x = ((int)((random >> 8) % 200) - 100) * 0.01f;
+			random = random * 1664525u + 1013904223u;
+			velocity.y = ((int)((random >> 8) % 200) - 100) * 0.01f;
+		}
+
+		world.Spawn(nullptr, glm::vec3((i % 200) * 0.3f, (i / 200) * 0.3f, 0.0f), velocity, glm::vec3(0.1f));
+	}
+}
+
+// Runs the same steps through PhysicsWorld with inlined policies and with virtual policies.
+static void benchmarkPolicyDispatch(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 20000;
+	const int numSteps = 100;
+	const float dt = 0.012f;
+
+	{
+		World world;
+		fillStepWorld(world, numBodies);
+		PhysicsWorld<DefaultPhysicsConfig> physics(world);
+
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		for (int s = 0; s < numSteps; s++)
+		{
+			physics.Step(dt);
+		}
+		double end = benchmarkTime();
+
+		results.push_back(BenchmarkResult("policy_dispatch/template", (unsigned long long)numBodies * numSteps, end - start, benchmarkCounts() - counts));
+	}
+
+	{
+		World world;
+		fillStepWorld(world, numBodies);
+
+		GridBroadphaseInterface grid;
+		BounceResponseInterface bounce;
+		NullEventSinkInterface sink;
+
+		PhysicsWorld<VirtualPhysicsConfig> physics(world);
+		physics.Broadphase().impl = &grid;
+		physics.Response().impl = &bounce;
+		physics.Events().impl = &sink;
+
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		for (int s = 0; s < numSteps; s++)
+		{
+			physics.Step(dt);
+		}
+		double end = benchmarkTime();
+
+		results.push_back(BenchmarkResult("policy_dispatch/virtual", (unsigned long long)numBodies * numSteps, end - start, benchmarkCounts() - counts));
+	}
+}
+
+// The policy_dispatch world again, with the step instrumented, to split it into its phases: applying commands, integrating and colliding
+// the bodies, and publishing the snapshot. The collide phase is reported per body integrated and per pair tested. With --counters,
+// the step reads the counters at each phase boundary (see PhysicsStats), so each phase gets its own counts.
+static void benchmarkStepPhases(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 20000;
+	const int numSteps = 100;
+	const float dt = 0.012f;
+
+	World world;
+	fillStepWorld(world, numBodies);
+
+	PhysicsWorld<PhysicsConfig<float, GridBroadphase, BounceResponse, NullEventSink, true> > physics(world);
+	if (benchmarkCounters.IsOpen())
+	{
+		physics.SetCounters(&benchmarkCounters);
+	}
+
+	PhysicsStats total;
+	for (int s = 0; s < numSteps; s++)
+	{
+		physics.Step(dt);
+
+		const PhysicsStats& stats = physics.Stats();
+		total.bodiesIntegrated += stats.bodiesIntegrated;
+		total.pairsTested += stats.pairsTested;
+		total.contacts += stats.contacts;
+		total.commandSeconds += stats.commandSeconds;
+		total.collideSeconds += stats.collideSeconds;
+		total.publishSeconds += stats.publishSeconds;
+		total.commandCounts += stats.commandCounts;
+		total.collideCounts += stats.collideCounts;
+		total.publishCounts += stats.publishCounts;
+	}
+
+	results.push_back(BenchmarkResult("step_phases/commands_per_step", numSteps, total.commandSeconds, total.commandCounts));
+	results.push_back(BenchmarkResult("step_phases/collide_per_body", total.bodiesIntegrated, total.collideSeconds, total.collideCounts));
+	results.push_back(BenchmarkResult("step_phases/collide_per_pair", total.pairsTested, total.collideSeconds, total.collideCounts));
+	results.push_back(BenchmarkResult("step_phases/publish_per_body", total.bodiesIntegrated, total.publishSeconds, total.publishCounts));
+
+	printf("step_phases: %.1f pairs tested and %.2f contacts per body\n", (double)total.pairsTested / total.bodiesIntegrated, (double)total.contacts / total.bodiesIntegrated);
+}
+
+// The world's uniform grid on its own, on the policy_dispatch world: querying each body's box (what the collide phase does for every moving body),
+// bringing it up to date after every body moved (most stay in the same cells), and building it again from scratch. Then whole steps with the grid
+// against testing every pair, on a world small enough for testing every pair to finish.
+static void benchmarkBroadphase(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 20000;
+	const float dt = 0.012f;
+
+	World world;
+	fillStepWorld(world, numBodies);
+
+	{
+		std::vector<ObjectHandle> found;
+		unsigned long long queries = 0;
+		unsigned long long candidates = 0;
+
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		double end = start;
+		while (end - start < benchmarkDuration)
+		{
+			for (unsigned int i = 0; i < world.NumObjects(); i++)
+			{
+				found.clear();
+				world.Query(world.GetAABB(world.HandleAt(i)), found);
+				candidates += found.size();
+			}
+
+			queries += world.NumObjects();
+			end = benchmarkTime();
+		}
+
+		results.push_back(BenchmarkResult("broadphase/query", queries, end - start, benchmarkCounts() - counts));
+		printf("broadphase: %.1f candidates per query\n", (double)candidates / queries);
+	}
+
+	{
+		// Moving the bodies isn't timed, only the update. They go forwards one step and back the next, so the world stays the same however long it runs.
+		unsigned long long updated = 0;
+		double seconds = 0.0;
+		PerfCounts counts;
+
+		for (int pass = 0; seconds < benchmarkDuration; pass++)
+		{
+			for (unsigned int i = 0; i < world.NumObjects(); i++)
+			{
+				world.UpdateObject(i, pass % 2 == 0 ? dt : -dt);
+				world.CalculateAABB(i);
+			}
+
+			PerfCounts before = benchmarkCounts();
+			double start = benchmarkTime();
+			world.UpdateBroadphase();
+			seconds += benchmarkTime() - start;
+			counts += benchmarkCounts() - before;
+
+			updated += world.NumObjects();
+		}
+
+		results.push_back(BenchmarkResult("broadphase/update", updated, seconds, counts));
+	}
+
+	{
+		unsigned long long built = 0;
+
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		double end = start;
+		while (end - start < benchmarkDuration)
+		{
+			world.RebuildBroadphase();
+			built += world.NumObjects();
+			end = benchmarkTime();
+		}
+
+		results.push_back(BenchmarkResult("broadphase/rebuild", built, end - start, benchmarkCounts() - counts));
+	}
+
+	// Each starts from the same world. Testing every pair is so much slower that it runs fewer steps, to keep it to about a second.
+	const unsigned int numSmall = 2000;
+	const int numSteps[] = { 1000, 50 };
+
+	for (int version = 0; version < 2; version++)
+	{
+		World small;
+		fillStepWorld(small, numSmall);
+
+		PhysicsWorld<DefaultPhysicsConfig> grid(small);
+		PhysicsWorld<PhysicsConfig<float, BruteForceBroadphase, BounceResponse, NullEventSink, false> > bruteForce(small);
+
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		for (int s = 0; s < numSteps[version]; s++)
+		{
+			if (version == 0)
+			{
+				grid.Step(dt);
+			}
+			else
+			{
+				bruteForce.Step(dt);
+			}
+		}
+		double end = benchmarkTime();
+
+		results.push_back(BenchmarkResult(version == 0 ? "broadphase/step_2k_grid" : "broadphase/step_2k_brute_force", (unsigned long long)numSmall * numSteps[version], end - start, benchmarkCounts() - counts));
+	}
+}
+
+// The CPU side of getting a frame's transforms ready for the GPU: an MVP matrix per object (64 bytes each, the uniform path)
+// compared to copying each body's position and scale out of the world (16 bytes each, the vertex pulling path). No OpenGL is needed.
+static void benchmarkRenderUpload(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 100000;
+
+	World world;
+	fillStepWorld(world, numBodies);
+
+	glm::mat4 PV = glm::perspective(45.0f, 800.0f / 600.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	std::vector<glm::mat4> matrices(numBodies);
+	BodyGatherer bodies;
+
+	unsigned long long frames = 0;
+	double start = benchmarkTime();
+	double end = start;
+	while (end - start < benchmarkDuration)
+	{
+		for (unsigned int i = 0; i < numBodies; i++)
+		{
+			matrices[i] = PV * world.GetTransform(i);
+		}
+		frames++;
+		end = benchmarkTime();
+	}
+	results.push_back(BenchmarkResult("render_upload/mvp_matrix (64 B/body)", frames * numBodies, end - start));
+
+	frames = 0;
+	start = benchmarkTime();
+	end = start;
+	while (end - start < benchmarkDuration)
+	{
+		bodies.Gather(world);
+		frames++;
+		end = benchmarkTime();
+	}
+	results.push_back(BenchmarkResult("render_upload/vertex_pulling (16 B/body)", frames * numBodies, end - start));
+}
+
+// Building the MVP matrix of 100k bodies: full glm matrix products, the translation+scale version in plain C++, and the same with AVX2.
+static void benchmarkTransformBatch(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 100000;
+
+	World world;
+	fillStepWorld(world, numBodies);
+
+	glm::mat4 PV = glm::perspective(45.0f, 800.0f / 600.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	std::vector<glm::mat4> matrices(numBodies);
+
+	for (int version = 0; version < 3; version++)
+	{
+		if (version == 2 && !transformBatchUsesAVX2())
+		{
+			printf("transform_batch: this CPU doesn't have AVX2, skipping.\n");
+			break;
+		}
+
+		unsigned long long frames = 0;
+		double start = benchmarkTime();
+		double end = start;
+		while (end - start < benchmarkDuration)
+		{
+			if (version == 0)
+			{
+				for (unsigned int i = 0; i < numBodies; i++)
+				{
+					matrices[i] = PV * glm::scale(glm::translate(glm::mat4(), world.Positions()[i]), world.Scales()[i]);
+				}
+			}
+			else if (version == 1)
+			{
+				computeMVPsScalar(PV, numBodies, world.Positions(), world.Scales(), matrices.data());
+			}
+			else
+			{
+				computeMVPs(PV, numBodies, world.Positions(), world.Scales(), matrices.data());
+			}
+			frames++;
+			end = benchmarkTime();
+		}
+
+		const char* names[] = { "transform_batch/glm_mat4_products", "transform_batch/translate_scale_scalar", "transform_batch/translate_scale_avx2" };
+		results.push_back(BenchmarkResult(names[version], frames * numBodies, end - start));
+	}
+}
+
+// The AABB of a rotated, detailed mesh: the original way (a mat4 * vec4 and six compares per vertex), the same over structure-of-arrays
+// positions in plain C++, with AVX2 on one thread and on all of them, and through GameObject::CalculateAABB, which only transforms the hull.
+// The mesh is a flat disc of 50,000 vertices for the hull, and a bumpy one (every vertex at its own z, so the hull is every vertex) for the rest,
+// with a million vertices for the threaded run. No OpenGL is needed: the models never get GPU buffers.
+static void benchmarkAABB(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int sizes[] = { 50000, 1000000 };
+
+	for (int s = 0; s < 2; s++)
+	{
+		unsigned int numVertices = sizes[s];
+
+		// Points spread over a disc, which puts a few hundred of them on the hull.
+		std::vector<VertexFormat> flat(numVertices);
+		std::vector<VertexFormat> bumpy(numVertices);
+		std::vector<float> xs(numVertices), ys(numVertices), zs(numVertices);
+		for (unsigned int i = 0; i < numVertices; i++)
+		{
+			float angle = i * 2.39996323f;
+			float radius = sqrtf((float)i / numVertices);
+			flat[i].position = glm::vec3(cosf(angle) * radius, sinf(angle) * radius, 0.0f);
+			bumpy[i].position = glm::vec3(flat[i].position.x, flat[i].position.y, 0.1f * sinf(i * 0.37f));
+			xs[i] = bumpy[i].position.x;
+			ys[i] = bumpy[i].position.y;
+			zs[i] = bumpy[i].position.z;
+		}
+
+		Model flatModel((int)numVertices, flat.data(), 0, nullptr, VERTEX_LAYOUT_FULL, false);
+		GameObject object(&flatModel);
+		object.SetPosition(glm::vec3(1.0f, 2.0f, 0.0f));
+
+		// Each version gets a slightly different rotation each time, so nothing can be worked out once and reused.
+		for (int version = 0; version < 5; version++)
+		{
+			if ((version == 2 || version == 3) && !transformBatchUsesAVX2())
+			{
+				continue;
+			}
+
+			// Only the threaded version is worth running on the big mesh, and only the others on the small one.
+			if ((s == 0) == (version == 3))
+			{
+				continue;
+			}
+
+			unsigned long long boxes = 0;
+			glm::vec3 boxMin, boxMax;
+			double start = benchmarkTime();
+			double end = start;
+			while (end - start < benchmarkDuration)
+			{
+				glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(), glm::vec3(1.0f, 2.0f, 0.0f)), boxes * 0.001f, glm::vec3(0.3f, 0.2f, 1.0f));
+
+				if (version == 0)
+				{
+					boxMin = boxMax = glm::vec3(transform * glm::vec4(bumpy[0].position, 1.0f));
+					for (unsigned int i = 1; i < numVertices; i++)
+					{
+						glm::vec4 point = transform * glm::vec4(bumpy[i].position, 1.0f);
+						if (point.x > boxMax.x) boxMax.x = point.x;
+						if (point.y > boxMax.y) boxMax.y = point.y;
+						if (point.z > boxMax.z) boxMax.z = point.z;
+						if (point.x < boxMin.x) boxMin.x = point.x;
+						if (point.y < boxMin.y) boxMin.y = point.y;
+						if (point.z < boxMin.z) boxMin.z = point.z;
+					}
+				}
+				else if (version == 1)
+				{
+					computeBoundsScalar(transform, numVertices, xs.data(), ys.data(), zs.data(), boxMin, boxMax);
+				}
+				else if (version == 2 || version == 3)
+				{
+					computeBounds(transform, numVertices, xs.data(), ys.data(), zs.data(), boxMin, boxMax, version == 2 ? 1 : 0);
+				}
+				else
+				{
+					object.SetRotation(glm::vec3(0.0f, 0.0f, boxes * 0.001f));
+					object.CalculateAABB();
+					boxMin = object.GetAABB().min;
+				}
+				boxes++;
+				end = benchmarkTime();
+			}
+
+			const char* names[] = { "aabb/glm_mat4_per_vertex", "aabb/soa_scalar", "aabb/soa_avx2", "aabb/soa_avx2_all_threads_1m", "aabb/hull_only" };
+			results.push_back(BenchmarkResult(names[version], boxes, end - start));
+
+			// Keeps the compiler from deciding the boxes are never used.
+			if (boxMin.x > 1.0e30f)
+			{
+				printf("%f\n", boxMax.x);
+			}
+		}
+
+		if (s == 0)
+		{
+			printf("aabb: %u of %u vertices are on the hull\n", flatModel.HullSize(), numVertices);
+		}
+	}
+}
+
+// Filling the render queue from a big world on one thread and on all of them, then sorting a million commands spread over
+// 4 programs, 64 models and 16 materials with the radix sort and with std::sort. No OpenGL is needed for any of this.
+static void benchmarkRenderQueue(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 1000000;
+
+	World world;
+	fillStepWorld(world, numBodies);
+
+	RenderQueue queue;
+	int threadCounts[] = { 1, 0 };
+	const char* fillNames[] = { "render_queue/fill_1_thread", "render_queue/fill_all_threads" };
+
+	for (int t = 0; t < 2; t++)
+	{
+		unsigned long long filled = 0;
+		double start = benchmarkTime();
+		double end = start;
+		while (end - start < benchmarkDuration)
+		{
+			queue.Clear();
+			queue.Fill(world, nullptr, 0, threadCounts[t]);
+			filled += numBodies;
+			end = benchmarkTime();
+		}
+		results.push_back(BenchmarkResult(fillNames[t], filled, end - start));
+	}
+
+	// The same shuffled keys for both sorts.
+	std::vector<RenderCommand> shuffled(numBodies);
+	unsigned int random = 12345;
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		random = random * 1664525u + 1013904223u;
+		shuffled[i].key = RenderQueue::MakeKey((random >> 8) % 4, (random >> 12) % 64, (random >> 20) % 16);
+		shuffled[i].object = i;
+	}
+
+	for (int version = 0; version < 2; version++)
+	{
+		unsigned long long sorted = 0;
+		double total = 0.0;
+		std::vector<RenderCommand> commands;
+
+		while (total < benchmarkDuration)
+		{
+			// Refilling isn't part of the time.
+			queue.Clear();
+			commands = shuffled;
+			for (unsigned int i = 0; i < numBodies; i++)
+			{
+				queue.Add(shuffled[i].key, shuffled[i].object);
+			}
+
+			double start = benchmarkTime();
+			if (version == 0)
+			{
+				queue.Sort();
+			}
+			else
+			{
+				std::sort(commands.begin(), commands.end(), [](const RenderCommand& a, const RenderCommand& b) { return a.key < b.key; });
+			}
+			total += benchmarkTime() - start;
+			sorted += numBodies;
+		}
+		results.push_back(BenchmarkResult(version == 0 ? "render_queue/radix_sort" : "render_queue/std_sort", sorted, total));
+	}
+}
+
+// How long getting our three programs (plain, instanced and vertex pulling) ready takes at startup: reading the .glsl files and compiling them,
+// compiling the built-in sources, and loading the built-in sources' programs from the binary cache. Each startup is one operation.
+// It needs an OpenGL context, so it opens a hidden window. Drivers often keep their own cache of compiled shaders as well,
+// which makes the compile times here better than a truly first run would be.
+static void benchmarkShaderStartup(std::vector<BenchmarkResult>& results)
+{
+	if (!glfwInit())
+	{
+		printf("shader_startup: couldn't start GLFW, skipping.\n");
+		return;
+	}
+
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	GLFWwindow* hidden = glfwCreateWindow(64, 64, "shader_startup", nullptr, nullptr);
+	glfwDefaultWindowHints();
+
+	if (hidden == nullptr)
+	{
+		printf("shader_startup: couldn't create an OpenGL context, skipping.\n");
+		glfwTerminate();
+		return;
+	}
+
+	glfwMakeContextCurrent(hidden);
+	glewInit();
+
+	if (!GLEW_VERSION_4_3)
+	{
+		printf("shader_startup: the instanced and vertex pulling shaders need OpenGL 4.3, skipping.\n");
+	}
+	else
+	{
+		const int numStartups = 10;
+		const char* names[] = { "shader_startup/read_files+compile", "shader_startup/embedded+compile", "shader_startup/embedded+binary_cache" };
+
+		for (int version = 0; version < 3; version++)
+		{
+			// Fill the cache once before timing loads from it.
+			if (version == 2)
+			{
+				ProgramCache warmup;
+				GLuint programs[3];
+				programs[0] = warmup.Begin(loadShaderSource("VertexShader.glsl"), loadShaderSource("FragmentShader.glsl"));
+				programs[1] = warmup.Begin(loadShaderSource("InstancedVertexShader.glsl"), loadShaderSource("FragmentShader.glsl"));
+				programs[2] = warmup.Begin(enableVertexPulling(loadShaderSource("VertexShader.glsl")), loadShaderSource("FragmentShader.glsl"));
+				warmup.Finish();
+
+				for (int p = 0; p < 3; p++)
+				{
+					if (glIsProgram(programs[p]))
+					{
+						glDeleteProgram(programs[p]);
+					}
+				}
+			}
+
+			double total = 0.0;
+			bool ok = true;
+
+			for (int run = 0; run < numStartups && ok; run++)
+			{
+				double start = benchmarkTime();
+
+				std::string vertex, instanced, fragment;
+				if (version == 0)
+				{
+					vertex = readShader("../VertexShader.glsl");
+					instanced = readShader("../InstancedVertexShader.glsl");
+					fragment = readShader("../FragmentShader.glsl");
+				}
+				else
+				{
+					vertex = loadShaderSource("VertexShader.glsl");
+					instanced = loadShaderSource("InstancedVertexShader.glsl");
+					fragment = loadShaderSource("FragmentShader.glsl");
+				}
+
+				ProgramCache cache("", version == 2);
+				GLuint programs[3];
+				programs[0] = cache.Begin(vertex, fragment);
+				programs[1] = cache.Begin(instanced, fragment);
+				programs[2] = cache.Begin(enableVertexPulling(vertex), fragment);
+				ok = cache.Finish();
+
+				total += benchmarkTime() - start;
+
+				for (int p = 0; p < 3; p++)
+				{
+					if (glIsProgram(programs[p]))
+					{
+						glDeleteProgram(programs[p]);
+					}
+				}
+			}
+
+			if (!ok)
+			{
+				printf("%s: the shaders didn't build (are the .glsl files one folder up?), skipping.\n", names[version]);
+				continue;
+			}
+
+			results.push_back(BenchmarkResult(names[version], numStartups, total));
+		}
+	}
+
+	glfwDestroyWindow(hidden);
+	glfwTerminate();
+}
+
+// Runs a pretend 60 FPS main loop (2 ms of busy work a frame) for 2 seconds with each way of waiting between frames, and compares
+// how much CPU it used against how steady the frame times were. Each frame is one operation.
+static void benchmarkFramePacing(std::vector<BenchmarkResult>& results)
+{
+	const double target = 1.0 / 60.0;
+	const double work = 0.002;
+	const unsigned int numFrames = 120;
+
+	const FramePacing modes[] = { FRAME_PACING_OFF, FRAME_PACING_SPIN, FRAME_PACING_SLEEP, FRAME_PACING_HYBRID };
+	const char* names[] = { "frame_pacing/off", "frame_pacing/spin", "frame_pacing/sleep", "frame_pacing/hybrid" };
+	FramePacingReport reports[4];
+
+	for (int m = 0; m < 4; m++)
+	{
+		FramePacer pacer(modes[m]);
+
+		double start = FramePacer::Now();
+		double deadline = start;
+
+		for (unsigned int f = 0; f < numFrames; f++)
+		{
+			// The frame's work.
+			double workEnd = FramePacer::Now() + work;
+			while (FramePacer::Now() < workEnd)
+			{
+			}
+
+			// Then wait for the next frame's start, keeping to a fixed schedule so lateness doesn't add up.
+			deadline += target;
+			pacer.WaitFor(deadline - FramePacer::Now());
+			pacer.FrameDone();
+		}
+
+		reports[m] = pacer.Report(target);
+		results.push_back(BenchmarkResult(names[m], numFrames, FramePacer::Now() - start));
+	}
+
+	printf("\n%-24s %10s %12s %12s %14s\n", "frame pacing", "CPU %", "mean ms", "jitter ms", "p99 error ms");
+	for (int m = 0; m < 4; m++)
+	{
+		printf("%-24s %10.1f %12.3f %12.3f %14.3f\n", names[m], reports[m].cpuPercent, reports[m].meanFrameMs, reports[m].jitterMs, reports[m].p99ErrorMs);
+	}
+}
+
+// Steps a world of 10,000 bodies (half of them falling, half at rest) the way the demo does, first on its own and then recording
+// every step to a trajectory file, and reports what Record() costs the physics thread next to the step itself. Then reads the file back,
+// in order and jumping to random ticks, and checks the last tick against the world. The file goes in the working directory and is deleted after.
+static void benchmarkTrajectory(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numBodies = 10000;
+	const unsigned int numSteps = 600;
+	const float dt = 0.012f;
+	const char* path = "benchmark_trajectory.traj";
+
+	World world;
+	world.Reserve(numBodies);
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		glm::vec3 position((float)(i % 100), (float)(i / 100), 0.0f);
+		glm::vec3 velocity = i % 2 == 0 ? glm::vec3(0.5f * sinf((float)i), 2.0f, 0.0f) : glm::vec3(0.0f);
+		ObjectHandle handle = world.Spawn(nullptr, position, velocity, glm::vec3(0.05f));
+		if (i % 2 == 0)
+		{
+			world.SetAcceleration(handle, glm::vec3(0.0f, -9.8f, 0.0f));
+		}
+	}
+
+	TrajectoryRecorder recorder;
+	double stepSeconds[2] = { 0.0, 0.0 };
+	double recordSeconds = 0.0;
+
+	for (int recording = 0; recording < 2; recording++)
+	{
+		if (recording == 1 && !recorder.Open(path))
+		{
+			printf("trajectory: couldn't create %s\n", path);
+			return;
+		}
+
+		for (unsigned int s = 0; s < numSteps; s++)
+		{
+			double start = benchmarkTime();
+			world.BeginStep();
+			for (unsigned int i = 0; i < world.NumObjects(); i++)
+			{
+				world.UpdateObject(i, dt);
+				world.CalculateAABB(i);
+			}
+			world.EndStep();
+			double stepped = benchmarkTime();
+			stepSeconds[recording] += stepped - start;
+
+			if (recording == 1)
+			{
+				recorder.Record(world);
+				recordSeconds += benchmarkTime() - stepped;
+			}
+		}
+	}
+
+	recorder.Close();
+	TrajectoryRecorderStats stats = recorder.Stats();
+
+	results.push_back(BenchmarkResult("trajectory/step_10k", numSteps, stepSeconds[0]));
+	results.push_back(BenchmarkResult("trajectory/record_10k", numSteps, recordSeconds));
+
+	TrajectoryReader reader;
+	if (!reader.Open(path))
+	{
+		printf("trajectory: couldn't read %s back\n", path);
+		return;
+	}
+
+	TrajectoryTick tick;
+	double start = benchmarkTime();
+	for (unsigned int t = 0; t < reader.NumTicks(); t++)
+	{
+		reader.ReadTick(t, tick);
+	}
+	results.push_back(BenchmarkResult("trajectory/read_in_order", reader.NumTicks(), benchmarkTime() - start));
+
+	unsigned int random = 12345;
+	unsigned long long seeks = 0;
+	start = benchmarkTime();
+	double end = start;
+	while (end - start < benchmarkDuration)
+	{
+		random = random * 1664525u + 1013904223u;
+		reader.ReadTick(random % reader.NumTicks(), tick);
+		seeks++;
+		end = benchmarkTime();
+	}
+	results.push_back(BenchmarkResult("trajectory/read_random_tick", seeks, end - start));
+
+	// The last tick has to come back exactly as the world was, unless the writer couldn't keep up and it was dropped.
+	bool matches = reader.ReadTick(reader.NumTicks() - 1, tick) && tick.step == world.CurrentStep() - 1 && tick.positions.size() == world.NumObjects()
+		&& memcmp(tick.positions.data(), world.Positions(), world.NumObjects() * sizeof(glm::vec3)) == 0
+		&& memcmp(tick.velocities.data(), world.Velocities(), world.NumObjects() * sizeof(glm::vec3)) == 0;
+	if (!matches && stats.ticksDropped == 0)
+	{
+		printf("trajectory: the last tick read back doesn't match the world!\n");
+	}
+
+	reader.Close();
+	remove(path);
+
+	printf("trajectory: Record() costs %.2f%% of a step, %llu ticks recorded (%llu dropped), %.1f MB compressed to %.1f MB (%.1fx)\n",
+		100.0 * recordSeconds / stepSeconds[1], stats.ticksRecorded, stats.ticksDropped, stats.rawBytes / 1.0e6, stats.fileBytes / 1.0e6,
+		(double)stats.rawBytes / stats.fileBytes);
+}
+
+// Set by --swept-trace file: a capture of a real game's swept tests (see SweptCapture) for swept_replay to use instead of making its own.
+static std::string sweptTracePath;
+
+// The policy_dispatch world's step, capturing its swept tests.
+typedef PhysicsConfig<float, GridBroadphase, BounceResponse, NullEventSink, false, SweptCapture> CapturingPhysicsConfig;
+
+// Replays captured swept tests through every version of the test: SweptAABB itself, SweptAABBGeneric in float and double,
+// and the batched version in plain C++ and AVX2. Each one's results are checked against the ones captured, and how fast each gets
+// through the pairs is what's measured. Without --swept-trace, the pairs come from capturing one test in 64 from the policy_dispatch
+// world, which also shows what capturing costs its step. (The capture file goes in the working directory and is deleted after.)
+static void benchmarkSweptReplay(std::vector<BenchmarkResult>& results)
+{
+	std::vector<SweptSample> samples;
+
+	if (!sweptTracePath.empty())
+	{
+		if (!loadSweptCapture(sweptTracePath, samples))
+		{
+			printf("swept_replay: couldn't read %s\n", sweptTracePath.c_str());
+			return;
+		}
+	}
+	else
+	{
+		const unsigned int numBodies = 20000;
+		const int numSteps = 50;
+		const float dt = 0.012f;
+		const char* path = "benchmark_swept.trace";
+
+		World plainWorld;
+		fillStepWorld(plainWorld, numBodies);
+		PhysicsWorld<DefaultPhysicsConfig> plain(plainWorld);
+
+		double start = benchmarkTime();
+		for (int s = 0; s < numSteps; s++)
+		{
+			plain.Step(dt);
+		}
+		results.push_back(BenchmarkResult("swept_replay/step_20k", numSteps, benchmarkTime() - start));
+
+		World capturedWorld;
+		fillStepWorld(capturedWorld, numBodies);
+		PhysicsWorld<CapturingPhysicsConfig> captured(capturedWorld);
+		if (!captured.Capture().Open(path, 64))
+		{
+			printf("swept_replay: couldn't create %s\n", path);
+			return;
+		}
+
+		start = benchmarkTime();
+		for (int s = 0; s < numSteps; s++)
+		{
+			captured.Step(dt);
+		}
+		results.push_back(BenchmarkResult("swept_replay/step_20k_capturing_1_in_64", numSteps, benchmarkTime() - start));
+
+		captured.Capture().Close();
+		printf("swept_replay: captured %llu of %llu swept tests\n", captured.Capture().Samples(), captured.Capture().Tests());
+
+		bool loaded = loadSweptCapture(path, samples);
+		remove(path);
+		if (!loaded)
+		{
+			printf("swept_replay: couldn't read %s back\n", path);
+			return;
+		}
+	}
+
+	unsigned int count = (unsigned int)samples.size();
+	if (count == 0)
+	{
+		printf("swept_replay: there are no swept tests to replay\n");
+		return;
+	}
+
+	// The pairs as SweptAABB takes them, and split into arrays for the batched versions.
+	std::vector<AABB> box1s(count), box2s(count);
+	std::vector<glm::vec3> velocities(count);
+	std::vector<float> columns[10];
+	unsigned int hits = 0, stillAxes = 0, cornerHits = 0, touching = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const SweptSample& sample = samples[i];
+		box1s[i] = AABB(glm::vec3(sample.box1Min, 0.0f), glm::vec3(sample.box1Max, 0.0f));
+		box2s[i] = AABB(glm::vec3(sample.box2Min, 0.0f), glm::vec3(sample.box2Max, 0.0f));
+		velocities[i] = glm::vec3(sample.velocity, 0.0f);
+
+		const float values[10] = { sample.box1Min.x, sample.box1Min.y, sample.box1Max.x, sample.box1Max.y, sample.box2Min.x, sample.box2Min.y,
+			sample.box2Max.x, sample.box2Max.y, sample.velocity.x, sample.velocity.y };
+		for (int c = 0; c < 10; c++)
+		{
+			columns[c].push_back(values[c]);
+		}
+
+		// What kind of pairs these are, since that's what decides how the branches in SweptAABB go.
+		bool hit = sample.time <= 1.0f;
+		hits += hit;
+		stillAxes += sample.velocity.x == 0.0f || sample.velocity.y == 0.0f;
+		cornerHits += hit && sample.normalx == 0.0f && sample.normaly == 0.0f;
+		touching += hit && sample.time == 0.0f;
+	}
+
+	SweptPairs pairs;
+	pairs.box1MinX = columns[0].data();
+	pairs.box1MinY = columns[1].data();
+	pairs.box1MaxX = columns[2].data();
+	pairs.box1MaxY = columns[3].data();
+	pairs.box2MinX = columns[4].data();
+	pairs.box2MinY = columns[5].data();
+	pairs.box2MaxX = columns[6].data();
+	pairs.box2MaxY = columns[7].data();
+	pairs.velX = columns[8].data();
+	pairs.velY = columns[9].data();
+
+	std::vector<float> times(count), normalxs(count), normalys(count);
+	const char* names[] = { "swept_replay/sweptaabb", "swept_replay/generic_float", "swept_replay/generic_double", "swept_replay/batch_scalar", "swept_replay/batch_avx2" };
+	int differences[5];
+
+	for (int version = 0; version < 5; version++)
+	{
+		differences[version] = -1;
+		if (version == 4 && !transformBatchUsesAVX2())
+		{
+			continue;
+		}
+
+		unsigned long long tested = 0;
+		PerfCounts counts = benchmarkCounts();
+		double start = benchmarkTime();
+		double end = start;
+		while (end - start < benchmarkDuration)
+		{
+			if (version == 0)
+			{
+				for (unsigned int i = 0; i < count; i++)
+				{
+					// SweptAABB leaves the normals alone on a corner hit, and the captures start them at zero.
+					float normalx = 0.0f, normaly = 0.0f;
+					times[i] = SweptAABB(&box1s[i], &box2s[i], velocities[i], normalx, normaly);
+					normalxs[i] = normalx;
+					normalys[i] = normaly;
+				}
+			}
+			else if (version == 1)
+			{
+				for (unsigned int i = 0; i < count; i++)
+				{
+					times[i] = SweptAABBGeneric<float>(box1s[i], box2s[i], velocities[i], normalxs[i], normalys[i]);
+				}
+			}
+			else if (version == 2)
+			{
+				for (unsigned int i = 0; i < count; i++)
+				{
+					double normalx, normaly;
+					times[i] = (float)SweptAABBGeneric<double>(box1s[i], box2s[i], velocities[i], normalx, normaly);
+					normalxs[i] = (float)normalx;
+					normalys[i] = (float)normaly;
+				}
+			}
+			else if (version == 3)
+			{
+				sweptAABBBatchScalar(count, pairs, times.data(), normalxs.data(), normalys.data());
+			}
+			else
+			{
+				sweptAABBBatch(count, pairs, times.data(), normalxs.data(), normalys.data());
+			}
+
+			tested += count;
+			end = benchmarkTime();
+		}
+
+		results.push_back(BenchmarkResult(names[version], tested, end - start, benchmarkCounts() - counts));
+
+		// The times are compared bit for bit, since every float version should come out exactly the same.
+		differences[version] = 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (memcmp(&times[i], &samples[i].time, sizeof(float)) != 0 || normalxs[i] != samples[i].normalx || normalys[i] != samples[i].normaly)
+			{
+				differences[version]++;
+			}
+		}
+	}
+
+	printf("swept_replay: %u pairs, %.1f%% hit, %.1f%% with an axis not moving, %.2f%% corner hits, %.2f%% hits already touching\n", count,
+		100.0 * hits / count, 100.0 * stillAxes / count, 100.0 * cornerHits / count, 100.0 * touching / count);
+	for (int version = 0; version < 5; version++)
+	{
+		if (differences[version] >= 0)
+		{
+			// Double rounds differently, so a few pairs right on the edge of hitting can go the other way.
+			printf("%-32s %u pairs differ from the capture%s\n", names[version], differences[version], version == 2 ? " (double precision)" : "");
+		}
+	}
+}
+
+// How much the velocity sign checks at the top of SweptAABB cost when the signs can't be predicted. The same million pairs are run
+// twice: once with every pair moving up and to the right, and once with about half of them mirrored on each axis (the boxes and the
+// velocity), so they move every which way in no order. A mirrored pair hits or misses exactly like the original, so all that changes
+// between the runs is which way the sign checks go. The batched version, with no branches, is run on both for comparison.
+// With --counters, the difference in branch misses per pair between the runs is what the sign checks mispredict.
+static void benchmarkSweptBranches(std::vector<BenchmarkResult>& results)
+{
+	const unsigned int numPairs = 1000000;
+
+	std::vector<AABB> box1s[2], box2s[2];
+	std::vector<glm::vec3> velocities[2];
+	std::vector<float> columns[2][10];
+
+	unsigned int random = 12345;
+	for (unsigned int i = 0; i < numPairs; i++)
+	{
+		// A box of size 1 at the origin, moving up and to the right, and a second box somewhere near it. About one pair in eight hits.
+		random = random * 1664525u + 1013904223u;
+		float x = ((random >> 8) % 4000) * 0.001f - 1.0f;
+		random = random * 1664525u + 1013904223u;
+		float y = ((random >> 8) % 4000) * 0.001f - 1.0f;
+		random = random * 1664525u + 1013904223u;
+		glm::vec3 velocity(((random >> 8) % 1000 + 1) * 0.001f, ((random >> 16) % 1000 + 1) * 0.001f, 0.0f);
+
+		AABB box1(glm::vec3(0.0f), glm::vec3(1.0f, 1.0f, 0.0f));
+		AABB box2(glm::vec3(x, y, 0.0f) + glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(x, y, 0.0f) + glm::vec3(1.5f, 1.5f, 0.0f));
+
+		for (int mixed = 0; mixed < 2; mixed++)
+		{
+			if (mixed == 1)
+			{
+				random = random * 1664525u + 1013904223u;
+				for (int axis = 0; axis < 2; axis++)
+				{
+					if ((random >> (16 + axis)) & 1)
+					{
+						float box1Min = box1.min[axis], box2Min = box2.min[axis];
+						box1.min[axis] = -box1.max[axis];
+						box1.max[axis] = -box1Min;
+						box2.min[axis] = -box2.max[axis];
+						box2.max[axis] = -box2Min;
+						velocity[axis] = -velocity[axis];
+					}
+				}
+			}
+
+			box1s[mixed].push_back(box1);
+			box2s[mixed].push_back(box2);
+			velocities[mixed].push_back(velocity);
+
+			const float values[10] = { box1.min.x, box1.min.y, box1.max.x, box1.max.y, box2.min.x, box2.min.y, box2.max.x, box2.max.y, velocity.x, velocity.y };
+			for (int c = 0; c < 10; c++)
+			{
+				columns[mixed][c].push_back(values[c]);
+			}
+		}
+	}
+
+	const char* names[2][2] =
+	{
+		{ "swept_branches/sweptaabb/same_signs", "swept_branches/sweptaabb/mixed_signs" },
+		{ "swept_branches/batch/same_signs", "swept_branches/batch/mixed_signs" }
+	};
+	std::vector<float> times(numPairs), normalxs(numPairs), normalys(numPairs);
+	double branchMisses[2][2];
+	double nanoseconds[2][2];
+	float checksum[2] = { 0.0f, 0.0f };
+
+	for (int version = 0; version < 2; version++)
+	{
+		for (int mixed = 0; mixed < 2; mixed++)
+		{
+			SweptPairs pairs;
+			pairs.box1MinX = columns[mixed][0].data();
+			pairs.box1MinY = columns[mixed][1].data();
+			pairs.box1MaxX = columns[mixed][2].data();
+			pairs.box1MaxY = columns[mixed][3].data();
+			pairs.box2MinX = columns[mixed][4].data();
+			pairs.box2MinY = columns[mixed][5].data();
+			pairs.box2MaxX = columns[mixed][6].data();
+			pairs.box2MaxY = columns[mixed][7].data();
+			pairs.velX = columns[mixed][8].data();
+			pairs.velY = columns[mixed][9].data();
+
+			unsigned long long tested = 0;
+			PerfCounts counts = benchmarkCounts();
+			double start = benchmarkTime();
+			double end = start;
+			while (end - start < benchmarkDuration)
+			{
+				if (version == 0)
+				{
+					for (unsigned int i = 0; i < numPairs; i++)
+					{
+						float normalx = 0.0f, normaly = 0.0f;
+						times[i] = SweptAABB(&box1s[mixed][i], &box2s[mixed][i], velocities[mixed][i], normalx, normaly);
+					}
+				}
+				else
+				{
+					sweptAABBBatch(numPairs, pairs, times.data(), normalxs.data(), normalys.data());
+				}
+
+				tested += numPairs;
+				end = benchmarkTime();
+			}
+			counts = benchmarkCounts() - counts;
+
+			results.push_back(BenchmarkResult(names[version][mixed], tested, end - start, counts));
+			branchMisses[version][mixed] = (double)counts[PERF_BRANCH_MISSES] / tested;
+			nanoseconds[version][mixed] = (end - start) * 1.0e9 / tested;
+
+			for (unsigned int i = 0; i < numPairs; i++)
+			{
+				checksum[mixed] += times[i];
+			}
+		}
+	}
+
+	// Mirroring doesn't change when a pair hits, so both runs have to come out the same.
+	if (checksum[0] != checksum[1])
+	{
+		printf("swept_branches: the mirrored pairs didn't give the same times!\n");
+	}
+
+	printf("swept_branches: mixing the velocity signs costs SweptAABB %.2f ns a pair, and the batched version %.2f ns\n",
+		nanoseconds[0][1] - nanoseconds[0][0], nanoseconds[1][1] - nanoseconds[1][0]);
+	if (benchmarkCounters.Has(PERF_BRANCH_MISSES))
+	{
+		printf("swept_branches: SweptAABB mispredicts %.3f more branches a pair on the sign checks (%.3f with the same signs, %.3f mixed), the batched version %.3f\n",
+			branchMisses[0][1] - branchMisses[0][0], branchMisses[0][0], branchMisses[0][1], branchMisses[1][1] - branchMisses[1][0]);
+	}
+}
+
+struct BenchmarkEntry
+{
+	const char* name;
+	BenchmarkFunction function;
+
+	// Part of the "collision" suite: the swept test kernels, the broadphase and whole physics steps. What to compare before and after
+	// touching anything in the collision code.
+	bool collision;
+};
+
+// Every benchmark the program knows about. Add new ones here.
+static const BenchmarkEntry benchmarks[] =
+{
+	{ "snapshot_contention", benchmarkSnapshotContention, false },
+	{ "pool_churn", benchmarkPoolChurn, false },
+	{ "bulk_spawn", benchmarkBulkSpawn, false },
+	{ "policy_dispatch", benchmarkPolicyDispatch, true },
+	{ "step_phases", benchmarkStepPhases, true },
+	{ "broadphase", benchmarkBroadphase, true },
+	{ "render_upload", benchmarkRenderUpload, false },
+	{ "transform_batch", benchmarkTransformBatch, false },
+	{ "aabb", benchmarkAABB, true },
+	{ "render_queue", benchmarkRenderQueue, false },
+	{ "shader_startup", benchmarkShaderStartup, false },
+	{ "frame_pacing", benchmarkFramePacing, false },
+	{ "trajectory", benchmarkTrajectory, false },
+	{ "swept_replay", benchmarkSweptReplay, true },
+	{ "swept_branches", benchmarkSweptBranches, true },
+};
+
+// Whether the benchmark is picked by the filter: its name starts with the filter, or the filter names a suite it's in.
+static bool benchmarkMatches(const BenchmarkEntry& entry, const char* filter)
+{
+	return strncmp(entry.name, filter, strlen(filter)) == 0 || (entry.collision && strcmp(filter, "collision") == 0);
+}
+
+int runBenchmarks(int argc, char** argv)
+{
+	// The first argument after --bench (if there is one, and it isn't another option) filters which benchmarks run.
+	const char* filter = "";
+	bool counters = false;
+	int trials = 0;
+	std::string savePath;
+	std::string comparePath;
+	std::string againstPath;
+	double threshold = 5.0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+		{
+			filter = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--swept-trace") == 0 && i + 1 < argc)
+		{
+			sweptTracePath = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--counters") == 0)
+		{
+			counters = true;
+		}
+		if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc)
+		{
+			trials = atoi(argv[i + 1]);
+		}
+		if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+		{
+			savePath = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+		{
+			comparePath = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--against") == 0 && i + 1 < argc)
+		{
+			againstPath = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+		{
+			threshold = atof(argv[i + 1]);
+		}
+	}
+
+	// A run that's going to be compared needs a few trials of everything, or there's no telling a change from noise.
+	if (trials < 1)
+	{
+		trials = savePath.empty() && comparePath.empty() ? 1 : 5;
+	}
+
+	BenchmarkRun baseline;
+	if (!comparePath.empty() && !loadBenchmarkRun(comparePath, baseline))
+	{
+		printf("Couldn't read the benchmark run %s.\n", comparePath.c_str());
+		return 1;
+	}
+
+	// Two runs saved earlier are compared without running anything.
+	if (!againstPath.empty())
+	{
+		BenchmarkRun current;
+		if (comparePath.empty() || !loadBenchmarkRun(againstPath, current))
+		{
+			printf("--against needs a run to compare against (--compare file), and a run it can read.\n");
+			return 1;
+		}
+
+		printf("Comparing %s (%s) with %s (%s):\n", againstPath.c_str(), current.Info("date").c_str(), comparePath.c_str(), baseline.Info("date").c_str());
+		return compareBenchmarkRuns(baseline, current, threshold) > 0 ? 2 : 0;
+	}
+
+	if (counters && !benchmarkCounters.Open())
+	{
+		printf("The CPU's performance counters aren't available here (see PerfCounters.h), so there won't be any counts.\n");
+	}
+
+	BenchmarkRun run;
+	describeBenchmarkRun(run);
+	run.info.push_back(std::make_pair("benchmarks", filter[0] != '\0' ? filter : "all"));
+	run.info.push_back(std::make_pair("trials", std::to_string(trials)));
+	if (!sweptTracePath.empty())
+	{
+		run.info.push_back(std::make_pair("swept trace", sweptTracePath));
+	}
+
+	// Each trial runs every benchmark once, rather than each benchmark running all of its trials in a row, so something slowing the
+	// machine down for a while (another program, the CPU heating up) spreads over all the benchmarks instead of landing on one of them.
+	// results only keeps the last trial's, for the tables below. The run keeps every trial.
+	std::vector<BenchmarkResult> results;
+	int numRun = 0;
+
+	for (int t = 0; t < trials; t++)
+	{
+		results.clear();
+		numRun = 0;
+
+		for (unsigned int i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+		{
+			if (!benchmarkMatches(benchmarks[i], filter))
+			{
+				continue;
+			}
+
+			if (trials > 1)
+			{
+				printf("Running %s (trial %d of %d)...\n", benchmarks[i].name, t + 1, trials);
+			}
+			else
+			{
+				printf("Running %s...\n", benchmarks[i].name);
+			}
+			benchmarks[i].function(results);
+			numRun++;
+		}
+
+		if (numRun == 0)
+		{
+			printf("No benchmark matches \"%s\".\n", filter);
+			return 1;
+		}
+
+		for (unsigned int r = 0; r < results.size(); r++)
+		{
+			run.Add(results[r]);
+		}
+	}
+
+	if (trials == 1)
+	{
+		printf("\n%-48s %14s %10s %12s\n", "benchmark", "operations", "seconds", "ns/op");
+		for (unsigned int i = 0; i < results.size(); i++)
+		{
+			printf("%-48s %14llu %10.4f %12.2f\n", results[i].name.c_str(), results[i].operations, results[i].seconds, results[i].NanosecondsPerOperation());
+		}
+	}
+	else
+	{
+		printf("\n%-48s %12s %26s\n", "benchmark", "median ns/op", "95% confidence interval");
+		for (unsigned int i = 0; i < run.records.size(); i++)
+		{
+			BenchmarkSummary summary = summarizeTrials(run.records[i].trials);
+			printf("%-48s %12.2f %12.2f to %10.2f\n", run.records[i].name.c_str(), summary.median, summary.low, summary.high);
+		}
+	}
+
+	// The counts per operation (per pair, per body, ...) of the results that have them, from the last trial. A counter the CPU doesn't have shows as a dash.
+	if (benchmarkCounters.IsOpen())
+	{
+		printf("\n%-48s %10s %12s %6s %10s %10s %14s\n", "per operation", "cycles", "instructions", "IPC", "L1D miss", "LLC miss", "branch miss");
+		for (unsigned int i = 0; i < results.size(); i++)
+		{
+			if (!results[i].counted || results[i].operations == 0)
+			{
+				continue;
+			}
+
+			const PerfCounts& counts = results[i].counts;
+			double operations = (double)results[i].operations;
+			std::string columns[PERF_COUNTERS];
+			for (int c = 0; c < PERF_COUNTERS; c++)
+			{
+				char text[32];
+				if (benchmarkCounters.Has((PerfCounter)c))
+				{
+					snprintf(text, sizeof(text), "%.3f", counts.values[c] / operations);
+				}
+				else
+				{
+					snprintf(text, sizeof(text), "-");
+				}
+				columns[c] = text;
+			}
+
+			char ipc[32] = "-";
+			if (counts[PERF_CYCLES] > 0 && benchmarkCounters.Has(PERF_INSTRUCTIONS))
+			{
+				snprintf(ipc, sizeof(ipc), "%.2f", (double)counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES]);
+			}
+
+			printf("%-48s %10s %12s %6s %10s %10s %14s\n", results[i].name.c_str(), columns[PERF_CYCLES].c_str(), columns[PERF_INSTRUCTIONS].c_str(), ipc,
+				columns[PERF_L1D_MISSES].c_str(), columns[PERF_LLC_MISSES].c_str(), columns[PERF_BRANCH_MISSES].c_str());
+		}
+	}
+
+	if (!savePath.empty())
+	{
+		if (!saveBenchmarkRun(savePath, run))
+		{
+			printf("Couldn't write the benchmark run to %s.\n", savePath.c_str());
+			return 1;
+		}
+
+		printf("\nSaved the run to %s.\n", savePath.c_str());
+	}
+
+	// Exits with 2 if anything got slower, so a build script can stop on it.
+	if (!comparePath.empty())
+	{
+		printf("\nCompared with %s (%s):\n", comparePath.c_str(), baseline.Info("date").c_str());
+		return compareBenchmarkRuns(baseline, run, threshold) > 0 ? 2 : 0;
+	}
+
+	return 0;
+}
+
+#endif // _BENCHMARK_CPP
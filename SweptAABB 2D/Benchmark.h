@@ -0,0 +1,99 @@
+/*
+Title: Swept AABB-2D
+File Name: Benchmark.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "PerfCounters.h"
+#include <string>
+#include <vector>
+
+// One measured number from a benchmark: how many operations ran in how many seconds, and optionally what the CPU's counters
+// counted over them (see benchmarkCounts in Benchmark.cpp), which get reported per operation.
+struct BenchmarkResult
+{
+	std::string name;
+	unsigned long long operations;
+	double seconds;
+	PerfCounts counts;
+	bool counted;
+
+	BenchmarkResult(const std::string& inName, unsigned long long ops, double secs)
+	{
+		name = inName;
+		operations = ops;
+		seconds = secs;
+		counted = false;
+	}
+	BenchmarkResult(const std::string& inName, unsigned long long ops, double secs, const PerfCounts& inCounts)
+	{
+		name = inName;
+		operations = ops;
+		seconds = secs;
+		counts = inCounts;
+		counted = true;
+	}
+
+	double NanosecondsPerOperation() const
+	{
+		return operations > 0 ? seconds * 1.0e9 / operations : 0.0;
+	}
+};
+
+// A benchmark runs its work and adds one or more results to the list.
+typedef void (*BenchmarkFunction)(std::vector<BenchmarkResult>&);
+
+// A high resolution clock in seconds, for timing benchmarks. (glfwGetTime() needs GLFW to be initialized, and the benchmarks run without a window.)
+double benchmarkTime();
+
+// Runs the benchmarks instead of the demo. Called from main() when the program is started as:
+//     SweptAABB_2D --bench [name] [--swept-trace file] [--counters] [--trials n] [--save file] [--compare file [--against file]] [--threshold percent]
+// With a name, only benchmarks whose name starts with it are run. "collision" runs the collision suite instead: the swept test kernels,
+// the broadphase and whole physics steps. --swept-trace gives swept_replay a capture to replay (see SweptCapture).
+// --counters also reads the CPU's performance counters (see PerfCounters) around the benchmarks that support it.
+// --trials runs everything n times and reports the median of each result with a confidence interval (5 by default when saving or comparing, otherwise 1).
+// --save writes the run, along with the build and machine it ran on, to a file (see BenchmarkBaseline). --compare compares the run against
+// one saved earlier and flags every result that got slower by more than --threshold percent (5 by default). With --against, nothing is run
+// and the two saved runs are compared instead. So checking a change to the collision code goes:
+//     SweptAABB_2D --bench collision --save before.txt
+//     (make the change and build again)
+//     SweptAABB_2D --bench collision --compare before.txt
+// Returns the exit code for main(): 0 if all went well, 1 if something couldn't run, and 2 if the comparison found something slower.
+int runBenchmarks(int argc, char** argv);
+
+#endif //_BENCHMARK_H
@@ -0,0 +1,486 @@
+/*
+Title: Swept AABB-2D
+File Name: BenchmarkBaseline.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BENCHMARK_BASELINE_CPP
+#define _BENCHMARK_BASELINE_CPP
+
+#include "BenchmarkBaseline.h"
+#include "TransformBatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX	// Otherwise windows.h defines min and max macros that break std::min
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+// How many times the trials are resampled to find the confidence interval. More only moves the ends of the interval by a tiny bit.
+static const int bootstrapResamples = 2000;
+
+void BenchmarkRun::Add(const BenchmarkResult& result)
+{
+	for (unsigned int i = 0; i < records.size(); i++)
+	{
+		if (records[i].name == result.name)
+		{
+			records[i].trials.push_back(result.NanosecondsPerOperation());
+			return;
+		}
+	}
+
+	BenchmarkRecord record;
+	record.name = result.name;
+	record.trials.push_back(result.NanosecondsPerOperation());
+	records.push_back(record);
+}
+
+const BenchmarkRecord* BenchmarkRun::Find(const std::string& name) const
+{
+	for (unsigned int i = 0; i < records.size(); i++)
+	{
+		if (records[i].name == name)
+		{
+			return &records[i];
+		}
+	}
+
+	return nullptr;
+}
+
+std::string BenchmarkRun::Info(const std::string& key) const
+{
+	for (unsigned int i = 0; i < info.size(); i++)
+	{
+		if (info[i].first == key)
+		{
+			return info[i].second;
+		}
+	}
+
+	return "";
+}
+
+static double medianOf(std::vector<double>& values)
+{
+	unsigned int middle = (unsigned int)values.size() / 2;
+	std::nth_element(values.begin(), values.begin() + middle, values.end());
+	double median = values[middle];
+
+	// With an even number of values, the median is halfway between the two in the middle. The lower one is the biggest of the first half.
+	if (values.size() % 2 == 0)
+	{
+		median = (median + *std::max_element(values.begin(), values.begin() + middle)) * 0.5;
+	}
+
+	return median;
+}
+
+BenchmarkSummary summarizeTrials(const std::vector<double>& trials)
+{
+	BenchmarkSummary summary;
+	summary.median = summary.low = summary.high = 0.0;
+
+	if (trials.empty())
+	{
+		return summary;
+	}
+
+	std::vector<double> values(trials);
+	summary.median = summary.low = summary.high = medianOf(values);
+
+	if (trials.size() < 2)
+	{
+		return summary;
+	}
+
+	// Always the same seed, so summarizing the same trials twice gives exactly the same interval.
+	unsigned int random = 12345;
+	std::vector<double> medians(bootstrapResamples);
+	std::vector<double> resample(trials.size());
+
+	for (int r = 0; r < bootstrapResamples; r++)
+	{
+		for (unsigned int i = 0; i < resample.size(); i++)
+		{
+			random = random * 1664525u + 1013904223u;
+			resample[i] = trials[(random >> 8) % trials.size()];
+		}
+
+		medians[r] = medianOf(resample);
+	}
+
+	std::sort(medians.begin(), medians.end());
+	summary.low = medians[(int)(bootstrapResamples * 0.025)];
+	summary.high = medians[(int)(bootstrapResamples * 0.975) - 1];
+
+	return summary;
+}
+
+// The CPU's name as it reports it, like "Intel(R) Core(TM) i7-4770 CPU @ 3.40GHz".
+static std::string cpuName()
+{
+	unsigned int brand[12] = { 0 };
+
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0x80000000);
+	if ((unsigned int)info[0] < 0x80000004)
+	{
+		return "unknown";
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		__cpuid((int*)&brand[i * 4], 0x80000002 + i);
+	}
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004)
+	{
+		return "unknown";
+	}
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		__get_cpuid(0x80000002 + i, &brand[i * 4], &brand[i * 4 + 1], &brand[i * 4 + 2], &brand[i * 4 + 3]);
+	}
+#else
+	return "unknown";
+#endif
+
+	char name[sizeof(brand) + 1];
+	memcpy(name, brand, sizeof(brand));
+	name[sizeof(brand)] = '\0';
+
+	// Some CPUs pad the front of the name with spaces.
+	const char* start = name;
+	while (*start == ' ')
+	{
+		start++;
+	}
+
+	return start;
+}
+
+static std::string hostName()
+{
+	char name[256] = "";
+
+#ifdef _WIN32
+	DWORD size = sizeof(name);
+	if (!GetComputerNameA(name, &size))
+	{
+		return "unknown";
+	}
+#else
+	if (gethostname(name, sizeof(name) - 1) != 0)
+	{
+		return "unknown";
+	}
+	name[sizeof(name) - 1] = '\0';
+#endif
+
+	return name;
+}
+
+void describeBenchmarkRun(BenchmarkRun& run)
+{
+	// Which compiler built this, and how. These are what make two runs of the same code on the same machine not comparable.
+#if defined(__clang__)
+	run.info.push_back(std::make_pair("compiler", std::string("clang ") + __clang_version__));
+#elif defined(__GNUC__)
+	run.info.push_back(std::make_pair("compiler", std::string("gcc ") + __VERSION__));
+#elif defined(_MSC_VER)
+	run.info.push_back(std::make_pair("compiler", "msvc " + std::to_string(_MSC_FULL_VER)));
+#else
+	run.info.push_back(std::make_pair("compiler", "unknown"));
+#endif
+
+	std::string build;
+#ifdef NDEBUG
+	build = "release";
+#else
+	build = "debug (asserts on)";
+#endif
+#if defined(__GNUC__) && !defined(__OPTIMIZE__)
+	build += ", not optimized";
+#endif
+#ifdef __AVX2__
+	build += ", built for avx2";
+#endif
+	build += ", " + std::to_string(sizeof(void*) * 8) + "-bit";
+	run.info.push_back(std::make_pair("build", build));
+	run.info.push_back(std::make_pair("built", std::string(__DATE__) + " " + __TIME__));
+
+	// And what it ran on.
+	run.info.push_back(std::make_pair("host", hostName()));
+	run.info.push_back(std::make_pair("cpu", cpuName()));
+	run.info.push_back(std::make_pair("cores", std::to_string(std::thread::hardware_concurrency())));
+	run.info.push_back(std::make_pair("avx2 kernels", transformBatchUsesAVX2() ? "yes" : "no"));
+
+	char date[64];
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+	run.info.push_back(std::make_pair("date", date));
+}
+
+bool saveBenchmarkRun(const std::string& path, const BenchmarkRun& run)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "# SweptAABB_2D benchmark run: the ns/op of every trial of every result\n");
+
+	for (unsigned int i = 0; i < run.info.size(); i++)
+	{
+		fprintf(file, "info\t%s\t%s\n", run.info[i].first.c_str(), run.info[i].second.c_str());
+	}
+
+	for (unsigned int i = 0; i < run.records.size(); i++)
+	{
+		fprintf(file, "result\t%s", run.records[i].name.c_str());
+		for (unsigned int t = 0; t < run.records[i].trials.size(); t++)
+		{
+			// Enough digits that a saved run compares exactly like the one still in memory.
+			fprintf(file, "\t%.17g", run.records[i].trials[t]);
+		}
+		fprintf(file, "\n");
+	}
+
+	bool written = ferror(file) == 0;
+	return fclose(file) == 0 && written;
+}
+
+// Splits a line at its tabs.
+static std::vector<std::string> splitTabs(const std::string& line)
+{
+	std::vector<std::string> fields;
+	size_t start = 0;
+
+	while (true)
+	{
+		size_t tab = line.find('\t', start);
+		if (tab == std::string::npos)
+		{
+			fields.push_back(line.substr(start));
+			return fields;
+		}
+
+		fields.push_back(line.substr(start, tab - start));
+		start = tab + 1;
+	}
+}
+
+bool loadBenchmarkRun(const std::string& path, BenchmarkRun& run)
+{
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	run.info.clear();
+	run.records.clear();
+
+	std::string line;
+	bool ok = true;
+	int c;
+
+	do
+	{
+		c = fgetc(file);
+		if (c != '\n' && c != EOF)
+		{
+			if (c != '\r')
+			{
+				line += (char)c;
+			}
+			continue;
+		}
+
+		std::vector<std::string> fields = splitTabs(line);
+		line.clear();
+
+		if (fields[0].empty() || fields[0][0] == '#')
+		{
+			continue;
+		}
+
+		if (fields[0] == "info" && fields.size() == 3)
+		{
+			run.info.push_back(std::make_pair(fields[1], fields[2]));
+		}
+		else if (fields[0] == "result" && fields.size() >= 3)
+		{
+			BenchmarkRecord record;
+			record.name = fields[1];
+
+			for (unsigned int f = 2; f < fields.size(); f++)
+			{
+				char* end;
+				double value = strtod(fields[f].c_str(), &end);
+				if (end == fields[f].c_str() || *end != '\0')
+				{
+					ok = false;
+				}
+				record.trials.push_back(value);
+			}
+
+			run.records.push_back(record);
+		}
+		else
+		{
+			// Not something this version writes. Better to refuse the file than to compare against half of it.
+			ok = false;
+		}
+	} while (c != EOF);
+
+	fclose(file);
+	return ok;
+}
+
+int compareBenchmarkRuns(const BenchmarkRun& baseline, const BenchmarkRun& current, double thresholdPercent)
+{
+	// Differences in what the runs were measured on. The date always differs, so it's left out.
+	bool sameSetup = true;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const BenchmarkRun& run = pass == 0 ? baseline : current;
+
+		for (unsigned int i = 0; i < run.info.size(); i++)
+		{
+			const std::string& key = run.info[i].first;
+			if (key == "date" || (pass == 1 && baseline.Info(key) != "") || baseline.Info(key) == current.Info(key))
+			{
+				continue;
+			}
+
+			if (sameSetup)
+			{
+				printf("The runs weren't measured on the same setup:\n");
+				sameSetup = false;
+			}
+			printf("    %-14s baseline: %s\n    %-14s current:  %s\n", key.c_str(), baseline.Info(key).c_str(), "", current.Info(key).c_str());
+		}
+	}
+
+	int regressions = 0;
+	int improvements = 0;
+	int fewTrials = 0;
+
+	printf("\n%-48s %30s %30s %9s\n", "benchmark (ns/op, median [95% CI])", "baseline", "current", "change");
+	for (unsigned int i = 0; i < current.records.size(); i++)
+	{
+		const BenchmarkRecord& now = current.records[i];
+		const BenchmarkRecord* before = baseline.Find(now.name);
+		if (before == nullptr)
+		{
+			continue;
+		}
+
+		BenchmarkSummary a = summarizeTrials(before->trials);
+		BenchmarkSummary b = summarizeTrials(now.trials);
+		if (before->trials.size() < 3 || now.trials.size() < 3)
+		{
+			fewTrials++;
+		}
+
+		double change = a.median > 0.0 ? (b.median - a.median) / a.median * 100.0 : 0.0;
+
+		// Past the threshold, but the intervals overlap: it might be a real change, or just noise. More trials would tell.
+		const char* verdict = "";
+		if (change > thresholdPercent)
+		{
+			verdict = b.low > a.high ? "SLOWER" : "unclear";
+		}
+		else if (change < -thresholdPercent)
+		{
+			verdict = b.high < a.low ? "faster" : "unclear";
+		}
+
+		if (strcmp(verdict, "SLOWER") == 0)
+		{
+			regressions++;
+		}
+		if (strcmp(verdict, "faster") == 0)
+		{
+			improvements++;
+		}
+
+		char baselineText[64], currentText[64];
+		snprintf(baselineText, sizeof(baselineText), "%.2f [%.2f, %.2f]", a.median, a.low, a.high);
+		snprintf(currentText, sizeof(currentText), "%.2f [%.2f, %.2f]", b.median, b.low, b.high);
+		printf("%-48s %30s %30s %+8.1f%% %s\n", now.name.c_str(), baselineText, currentText, change, verdict);
+	}
+
+	// Results that were added or removed since the baseline can't be compared, but shouldn't disappear without a word either.
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const BenchmarkRun& run = pass == 0 ? baseline : current;
+		const BenchmarkRun& other = pass == 0 ? current : baseline;
+
+		for (unsigned int i = 0; i < run.records.size(); i++)
+		{
+			if (other.Find(run.records[i].name) == nullptr)
+			{
+				printf("%-48s only in the %s run\n", run.records[i].name.c_str(), pass == 0 ? "baseline" : "current");
+			}
+		}
+	}
+
+	if (fewTrials > 0)
+	{
+		printf("\n%d results have fewer than 3 trials on one side, so their intervals say little. Run with --trials 5 or more.\n", fewTrials);
+	}
+
+	printf("\n%d slower and %d faster by more than %.1f%%.\n", regressions, improvements, thresholdPercent);
+	return regressions;
+}
+
+#endif // _BENCHMARK_BASELINE_CPP
@@ -0,0 +1,98 @@
+/*
+Title: Swept AABB-2D
+File Name: BenchmarkBaseline.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BENCHMARK_BASELINE_H
+#define _BENCHMARK_BASELINE_H
+
+#include "Benchmark.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Everything one benchmark result measured over a run: its nanoseconds per operation in each trial.
+struct BenchmarkRecord
+{
+	std::string name;
+	std::vector<double> trials;
+};
+
+// A whole benchmark run, kept so a later build can be compared against it. Along with the results it keeps what they were measured on
+// (compiler, build flags, machine, date...), since a difference between two runs means little if they didn't run on the same thing.
+// Saved as text, one line each, so it can be read, diffed and checked in next to the code:
+//     # comment
+//     info<tab>key<tab>value
+//     result<tab>name<tab>ns/op of trial 1<tab>ns/op of trial 2...
+struct BenchmarkRun
+{
+	std::vector<std::pair<std::string, std::string> > info;
+	std::vector<BenchmarkRecord> records;
+
+	// Adds the result's time as one more trial of the record with its name (a new record the first time the name comes up).
+	void Add(const BenchmarkResult&);
+
+	// The record with this name, or null if the run doesn't have one.
+	const BenchmarkRecord* Find(const std::string& name) const;
+
+	// The value of the info with this key, or an empty string.
+	std::string Info(const std::string& key) const;
+};
+
+// The median of a benchmark's trials, and a 95% confidence interval around it. The interval comes from bootstrapping: the trials are
+// resampled (with replacement) many times, and low and high are where the middle 95% of the resampled medians fall. That doesn't assume
+// the times are normally distributed, which they usually aren't (a benchmark can only be slowed down by noise, never sped up).
+// With one trial there's nothing to resample, and the interval is just the median.
+struct BenchmarkSummary
+{
+	double median;
+	double low, high;
+};
+BenchmarkSummary summarizeTrials(const std::vector<double>& trials);
+
+// Fills in the run's info with this build (compiler, flags, when it was built) and the machine it's running on (host name, CPU, cores, date).
+void describeBenchmarkRun(BenchmarkRun&);
+
+bool saveBenchmarkRun(const std::string& path, const BenchmarkRun&);
+bool loadBenchmarkRun(const std::string& path, BenchmarkRun&);
+
+// Prints the results the two runs have in common side by side and returns how many got slower. A result has only regressed if its median
+// slowed down by more than thresholdPercent AND the two confidence intervals don't overlap, so one noisy trial can't fail the comparison
+// and neither can a real but tiny slowdown. Faster results are found the same way and reported, but don't count.
+// Also prints any info the runs disagree on, and the results only one of them has.
+int compareBenchmarkRuns(const BenchmarkRun& baseline, const BenchmarkRun& current, double thresholdPercent);
+
+#endif //_BENCHMARK_BASELINE_H
@@ -0,0 +1,156 @@
+/*
+Title: Swept AABB-2D
+File Name: BodyBuffer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BODY_BUFFER_CPP
+#define _BODY_BUFFER_CPP
+
+#include "BodyBuffer.h"
+
+BodyBuffer::BodyBuffer()
+{
+	ssbo = 0;
+}
+
+BodyBuffer::~BodyBuffer()
+{
+	// The buffer is only made by the first Draw, so there may be nothing to delete (and no OpenGL to call).
+	if (ssbo != 0)
+	{
+		glDeleteBuffers(1, &ssbo);
+	}
+}
+
+bool BodyBuffer::IsSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object;
+}
+
+void BodyGatherer::Gather(World& world, const std::vector<unsigned int>* visible)
+{
+	// Either the objects we were given or every object in the world. The k-th body gathered is object (*visible)[k] (or just k).
+	unsigned int numObjects = visible != nullptr ? (unsigned int)visible->size() : world.NumObjects();
+	Model** models = world.Models();
+	const glm::vec3* positions = world.Positions();
+	const glm::vec3* scales = world.Scales();
+
+	// First pass: give each model a group and count its bodies.
+	modelGroups.clear();
+	drawModels.clear();
+	drawCounts.clear();
+	objectGroups.resize(numObjects);
+
+	// Objects next to each other usually share a model, so remember the last one and skip the map lookup when it's the same.
+	Model* lastModel = nullptr;
+	unsigned int lastGroup = 0;
+
+	for (unsigned int k = 0; k < numObjects; k++)
+	{
+		unsigned int i = visible != nullptr ? (*visible)[k] : k;
+
+		if (models[i] != lastModel || drawModels.empty())
+		{
+			std::pair<std::unordered_map<Model*, unsigned int>::iterator, bool> inserted = modelGroups.insert(std::make_pair(models[i], (unsigned int)drawModels.size()));
+
+			if (inserted.second)
+			{
+				drawModels.push_back(models[i]);
+				drawCounts.push_back(0);
+			}
+
+			lastModel = models[i];
+			lastGroup = inserted.first->second;
+		}
+
+		objectGroups[k] = lastGroup;
+		drawCounts[lastGroup]++;
+	}
+
+	// Each group's bodies sit together, one group after the other.
+	drawFirsts.resize(drawModels.size());
+	unsigned int next = 0;
+
+	for (unsigned int g = 0; g < drawModels.size(); g++)
+	{
+		drawFirsts[g] = next;
+		next += drawCounts[g];
+	}
+
+	// Second pass: copy the bodies into place. The cursors start at each group's first body and move along as it fills up.
+	bodies.resize(numObjects);
+	groupCursors.assign(drawFirsts.begin(), drawFirsts.end());
+
+	for (unsigned int k = 0; k < numObjects; k++)
+	{
+		unsigned int i = visible != nullptr ? (*visible)[k] : k;
+		BodyInstance& body = bodies[groupCursors[objectGroups[k]]++];
+		body.position = glm::vec2(positions[i]);
+		body.scale = glm::vec2(scales[i]);
+	}
+}
+
+void BodyBuffer::Draw(World& world, GLint uniFirstBody, const std::vector<unsigned int>* visible)
+{
+	gatherer.Gather(world, visible);
+
+	if (gatherer.NumBodies() == 0)
+	{
+		return;
+	}
+
+	if (ssbo == 0)
+	{
+		glGenBuffers(1, &ssbo);
+	}
+
+	// Upload the bodies. GL_STREAM_DRAW since they're written once and used once, and binding point 0 is where the shader's Bodies block reads from.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BodyInstance) * gatherer.NumBodies(), gatherer.Bodies(), GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+
+	// One instanced draw per model. Inside the shader, body firstBody + gl_InstanceID is the one being drawn.
+	for (unsigned int g = 0; g < gatherer.NumGroups(); g++)
+	{
+		glUniform1i(uniFirstBody, (GLint)gatherer.GroupFirst(g));
+		gatherer.GroupModel(g)->Bind();
+		gatherer.GroupModel(g)->DrawInstanced(gatherer.GroupCount(g));
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+#endif // _BODY_BUFFER_CPP
@@ -0,0 +1,137 @@
+/*
+Title: Swept AABB-2D
+File Name: BodyBuffer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BODY_BUFFER_H
+#define _BODY_BUFFER_H
+
+#include "World.h"
+#include <unordered_map>
+#include <vector>
+
+// What the vertex shader needs to place one body: its 2D position and scale. 16 bytes, compared to the 64 of a full MVP matrix.
+// Matches the Body struct in VertexShader.glsl (std430 packs two vec2s back to back, so there's no padding to worry about).
+struct BodyInstance
+{
+	glm::vec2 position;
+	glm::vec2 scale;
+};
+
+// Copies the position and scale of every body out of the world's arrays, grouped by model, ready to go into BodyBuffer's SSBO.
+// This is the CPU half of vertex pulling, and it doesn't touch OpenGL, so it can be used (and timed) without a context.
+class BodyGatherer
+{
+	// Every body's data, grouped by model: the bodies using drawModels[m] start at drawFirsts[m] and there are drawCounts[m] of them.
+	std::vector<BodyInstance> bodies;
+	std::vector<Model*> drawModels;
+	std::vector<unsigned int> drawFirsts;
+	std::vector<unsigned int> drawCounts;
+
+	// Reused every frame so gathering doesn't allocate.
+	std::unordered_map<Model*, unsigned int> modelGroups;
+	std::vector<unsigned int> objectGroups;
+	std::vector<unsigned int> groupCursors;
+
+public:
+	// If visible is given, only those bodies (dense indices, like the ones from ViewCuller) are copied.
+	void Gather(World&, const std::vector<unsigned int>* visible = nullptr);
+
+	unsigned int NumBodies()
+	{
+		return (unsigned int)bodies.size();
+	}
+	const BodyInstance* Bodies()
+	{
+		return bodies.data();
+	}
+
+	// The model groups from the last Gather.
+	unsigned int NumGroups()
+	{
+		return (unsigned int)drawModels.size();
+	}
+	Model* GroupModel(unsigned int group)
+	{
+		return drawModels[group];
+	}
+	unsigned int GroupFirst(unsigned int group)
+	{
+		return drawFirsts[group];
+	}
+	unsigned int GroupCount(unsigned int group)
+	{
+		return drawCounts[group];
+	}
+};
+
+// Draws the world by "vertex pulling": instead of working out an MVP matrix for every object on the CPU and sending it over as a uniform,
+// we copy each body's position and scale straight out of the world's arrays (with a BodyGatherer) into a shader storage buffer (SSBO), and the
+// vertex shader reads its own body with gl_InstanceID and builds the transform itself. Bodies are grouped by model, so each model is one instanced draw call.
+// Only translation and scale make it to the GPU, so rotation from the scene graph is ignored on this path.
+// Needs OpenGL 4.3 (or ARB_shader_storage_buffer_object) and VertexShader.glsl compiled with VERTEX_PULLING defined.
+class BodyBuffer
+{
+	GLuint ssbo;
+	BodyGatherer gatherer;
+
+public:
+	BodyBuffer();
+	~BodyBuffer();
+
+	// Whether the current OpenGL context has shader storage buffers. Call after glewInit().
+	static bool IsSupported();
+
+	// Gathers, uploads the bodies to the SSBO (binding point 0) and draws every model instanced.
+	// uniFirstBody is the location of the firstBody uniform, which tells the shader where the current model's bodies start.
+	void Draw(World&, GLint uniFirstBody, const std::vector<unsigned int>* visible = nullptr);
+
+	unsigned int NumBodies()
+	{
+		return gatherer.NumBodies();
+	}
+	// How many draw calls the last Draw made (one per model with visible bodies).
+	unsigned int NumDraws()
+	{
+		return gatherer.NumBodies() == 0 ? 0 : gatherer.NumGroups();
+	}
+	const BodyInstance* Bodies()
+	{
+		return gatherer.Bodies();
+	}
+};
+
+#endif //_BODY_BUFFER_H
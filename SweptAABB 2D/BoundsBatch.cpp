@@ -0,0 +1,219 @@
+/*
+Title: Swept AABB-2D
+File Name: BoundsBatch.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BOUNDS_BATCH_CPP
+#define _BOUNDS_BATCH_CPP
+
+#include "BoundsBatch.h"
+#include "TransformBatch.h"
+#include <algorithm>
+#include <immintrin.h>
+#include <thread>
+#include <vector>
+
+// Below this many points, starting threads costs more than it saves.
+static const unsigned int boundsPointsPerThread = 65536;
+
+void computeBoundsScalar(const glm::mat4& transform, unsigned int count, const float* xs, const float* ys, const float* zs, glm::vec3& outMin, glm::vec3& outMax)
+{
+	// The first three rows of the matrix's first three columns, plus the translation.
+	glm::vec3 column0 = glm::vec3(transform[0]);
+	glm::vec3 column1 = glm::vec3(transform[1]);
+	glm::vec3 column2 = glm::vec3(transform[2]);
+	glm::vec3 translation = glm::vec3(transform[3]);
+
+	glm::vec3 boxMin = column0 * xs[0] + column1 * ys[0] + column2 * zs[0] + translation;
+	glm::vec3 boxMax = boxMin;
+
+	for (unsigned int i = 1; i < count; i++)
+	{
+		glm::vec3 point = column0 * xs[i] + column1 * ys[i] + column2 * zs[i] + translation;
+		boxMin = glm::min(boxMin, point);
+		boxMax = glm::max(boxMax, point);
+	}
+
+	outMin = boxMin;
+	outMax = boxMax;
+}
+
+// The smallest (or largest) of the 8 floats in a register.
+TARGET_AVX2 static float horizontalMin(__m256 v)
+{
+	__m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+	return _mm_cvtss_f32(m);
+}
+TARGET_AVX2 static float horizontalMax(__m256 v)
+{
+	__m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+	return _mm_cvtss_f32(m);
+}
+
+TARGET_AVX2 static void computeBoundsAVX2(const glm::mat4& transform, unsigned int count, const float* xs, const float* ys, const float* zs, glm::vec3& outMin, glm::vec3& outMax)
+{
+	if (count < 8)
+	{
+		computeBoundsScalar(transform, count, xs, ys, zs, outMin, outMax);
+		return;
+	}
+
+	// Each matrix element broadcast into all 8 lanes. m[c][r] is column c, row r.
+	__m256 m00 = _mm256_set1_ps(transform[0][0]), m10 = _mm256_set1_ps(transform[1][0]), m20 = _mm256_set1_ps(transform[2][0]), m30 = _mm256_set1_ps(transform[3][0]);
+	__m256 m01 = _mm256_set1_ps(transform[0][1]), m11 = _mm256_set1_ps(transform[1][1]), m21 = _mm256_set1_ps(transform[2][1]), m31 = _mm256_set1_ps(transform[3][1]);
+	__m256 m02 = _mm256_set1_ps(transform[0][2]), m12 = _mm256_set1_ps(transform[1][2]), m22 = _mm256_set1_ps(transform[2][2]), m32 = _mm256_set1_ps(transform[3][2]);
+
+	// Start from the first 8 points, so the running boxes never hold anything that isn't a real point.
+	__m256 minX, minY, minZ, maxX, maxY, maxZ;
+
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(xs + i);
+		__m256 y = _mm256_loadu_ps(ys + i);
+		__m256 z = _mm256_loadu_ps(zs + i);
+
+		__m256 tx = _mm256_fmadd_ps(m20, z, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m00, x, m30)));
+		__m256 ty = _mm256_fmadd_ps(m21, z, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m01, x, m31)));
+		__m256 tz = _mm256_fmadd_ps(m22, z, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m02, x, m32)));
+
+		if (i == 0)
+		{
+			minX = maxX = tx;
+			minY = maxY = ty;
+			minZ = maxZ = tz;
+			continue;
+		}
+
+		minX = _mm256_min_ps(minX, tx);
+		minY = _mm256_min_ps(minY, ty);
+		minZ = _mm256_min_ps(minZ, tz);
+		maxX = _mm256_max_ps(maxX, tx);
+		maxY = _mm256_max_ps(maxY, ty);
+		maxZ = _mm256_max_ps(maxZ, tz);
+	}
+
+	glm::vec3 boxMin = glm::vec3(horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ));
+	glm::vec3 boxMax = glm::vec3(horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ));
+
+	// The last few points that didn't fill a register.
+	if (i < count)
+	{
+		glm::vec3 tailMin, tailMax;
+		computeBoundsScalar(transform, count - i, xs + i, ys + i, zs + i, tailMin, tailMax);
+		boxMin = glm::min(boxMin, tailMin);
+		boxMax = glm::max(boxMax, tailMax);
+	}
+
+	outMin = boxMin;
+	outMax = boxMax;
+}
+
+// One thread's share: the box around points [begin, end).
+static void computeBoundsRange(const glm::mat4& transform, unsigned int begin, unsigned int end, const float* xs, const float* ys, const float* zs, glm::vec3* outMin, glm::vec3* outMax)
+{
+	if (transformBatchUsesAVX2())
+	{
+		computeBoundsAVX2(transform, end - begin, xs + begin, ys + begin, zs + begin, *outMin, *outMax);
+	}
+	else
+	{
+		computeBoundsScalar(transform, end - begin, xs + begin, ys + begin, zs + begin, *outMin, *outMax);
+	}
+}
+
+void computeBounds(const glm::mat4& transform, unsigned int count, const float* xs, const float* ys, const float* zs, glm::vec3& outMin, glm::vec3& outMax, int numThreads)
+{
+	// Starting threads isn't free, so small point sets are done on this one.
+	if (numThreads <= 0)
+	{
+		numThreads = count < 2 * boundsPointsPerThread ? 1 : (int)std::max(1u, std::min(std::thread::hardware_concurrency(), count / boundsPointsPerThread));
+	}
+	numThreads = std::max(1, std::min(numThreads, (int)count));
+
+	if (numThreads == 1)
+	{
+		computeBoundsRange(transform, 0, count, xs, ys, zs, &outMin, &outMax);
+		return;
+	}
+
+	// Each thread gets its own slice of the points (a multiple of 8, so only the last one has a tail) and its own box to write.
+	std::vector<glm::vec3> mins(numThreads);
+	std::vector<glm::vec3> maxes(numThreads);
+	std::vector<std::thread> threads;
+
+	unsigned int perThread = ((count + numThreads - 1) / numThreads + 7) & ~7u;
+	unsigned int used = 0;
+	for (int t = 0; t < numThreads; t++)
+	{
+		unsigned int begin = t * perThread;
+		unsigned int end = std::min(count, begin + perThread);
+		if (begin >= end)
+		{
+			break;
+		}
+
+		// This thread takes the last slice itself instead of waiting around.
+		if (end == count)
+		{
+			computeBoundsRange(transform, begin, end, xs, ys, zs, &mins[t], &maxes[t]);
+		}
+		else
+		{
+			threads.push_back(std::thread(computeBoundsRange, std::cref(transform), begin, end, xs, ys, zs, &mins[t], &maxes[t]));
+		}
+		used++;
+	}
+
+	for (unsigned int t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+
+	outMin = mins[0];
+	outMax = maxes[0];
+	for (unsigned int t = 1; t < used; t++)
+	{
+		outMin = glm::min(outMin, mins[t]);
+		outMax = glm::max(outMax, maxes[t]);
+	}
+}
+
+#endif // _BOUNDS_BATCH_CPP
@@ -0,0 +1,59 @@
+/*
+Title: Swept AABB-2D
+File Name: BoundsBatch.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BOUNDS_BATCH_H
+#define _BOUNDS_BATCH_H
+
+#include "GLIncludes.h"
+
+// Finds the AABB of a set of points after a transform, like GameObject::CalculateAABB does for a model's vertices.
+// The points come as separate x, y and z arrays (structure of arrays), so that 8 of each can be loaded into a register at once:
+//     x' = m[0].x * x + m[1].x * y + m[2].x * z + m[3].x    (and the same for y' and z')
+// is then three fused multiply-adds for 8 points, followed by a min and a max, with no branches at all.
+// The transform is assumed to be affine (translation, rotation, scale, but no projection), as every object transform is, so w is always 1
+// and isn't worked out.
+// If the CPU has AVX2 (see transformBatchUsesAVX2), 8 points are done at a time. Point sets big enough to be worth it are split between threads,
+// each reducing its own part, and the parts' boxes are combined at the end.
+
+// The box around transform * (xs[i], ys[i], zs[i]) for count points (count must be at least 1). numThreads = 0 picks based on the count.
+void computeBounds(const glm::mat4& transform, unsigned int count, const float* xs, const float* ys, const float* zs, glm::vec3& outMin, glm::vec3& outMax, int numThreads = 0);
+
+// The plain C++ version on one thread, always available.
+void computeBoundsScalar(const glm::mat4& transform, unsigned int count, const float* xs, const float* ys, const float* zs, glm::vec3& outMin, glm::vec3& outMax);
+
+#endif //_BOUNDS_BATCH_H
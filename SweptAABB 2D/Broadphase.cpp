@@ -0,0 +1,283 @@
+/*
+Title: Swept AABB-2D
+File Name: Broadphase.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BROADPHASE_CPP
+#define _BROADPHASE_CPP
+
+#include "Broadphase.h"
+#include <algorithm>
+#include <cmath>
+
+Broadphase::Broadphase(float inCellSize)
+{
+	cellSize = inCellSize;
+	inverseCellSize = 1.0f / inCellSize;
+	currentStamp = 0;
+	count = 0;
+}
+
+Broadphase::CellRange Broadphase::RangeOf(const AABB& box)
+{
+	CellRange range;
+	range.minX = (int)floorf(box.min.x * inverseCellSize);
+	range.minY = (int)floorf(box.min.y * inverseCellSize);
+	range.maxX = (int)floorf(box.max.x * inverseCellSize);
+	range.maxY = (int)floorf(box.max.y * inverseCellSize);
+	return range;
+}
+
+void Broadphase::Grow(unsigned int id)
+{
+	if (id >= present.size())
+	{
+		ranges.resize(id + 1);
+		present.resize(id + 1, 0);
+		queryStamps.resize(id + 1, 0);
+	}
+}
+
+void Broadphase::AddToCells(unsigned int id, const CellRange& range)
+{
+	for (int x = range.minX; x <= range.maxX; x++)
+	{
+		for (int y = range.minY; y <= range.maxY; y++)
+		{
+			cells[CellKey(x, y)].push_back(id);
+		}
+	}
+}
+
+void Broadphase::RemoveFromCells(unsigned int id, const CellRange& range)
+{
+	for (int x = range.minX; x <= range.maxX; x++)
+	{
+		for (int y = range.minY; y <= range.maxY; y++)
+		{
+			std::unordered_map<unsigned long long, std::vector<unsigned int> >::iterator cell = cells.find(CellKey(x, y));
+
+			if (cell == cells.end())
+			{
+				continue;
+			}
+
+			// Order inside a cell doesn't matter, so swap the id with the last one and pop it off.
+			std::vector<unsigned int>& ids = cell->second;
+			for (unsigned int i = 0; i < ids.size(); i++)
+			{
+				if (ids[i] == id)
+				{
+					ids[i] = ids.back();
+					ids.pop_back();
+					break;
+				}
+			}
+
+			if (ids.empty())
+			{
+				cells.erase(cell);
+			}
+		}
+	}
+}
+
+void Broadphase::Insert(unsigned int id, const AABB& box)
+{
+	Grow(id);
+
+	if (present[id])
+	{
+		Update(id, box);
+		return;
+	}
+
+	ranges[id] = RangeOf(box);
+	present[id] = 1;
+	AddToCells(id, ranges[id]);
+	count++;
+}
+
+void Broadphase::Remove(unsigned int id)
+{
+	if (!Contains(id))
+	{
+		return;
+	}
+
+	RemoveFromCells(id, ranges[id]);
+	present[id] = 0;
+	count--;
+}
+
+void Broadphase::Update(unsigned int id, const AABB& box)
+{
+	if (!Contains(id))
+	{
+		Insert(id, box);
+		return;
+	}
+
+	// Most of the time an object moves a tiny bit and stays in the same cells, so there's nothing to do.
+	CellRange range = RangeOf(box);
+	if (range == ranges[id])
+	{
+		return;
+	}
+
+	RemoveFromCells(id, ranges[id]);
+	ranges[id] = range;
+	AddToCells(id, range);
+}
+
+void Broadphase::Build(const unsigned int* ids, const AABB* boxes, unsigned int num)
+{
+	Clear();
+
+	// First work out every (cell, id) pair, then sort them by cell. That way each cell's list can be allocated at its final size in one go.
+	std::vector<std::pair<unsigned long long, unsigned int> > entries;
+	entries.reserve(num);
+
+	for (unsigned int i = 0; i < num; i++)
+	{
+		unsigned int id = ids[i];
+		Grow(id);
+
+		CellRange range = RangeOf(boxes[i]);
+		ranges[id] = range;
+		present[id] = 1;
+
+		for (int x = range.minX; x <= range.maxX; x++)
+		{
+			for (int y = range.minY; y <= range.maxY; y++)
+			{
+				entries.push_back(std::make_pair(CellKey(x, y), id));
+			}
+		}
+	}
+
+	count = num;
+
+	std::sort(entries.begin(), entries.end());
+
+	cells.reserve(entries.size());
+
+	unsigned int start = 0;
+	while (start < entries.size())
+	{
+		unsigned int end = start + 1;
+		while (end < entries.size() && entries[end].first == entries[start].first)
+		{
+			end++;
+		}
+
+		std::vector<unsigned int>& cell = cells[entries[start].first];
+		cell.reserve(end - start);
+		for (unsigned int i = start; i < end; i++)
+		{
+			cell.push_back(entries[i].second);
+		}
+
+		start = end;
+	}
+}
+
+void Broadphase::Clear()
+{
+	cells.clear();
+	std::fill(present.begin(), present.end(), (unsigned char)0);
+	count = 0;
+}
+
+void Broadphase::Query(const AABB& box, std::vector<unsigned int>& out)
+{
+	// Stamp every id as we find it, so one that spans several cells only gets added once.
+	currentStamp++;
+	if (currentStamp == 0)
+	{
+		// The stamp wrapped around, so old stamps could match again. Reset them all.
+		std::fill(queryStamps.begin(), queryStamps.end(), 0u);
+		currentStamp = 1;
+	}
+
+	CellRange range = RangeOf(box);
+
+	// A huge box (or a very fast object) can cover far more cells than actually have anything in them.
+	// In that case it's cheaper to go through the occupied cells and check whether each one is inside the range.
+	double numCells = ((double)range.maxX - range.minX + 1.0) * ((double)range.maxY - range.minY + 1.0);
+	if (numCells > (double)cells.size())
+	{
+		for (std::unordered_map<unsigned long long, std::vector<unsigned int> >::iterator cell = cells.begin(); cell != cells.end(); ++cell)
+		{
+			int x = (int)(unsigned int)(cell->first >> 32);
+			int y = (int)(unsigned int)(cell->first & 0xFFFFFFFF);
+
+			if (x >= range.minX && x <= range.maxX && y >= range.minY && y <= range.maxY)
+			{
+				AddCell(cell->second, out);
+			}
+		}
+
+		return;
+	}
+
+	for (int x = range.minX; x <= range.maxX; x++)
+	{
+		for (int y = range.minY; y <= range.maxY; y++)
+		{
+			std::unordered_map<unsigned long long, std::vector<unsigned int> >::iterator cell = cells.find(CellKey(x, y));
+
+			if (cell != cells.end())
+			{
+				AddCell(cell->second, out);
+			}
+		}
+	}
+}
+
+void Broadphase::AddCell(const std::vector<unsigned int>& ids, std::vector<unsigned int>& out)
+{
+	for (unsigned int i = 0; i < ids.size(); i++)
+	{
+		if (queryStamps[ids[i]] != currentStamp)
+		{
+			queryStamps[ids[i]] = currentStamp;
+			out.push_back(ids[i]);
+		}
+	}
+}
+
+#endif // _BROADPHASE_CPP
@@ -0,0 +1,120 @@
+/*
+Title: Swept AABB-2D
+File Name: Broadphase.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _BROADPHASE_H
+#define _BROADPHASE_H
+
+#include "GameObject.h"
+#include <unordered_map>
+#include <vector>
+
+// A uniform grid over the XY plane, used to quickly find which objects might be touching a given box.
+// Every object is listed in each cell its AABB overlaps. A query only has to look at the cells under the query box,
+// instead of testing against every object in the world. (It's called the "broadphase" because it only narrows down the candidates,
+// the actual collision test like SweptAABB still has to run on whatever it returns.)
+// Objects are identified by an id the caller picks. The world uses the slot index of the object's handle, since that never changes while the object is alive.
+class Broadphase
+{
+	struct CellRange
+	{
+		int minX, minY;
+		int maxX, maxY;
+
+		bool operator==(const CellRange& other) const
+		{
+			return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+		}
+	};
+
+	float cellSize;
+	float inverseCellSize;
+
+	// The ids in each occupied cell, keyed by the cell's packed x/y coordinates.
+	std::unordered_map<unsigned long long, std::vector<unsigned int> > cells;
+
+	// The cells each id is currently in, and whether it's in the grid at all. Indexed by id.
+	std::vector<CellRange> ranges;
+	std::vector<unsigned char> present;
+
+	// Used by Query to return each id only once, even if it shares several cells with the query box.
+	std::vector<unsigned int> queryStamps;
+	unsigned int currentStamp;
+
+	unsigned int count;
+
+	CellRange RangeOf(const AABB&);
+	static unsigned long long CellKey(int x, int y)
+	{
+		return ((unsigned long long)(unsigned int)x << 32) | (unsigned long long)(unsigned int)y;
+	}
+	void AddToCells(unsigned int id, const CellRange&);
+	void RemoveFromCells(unsigned int id, const CellRange&);
+	void Grow(unsigned int id);
+	void AddCell(const std::vector<unsigned int>& ids, std::vector<unsigned int>& out);
+
+public:
+	// The cell size should be around the size of a typical object. Much smaller and big objects are listed in lots of cells,
+	// much larger and each cell holds so many objects that queries don't narrow much down.
+	Broadphase(float inCellSize = 0.25f);
+
+	void Insert(unsigned int id, const AABB&);
+	void Remove(unsigned int id);
+
+	// Call this after an object moves. It only touches the grid if the object crossed into different cells.
+	void Update(unsigned int id, const AABB&);
+
+	// Throws away everything and adds all of the given objects at once. When a lot of objects change at the same time, this is much
+	// faster than inserting them one by one, since every cell is sized once instead of growing an object at a time.
+	void Build(const unsigned int* ids, const AABB* boxes, unsigned int num);
+
+	void Clear();
+
+	// Adds the id of every object whose cells overlap the box to out. These are only candidates, their AABBs may not actually touch the box.
+	void Query(const AABB&, std::vector<unsigned int>& out);
+
+	bool Contains(unsigned int id)
+	{
+		return id < present.size() && present[id] != 0;
+	}
+	unsigned int Count()
+	{
+		return count;
+	}
+};
+
+#endif //_BROADPHASE_H
@@ -0,0 +1,200 @@
+/*
+Title: Swept AABB-2D
+File Name: Collision.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _COLLISION_CPP
+#define _COLLISION_CPP
+
+#include "Collision.h"
+
+// Regular AABB collision detection. (Not used in this demo, but should work just fine.)
+bool TestAABB(AABB a, AABB b)
+{
+	// If any axis is separated, exit with no intersection.
+	if (a.max.x < b.min.x || a.min.x > b.max.x) return false;
+	if (a.max.y < b.min.y || a.min.y > b.max.y) return false;
+	
+	// Z-axis is irrelevant because we are in 2D
+	//if (a.max.z < b.min.z || a.min.z > b.max.z) return false;
+	
+	return true;
+}
+
+// Swept AABB collision detection, giving you the time of collision and thus allowing you to even calculate the point of collision and collision responses (such as bounce).
+float SweptAABB(AABB* box1, AABB* box2, glm::vec3 vel1, float& normalx, float& normaly)
+{
+	// These variables stand for the distance in each axis between the moving object and the stationary object in terms of when the moving object would "enter" the colliding object.
+	float xDistanceEntry, yDistanceEntry;
+
+	// These variables stand for the distance in each axis in terms of when the moving object would "exit" the colliding object.
+	float xDistanceExit, yDistanceExit;
+
+	// Find the distance between the objects on the near and far sides for both x and y
+	// Depending on the direction of the velocity, we'll reverse the calculation order to maintain the right sign (positive/negative).
+	if (vel1.x > 0.0f)
+	{
+		xDistanceEntry = (*box2).min.x - (*box1).max.x;
+		xDistanceExit = (*box2).max.x - (*box1).min.x;
+	}
+	else
+	{
+		xDistanceEntry = (*box2).max.x - (*box1).min.x;
+		xDistanceExit = (*box2).min.x - (*box1).max.x;
+	}
+
+	if (vel1.y > 0.0f)
+	{
+		yDistanceEntry = (*box2).min.y - (*box1).max.y;
+		yDistanceExit = (*box2).max.y - (*box1).min.y;
+	}
+	else
+	{
+		yDistanceEntry = (*box2).max.y - (*box1).min.y;
+		yDistanceExit = (*box2).min.y - (*box1).max.y;
+	}
+
+	// These variables stand for the time at which the moving object would enter/exit the stationary object.
+	float xEntryTime, yEntryTime;
+	float xExitTime, yExitTime;
+
+	// Find time of collision and time of leaving for each axis (if statement is to prevent divide by zero)
+	if (vel1.x == 0.0f)
+	{
+		// If the largest distance (entry or exit) between the two objects is greater than the size of both objects combined, then the objects are clearly not colliding.
+		if (std::max(fabsf(xDistanceEntry), fabsf(xDistanceExit)) > (((*box1).max.x - (*box1).min.x) + ((*box2).max.x - (*box2).min.x)))
+		{
+			// Setting this to 2.0f will cause an absence of collision later in this function.
+			xEntryTime = 2.0f;
+		}
+		else
+		{
+			// Otherwise, pass negative infinity to basically ignore this variable.
+			xEntryTime = -std::numeric_limits<float>::infinity();
+		}
+		
+		// Setting this to postivie infinity will ignore this variable.
+		xExitTime = std::numeric_limits<float>::infinity();
+	}
+	else
+	{
+		// If there is a velocity in the x-axis, then we can determine the time of collision based on the distance divided by the velocity. (Assuming velocity does not change.)
+		xEntryTime = xDistanceEntry / vel1.x;
+		xExitTime = xDistanceExit / vel1.x;
+	}
+
+	if (vel1.y == 0.0f)
+	{
+		if (std::max(fabsf(yDistanceEntry), fabsf(yDistanceExit)) > (((*box1).max.y - (*box1).min.y) + ((*box2).max.y - (*box2).min.y)))
+		{
+			yEntryTime = 2.0f;
+		}
+		else
+		{
+			yEntryTime = -std::numeric_limits<float>::infinity();
+		}
+
+		yExitTime = std::numeric_limits<float>::infinity();
+	}
+	else
+	{
+		yEntryTime = yDistanceEntry / vel1.y;
+		yExitTime = yDistanceExit / vel1.y;
+	}
+
+
+	// Get the maximum entry time to determine the latest collision, which is actually when the objects are colliding. (Because all 3 axes must collide.)
+	float entryTime = std::max(xEntryTime, yEntryTime);
+
+	// Get the minimum exit time to determine when the objects are no longer colliding. (AKA the objects passed through one another.)
+	float exitTime = std::min(xExitTime, yExitTime);
+
+	// If anything in the following statement is true, there's no collision.
+	// If entryTime > exitTime, that means that one of the axes is exiting the "collision" before the other axes are crossing, thus they don't cross the object in unison and there's no collison.
+	// If all three of the entry times are less than zero, then the collision already happened (or we missed it, but either way..)
+	// If any of the entry times are greater than 1.0f, then the collision isn't happening this update/physics step so we'll move on.
+	if (entryTime > exitTime || xEntryTime < 0.0f && yEntryTime < 0.0f  || xEntryTime > 1.0f || yEntryTime > 1.0f)
+	{
+		// With no collision, we pass out zero'd normals.
+		normalx = 0.0f;
+		normaly = 0.0f;
+
+		// If collision detection isn't working, try uncommenting the if statement and putting a break point on the std::cout statement.
+		// Then you can check variable values within this algorithm to make sure everything is in order.
+		/*if (glm::distance(obj1->GetPosition(), obj2->GetPosition()) < 0.1)
+		{
+			std::cout << "Something went wrong, and the objects are inside of each other but haven't been detected as a collision.";
+		}*/
+
+		// 2.0f signifies that there was no collision.
+		return 2.0f;
+	}
+	else // If there was a collision
+	{
+		// Calculate normal of collided surface
+		if (xEntryTime > yEntryTime) // If the x-axis is the last to cross, then that is the colliding axis.
+		{
+			if (xDistanceEntry < 0.0f) // Determine the normal based on positive or negative.
+			{
+				normalx = 1.0f;
+				normaly = 0.0f;
+			}
+			else
+			{
+				normalx = -1.0f;
+				normaly = 0.0f;
+			}
+		}
+		else if (yEntryTime > xEntryTime)
+		{
+			if (yDistanceEntry < 0.0f)
+			{
+				normalx = 0.0f;
+				normaly = 1.0f;
+			}
+			else
+			{
+				normalx = 0.0f;
+				normaly = -1.0f;
+			}
+		}
+
+		// Return the time of collision
+		return entryTime;
+	}
+}
+
+#endif // _COLLISION_CPP
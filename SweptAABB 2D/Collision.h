@@ -0,0 +1,143 @@
+/*
+Title: Swept AABB-2D
+File Name: Collision.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _COLLISION_H
+#define _COLLISION_H
+
+#include "GameObject.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Regular AABB collision detection.
+bool TestAABB(AABB a, AABB b);
+
+// Swept AABB collision detection, giving you the time of collision and thus allowing you to even calculate the point of collision and collision responses (such as bounce).
+// box1 is the moving object, box2 is stationary, and vel1 is how far box1 moves this step. Returns 2.0f if there's no collision this step.
+float SweptAABB(AABB* box1, AABB* box2, glm::vec3 vel1, float& normalx, float& normaly);
+
+// The same algorithm as SweptAABB, written over the scalar type used for the math (float or double).
+// The physics world templates use this so that the precision of the collision math can be picked at compile time.
+// See SweptAABB in Collision.cpp for a full explanation of each step.
+template <typename Scalar>
+inline Scalar SweptAABBGeneric(const AABB& box1, const AABB& box2, const glm::vec3& vel1, Scalar& normalx, Scalar& normaly)
+{
+	const Scalar velX = (Scalar)vel1.x;
+	const Scalar velY = (Scalar)vel1.y;
+
+	Scalar xDistanceEntry, yDistanceEntry;
+	Scalar xDistanceExit, yDistanceExit;
+
+	if (velX > 0)
+	{
+		xDistanceEntry = (Scalar)box2.min.x - (Scalar)box1.max.x;
+		xDistanceExit = (Scalar)box2.max.x - (Scalar)box1.min.x;
+	}
+	else
+	{
+		xDistanceEntry = (Scalar)box2.max.x - (Scalar)box1.min.x;
+		xDistanceExit = (Scalar)box2.min.x - (Scalar)box1.max.x;
+	}
+
+	if (velY > 0)
+	{
+		yDistanceEntry = (Scalar)box2.min.y - (Scalar)box1.max.y;
+		yDistanceExit = (Scalar)box2.max.y - (Scalar)box1.min.y;
+	}
+	else
+	{
+		yDistanceEntry = (Scalar)box2.max.y - (Scalar)box1.min.y;
+		yDistanceExit = (Scalar)box2.min.y - (Scalar)box1.max.y;
+	}
+
+	Scalar xEntryTime, yEntryTime;
+	Scalar xExitTime, yExitTime;
+
+	if (velX == 0)
+	{
+		Scalar sizes = ((Scalar)box1.max.x - (Scalar)box1.min.x) + ((Scalar)box2.max.x - (Scalar)box2.min.x);
+		xEntryTime = std::max(std::abs(xDistanceEntry), std::abs(xDistanceExit)) > sizes ? (Scalar)2 : -std::numeric_limits<Scalar>::infinity();
+		xExitTime = std::numeric_limits<Scalar>::infinity();
+	}
+	else
+	{
+		xEntryTime = xDistanceEntry / velX;
+		xExitTime = xDistanceExit / velX;
+	}
+
+	if (velY == 0)
+	{
+		Scalar sizes = ((Scalar)box1.max.y - (Scalar)box1.min.y) + ((Scalar)box2.max.y - (Scalar)box2.min.y);
+		yEntryTime = std::max(std::abs(yDistanceEntry), std::abs(yDistanceExit)) > sizes ? (Scalar)2 : -std::numeric_limits<Scalar>::infinity();
+		yExitTime = std::numeric_limits<Scalar>::infinity();
+	}
+	else
+	{
+		yEntryTime = yDistanceEntry / velY;
+		yExitTime = yDistanceExit / velY;
+	}
+
+	Scalar entryTime = std::max(xEntryTime, yEntryTime);
+	Scalar exitTime = std::min(xExitTime, yExitTime);
+
+	if (entryTime > exitTime || (xEntryTime < 0 && yEntryTime < 0) || xEntryTime > 1 || yEntryTime > 1)
+	{
+		normalx = 0;
+		normaly = 0;
+		return (Scalar)2;
+	}
+
+	// SweptAABB leaves the normals alone when both axes cross at exactly the same time (a perfect corner hit). Here they are zeroed instead, so they always have a value.
+	// That makes a hit (a time of 1 or less) with both normals zero a corner hit, which has to be answered on both axes: the response
+	// policies in PhysicsWorld.h do that, like update() in Main.cpp. Treating zero normals as "no axis" would carry the object straight through.
+	normalx = 0;
+	normaly = 0;
+
+	if (xEntryTime > yEntryTime)
+	{
+		normalx = xDistanceEntry < 0 ? (Scalar)1 : (Scalar)-1;
+	}
+	else if (yEntryTime > xEntryTime)
+	{
+		normaly = yDistanceEntry < 0 ? (Scalar)1 : (Scalar)-1;
+	}
+
+	return entryTime;
+}
+
+#endif //_COLLISION_H
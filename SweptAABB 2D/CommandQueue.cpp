@@ -0,0 +1,162 @@
+/*
+Title: Swept AABB-2D
+File Name: CommandQueue.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _COMMAND_QUEUE_CPP
+#define _COMMAND_QUEUE_CPP
+
+#include "CommandQueue.h"
+
+bool CommandProducer::Spawn(Model* model, glm::vec3 pos, glm::vec3 vel, glm::vec3 scale, unsigned int step)
+{
+	WorldCommand command;
+	command.type = COMMAND_SPAWN;
+	command.step = step;
+	command.model = model;
+	command.position = pos;
+	command.velocity = vel;
+	command.scale = scale;
+
+	return Push(command);
+}
+
+bool CommandProducer::Destroy(ObjectHandle target, unsigned int step)
+{
+	WorldCommand command;
+	command.type = COMMAND_DESTROY;
+	command.step = step;
+	command.target = target;
+
+	return Push(command);
+}
+
+bool CommandProducer::SetVelocity(ObjectHandle target, glm::vec3 vel, unsigned int step)
+{
+	WorldCommand command;
+	command.type = COMMAND_SET_VELOCITY;
+	command.step = step;
+	command.target = target;
+	command.velocity = vel;
+
+	return Push(command);
+}
+
+bool CommandProducer::AddVelocity(ObjectHandle target, glm::vec3 vel, unsigned int step)
+{
+	WorldCommand command;
+	command.type = COMMAND_ADD_VELOCITY;
+	command.step = step;
+	command.target = target;
+	command.velocity = vel;
+
+	return Push(command);
+}
+
+bool CommandProducer::Teleport(ObjectHandle target, glm::vec3 pos, unsigned int step)
+{
+	WorldCommand command;
+	command.type = COMMAND_TELEPORT;
+	command.step = step;
+	command.target = target;
+	command.position = pos;
+
+	return Push(command);
+}
+
+CommandBuffer::CommandBuffer()
+{
+	for (int i = 0; i < MaxProducers; i++)
+	{
+		queues[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	numProducers.store(0, std::memory_order_relaxed);
+}
+
+CommandBuffer::~CommandBuffer()
+{
+	for (int i = 0; i < MaxProducers; i++)
+	{
+		delete queues[i].load(std::memory_order_relaxed);
+	}
+}
+
+CommandProducer CommandBuffer::CreateProducer()
+{
+	// Claim a slot. The compare-exchange keeps this safe even if two threads create producers at the same time.
+	int slot = numProducers.load(std::memory_order_relaxed);
+	do
+	{
+		if (slot >= MaxProducers)
+		{
+			return CommandProducer();
+		}
+	} while (!numProducers.compare_exchange_weak(slot, slot + 1, std::memory_order_acq_rel));
+
+	// The physics thread skips slots whose queue hasn't been stored yet, so it's fine that the count is visible before the queue is.
+	CommandQueue* queue = new CommandQueue();
+	queues[slot].store(queue, std::memory_order_release);
+
+	return CommandProducer(queue);
+}
+
+WorldCommand* CommandBuffer::Next(int i, unsigned int currentStep)
+{
+	CommandQueue* queue = queues[i].load(std::memory_order_acquire);
+
+	if (queue == nullptr)
+	{
+		return nullptr;
+	}
+
+	WorldCommand* command = queue->Peek();
+
+	// Commands meant for a later step stay at the front of the queue. Since each queue is in order, everything behind it waits too.
+	if (command == nullptr || command->step > currentStep)
+	{
+		return nullptr;
+	}
+
+	return command;
+}
+
+void CommandBuffer::Pop(int i)
+{
+	queues[i].load(std::memory_order_relaxed)->Pop();
+}
+
+#endif // _COMMAND_QUEUE_CPP
@@ -0,0 +1,210 @@
+/*
+Title: Swept AABB-2D
+File Name: CommandQueue.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _COMMAND_QUEUE_H
+#define _COMMAND_QUEUE_H
+
+#include "GLIncludes.h"
+#include "ObjectPool.h"
+#include <atomic>
+
+class Model;
+
+// A single-producer, single-consumer ring buffer.
+// Exactly one thread may call Push, and exactly one (other) thread may call Peek/Pop. With that rule in place there is no need for a lock,
+// because the producer only ever writes the tail and the consumer only ever writes the head.
+// Capacity must be a power of two so that we can wrap the indices with a mask instead of a modulo.
+template <typename T, unsigned int Capacity>
+class SPSCQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two.");
+
+	// The head and tail are kept on separate cache lines, otherwise the producer and consumer threads would keep stealing the line from each other.
+	std::atomic<unsigned int> head;	// Next slot to read, only written by the consumer.
+	char headPadding[64 - sizeof(std::atomic<unsigned int>)];
+	std::atomic<unsigned int> tail;	// Next slot to write, only written by the producer.
+	char tailPadding[64 - sizeof(std::atomic<unsigned int>)];
+
+	T items[Capacity];
+
+public:
+	static const unsigned int Size = Capacity;
+
+	SPSCQueue() : head(0), tail(0)
+	{
+	}
+
+	// Producer side. Returns false if the queue is full, in which case nothing was written and the caller may try again later.
+	bool Push(const T& item)
+	{
+		unsigned int t = tail.load(std::memory_order_relaxed);
+
+		// The indices are free-running, so the number of queued items is simply their difference (this stays correct when they wrap around).
+		if (t - head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		items[t & (Capacity - 1)] = item;
+
+		// The release store makes sure the item is fully written before the consumer can see the new tail.
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns the oldest item without removing it, or nullptr if the queue is empty.
+	T* Peek()
+	{
+		unsigned int h = head.load(std::memory_order_relaxed);
+
+		if (h == tail.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		return &items[h & (Capacity - 1)];
+	}
+
+	// Consumer side. Removes the item returned by the last Peek. Only call this after Peek returned something.
+	void Pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+};
+
+// The kinds of changes other threads are allowed to request from the physics world.
+enum CommandType
+{
+	COMMAND_SPAWN,
+	COMMAND_DESTROY,
+	COMMAND_SET_VELOCITY,
+	COMMAND_ADD_VELOCITY,
+	COMMAND_TELEPORT
+};
+
+// A queued change to the world. Not every field is used by every command type:
+// Spawn uses model, position, velocity and scale; Destroy only uses target; SetVelocity/AddVelocity use target and velocity; Teleport uses target and position.
+struct WorldCommand
+{
+	CommandType type;
+
+	// The physics step this command should be applied on. It is held back until the world reaches that step, which lets a producer
+	// line its commands up with a known step so that replays come out identical. Zero means "as soon as possible".
+	unsigned int step;
+
+	ObjectHandle target;
+	Model* model;
+
+	glm::vec3 position;
+	glm::vec3 velocity;
+	glm::vec3 scale;
+
+	WorldCommand()
+	{
+		type = COMMAND_SET_VELOCITY;
+		step = 0;
+		target = ObjectHandle();
+		model = nullptr;
+		position = glm::vec3(0.0f);
+		velocity = glm::vec3(0.0f);
+		scale = glm::vec3(1.0f);
+	}
+};
+
+// Each producer thread gets its own queue, so every queue has exactly one writer and the physics thread is always the only reader.
+typedef SPSCQueue<WorldCommand, 1024> CommandQueue;
+
+// The thread-side handle used to push commands. Get one from CommandBuffer::CreateProducer() and only use it from one thread.
+// Every call returns false if that producer's queue is full (the physics thread is falling behind), so the caller decides whether to retry or drop it.
+class CommandProducer
+{
+	CommandQueue* queue;
+
+public:
+	CommandProducer(CommandQueue* inQueue = nullptr)
+	{
+		queue = inQueue;
+	}
+
+	bool IsValid()
+	{
+		return queue != nullptr;
+	}
+
+	bool Push(const WorldCommand& command)
+	{
+		return queue != nullptr && queue->Push(command);
+	}
+
+	bool Spawn(Model* model, glm::vec3 pos, glm::vec3 vel, glm::vec3 scale, unsigned int step = 0);
+	bool Destroy(ObjectHandle target, unsigned int step = 0);
+	bool SetVelocity(ObjectHandle target, glm::vec3 vel, unsigned int step = 0);
+	bool AddVelocity(ObjectHandle target, glm::vec3 vel, unsigned int step = 0);
+	bool Teleport(ObjectHandle target, glm::vec3 pos, unsigned int step = 0);
+};
+
+// Holds one queue per producer thread. Commands are only ever applied by the physics thread, at the start of a step,
+// so nothing inside the step needs to worry about another thread changing an object out from under it.
+class CommandBuffer
+{
+public:
+	static const int MaxProducers = 16;
+
+private:
+	// The queues are published with an atomic store so the physics thread can start draining a producer the moment it is created.
+	std::atomic<CommandQueue*> queues[MaxProducers];
+	std::atomic<int> numProducers;
+
+public:
+	CommandBuffer();
+	~CommandBuffer();
+
+	// Creates a new producer queue. Returns an invalid producer if all MaxProducers queues are taken.
+	CommandProducer CreateProducer();
+
+	// Called by the physics thread. Gives the oldest command in producer queue i whose step has come up (or nullptr) and removes it with Pop.
+	// Queues are always walked in the order they were created and each queue is first-in first-out, so commands are applied in the same order every run.
+	int NumProducers()
+	{
+		return numProducers.load(std::memory_order_acquire);
+	}
+	WorldCommand* Next(int i, unsigned int currentStep);
+	void Pop(int i);
+};
+
+#endif //_COMMAND_QUEUE_H
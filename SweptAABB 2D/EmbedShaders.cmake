@@ -0,0 +1,26 @@
+# Turns every shader file into a char array in one generated header, so the program doesn't have to find the .glsl files at run time.
+# Run at build time by CMakeLists.txt as: cmake -DOUTPUT=<header> -DSHADERS=<file;file;...> -P EmbedShaders.cmake
+
+set(CONTENTS "// Generated from the .glsl files by EmbedShaders.cmake. Don't edit, edit the shaders instead.\n\n")
+set(TABLE "")
+
+foreach(SHADER ${SHADERS})
+	get_filename_component(NAME "${SHADER}" NAME)
+	get_filename_component(SYMBOL "${SHADER}" NAME_WE)
+
+	# Written out as bytes rather than a string literal, since MSVC limits how long a string literal can be.
+	# Unsigned, because the license header has a byte above 127 (the copyright sign).
+	file(READ "${SHADER}" HEX HEX)
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+
+	set(CONTENTS "${CONTENTS}static const unsigned char embeddedShader${SYMBOL}[] = { ${BYTES} 0x00 };\n")
+	set(TABLE "${TABLE}\t{ \"${NAME}\", (const char*)embeddedShader${SYMBOL} },\n")
+endforeach()
+
+set(CONTENTS "${CONTENTS}\nstruct EmbeddedShader\n{\n\tconst char* name;\n\tconst char* source;\n};\n\n")
+set(CONTENTS "${CONTENTS}static const EmbeddedShader embeddedShaders[] =\n{\n${TABLE}\t{ nullptr, nullptr },\n};\n")
+
+# Only touch the header if it changed, so a rebuild doesn't recompile what includes it for nothing.
+file(WRITE "${OUTPUT}.tmp" "${CONTENTS}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,209 @@
+/*
+Title: Swept AABB-2D
+File Name: FramePacer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _FRAME_PACER_CPP
+#define _FRAME_PACER_CPP
+
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX	// Otherwise windows.h defines min and max macros that break std::min
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#else
+#include <time.h>
+#endif
+
+// The longest a single 1 ms sleep is allowed to count as, when learning how late sleeps are.
+static const double maxSleepSample = 0.004;
+
+FramePacer::FramePacer(FramePacing pacing)
+{
+	mode = pacing;
+
+	// Until we've measured, assume sleeps run 1 ms long on average, and spin for the last 2 ms before each deadline.
+	sleepMean = 0.001;
+	sleepM2 = 0.0;
+	sleepCount = 1;
+	spinThreshold = 0.002;
+
+#ifdef _WIN32
+	// Windows only wakes sleeping threads every 15.6 ms unless asked for something finer.
+	timeBeginPeriod(1);
+#endif
+
+	ResetStats();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+double FramePacer::Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double FramePacer::ProcessCPUSeconds()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+	// FILETIMEs count 100 nanosecond ticks.
+	unsigned long long ticks = ((unsigned long long)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime) + ((unsigned long long)user.dwHighDateTime << 32 | user.dwLowDateTime);
+	return ticks * 1e-7;
+#else
+	timespec now;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+void FramePacer::WaitFor(double seconds)
+{
+	if (mode == FRAME_PACING_OFF || seconds <= 0.0)
+	{
+		return;
+	}
+
+	double deadline = Now() + seconds;
+
+	if (mode == FRAME_PACING_SLEEP)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+		return;
+	}
+
+	if (mode == FRAME_PACING_HYBRID)
+	{
+		// Sleep in 1 ms steps while there's comfortably more time left than a sleep might take.
+		while (deadline - Now() > spinThreshold)
+		{
+			double start = Now();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			double slept = Now() - start;
+
+			// Every now and then the OS is very late (another process got the core). Left as is, one of those would push the estimate up so far
+			// that we'd spin through most of every frame from then on, so a single sample can only count for so much.
+			slept = std::min(slept, maxSleepSample);
+
+			// Update the estimate: stop sleeping once there's less than a typical sleep plus a standard deviation left.
+			sleepCount++;
+			double delta = slept - sleepMean;
+			sleepMean += delta / sleepCount;
+			sleepM2 += delta * (slept - sleepMean);
+			spinThreshold = sleepMean + sqrt(sleepM2 / (sleepCount - 1));
+		}
+	}
+
+	// Spin the rest of the way. Yielding lets anything else waiting for this core run, without giving up our turn for a whole time slice.
+	while (Now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void FramePacer::FrameDone()
+{
+	double now = Now();
+
+	if (lastFrame > 0.0)
+	{
+		frameTimes.push_back(now - lastFrame);
+	}
+
+	lastFrame = now;
+}
+
+FramePacingReport FramePacer::Report(double targetSeconds)
+{
+	FramePacingReport report;
+	report.frames = (unsigned int)frameTimes.size();
+	report.meanFrameMs = 0.0;
+	report.jitterMs = 0.0;
+	report.p99ErrorMs = 0.0;
+
+	double wall = Now() - statsWallStart;
+	report.cpuPercent = wall > 0.0 ? (ProcessCPUSeconds() - statsCPUStart) / wall * 100.0 : 0.0;
+
+	if (frameTimes.empty())
+	{
+		return report;
+	}
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < frameTimes.size(); i++)
+	{
+		sum += frameTimes[i];
+	}
+	double mean = sum / frameTimes.size();
+
+	double squares = 0.0;
+	std::vector<double> errors(frameTimes.size());
+	for (unsigned int i = 0; i < frameTimes.size(); i++)
+	{
+		squares += (frameTimes[i] - mean) * (frameTimes[i] - mean);
+		errors[i] = fabs(frameTimes[i] - targetSeconds);
+	}
+
+	std::sort(errors.begin(), errors.end());
+
+	report.meanFrameMs = mean * 1000.0;
+	report.jitterMs = sqrt(squares / frameTimes.size()) * 1000.0;
+	report.p99ErrorMs = errors[std::min((size_t)(errors.size() * 0.99), errors.size() - 1)] * 1000.0;
+
+	return report;
+}
+
+void FramePacer::ResetStats()
+{
+	frameTimes.clear();
+	lastFrame = 0.0;
+	statsWallStart = Now();
+	statsCPUStart = ProcessCPUSeconds();
+}
+
+#endif // _FRAME_PACER_CPP
@@ -0,0 +1,111 @@
+/*
+Title: Swept AABB-2D
+File Name: FramePacer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _FRAME_PACER_H
+#define _FRAME_PACER_H
+
+#include <vector>
+
+// How the main loop waits between frames.
+enum FramePacing
+{
+	FRAME_PACING_OFF,		// Don't wait at all, run flat out (one core at 100%).
+	FRAME_PACING_SPIN,		// Busy-wait until the deadline. As precise as it gets, but still uses a whole core.
+	FRAME_PACING_SLEEP,		// Sleep until the deadline. Hardly any CPU, but the OS may wake us up late.
+	FRAME_PACING_HYBRID,	// Sleep until just before the deadline, then spin the rest of the way. Close to SPIN's precision for close to SLEEP's CPU.
+};
+
+// What the frames since the last ResetStats looked like.
+struct FramePacingReport
+{
+	unsigned int frames;
+	double meanFrameMs;		// Average time from one frame to the next
+	double jitterMs;		// Standard deviation of the frame times
+	double p99ErrorMs;		// 99% of frames were within this much of the target frame time
+	double cpuPercent;		// CPU time used by the whole process per second of real time (100 = one full core)
+};
+
+// Waits until a deadline as precisely as the pacing mode allows, and keeps track of frame times and CPU use.
+// The hybrid mode learns how long a 1 ms sleep really takes on this machine (how late the OS tends to be),
+// and stops sleeping once the time left is less than that, spinning the rest of the way.
+class FramePacer
+{
+	FramePacing mode;
+
+	// Running mean and variance of how long a 1 ms sleep actually took (Welford's method), and the resulting point where we stop sleeping.
+	double sleepMean;
+	double sleepM2;
+	unsigned long long sleepCount;
+	double spinThreshold;
+
+	std::vector<double> frameTimes;
+	double lastFrame;
+	double statsWallStart;
+	double statsCPUStart;
+
+public:
+	FramePacer(FramePacing pacing = FRAME_PACING_HYBRID);
+	~FramePacer();
+
+	// Seconds on a steady clock, which is what the pacer measures everything with.
+	static double Now();
+
+	// Seconds of CPU time the whole process has used so far.
+	static double ProcessCPUSeconds();
+
+	// Waits until seconds from now (returns right away if that's not in the future, or the mode is FRAME_PACING_OFF).
+	void WaitFor(double seconds);
+
+	// Marks the end of a frame, adding the time since the last one to the stats.
+	void FrameDone();
+
+	// The frame times and CPU use since the last ResetStats. targetSeconds is the frame time we were aiming for.
+	FramePacingReport Report(double targetSeconds);
+	void ResetStats();
+
+	FramePacing Mode()
+	{
+		return mode;
+	}
+	void SetMode(FramePacing pacing)
+	{
+		mode = pacing;
+	}
+};
+
+#endif //_FRAME_PACER_H
@@ -0,0 +1,434 @@
+/*
+Title: Swept AABB-2D
+File Name: FrameProfiler.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _FRAME_PROFILER_CPP
+#define _FRAME_PROFILER_CPP
+
+#include "FrameProfiler.h"
+#include "FramePacer.h"
+#include <algorithm>
+#include <cstring>
+
+// The GPU's clock drifts away from ours, so it gets lined up again every this many frames.
+static const unsigned int calibrateEvery = 256;
+
+FrameProfiler::FrameProfiler()
+{
+	enabled = false;
+	gpuQueries = false;
+	inFrame = false;
+	frameHasQueries = false;
+	gpuOffset = 0.0;
+	frameNumber = 0;
+	gpuPassOpen = false;
+	trace = nullptr;
+	counters = nullptr;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+	CloseTrace();
+}
+
+void FrameProfiler::Init()
+{
+	// GL_TIME_ELAPSED and GL_TIMESTAMP queries came with OpenGL 3.3. Without them only the CPU phases are timed.
+	gpuQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+
+	Calibrate();
+}
+
+void FrameProfiler::Calibrate()
+{
+	if (!gpuQueries)
+	{
+		return;
+	}
+
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpuOffset = FramePacer::Now() - gpuNow * 1e-9;
+}
+
+void FrameProfiler::Cleanup()
+{
+	for (unsigned int f = 0; f < inFlight.size(); f++)
+	{
+		freeTimestamps.push_back(inFlight[f].anchor);
+		for (unsigned int p = 0; p < inFlight[f].passes.size(); p++)
+		{
+			freeElapsed.push_back(inFlight[f].passes[p].query);
+		}
+	}
+	inFlight.clear();
+
+	if (!freeTimestamps.empty())
+	{
+		glDeleteQueries((GLsizei)freeTimestamps.size(), freeTimestamps.data());
+		freeTimestamps.clear();
+	}
+	if (!freeElapsed.empty())
+	{
+		glDeleteQueries((GLsizei)freeElapsed.size(), freeElapsed.data());
+		freeElapsed.clear();
+	}
+
+	CloseTrace();
+}
+
+bool FrameProfiler::OpenTrace(const std::string& path)
+{
+	CloseTrace();
+
+	trace = fopen(path.c_str(), "w");
+	if (trace == nullptr)
+	{
+		return false;
+	}
+
+	// Name the two rows the events go on.
+	fprintf(trace, "[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+	fprintf(trace, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+	enabled = true;
+	return true;
+}
+
+void FrameProfiler::CloseTrace()
+{
+	if (trace != nullptr)
+	{
+		fprintf(trace, "\n]\n");
+		fclose(trace);
+		trace = nullptr;
+	}
+}
+
+GLuint FrameProfiler::GetQuery(std::vector<GLuint>& freeList)
+{
+	if (freeList.empty())
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+		return query;
+	}
+
+	GLuint query = freeList.back();
+	freeList.pop_back();
+	return query;
+}
+
+void FrameProfiler::BeginFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	current.profile.frame = frameNumber++;
+	current.started = FramePacer::Now();
+	current.profile.events.clear();
+	current.passes.clear();
+	current.anchor = 0;
+	openCPU.clear();
+	gpuPassOpen = false;
+	inFrame = true;
+
+	// Rather than wait for a GPU that's far behind, leave this frame's GPU passes untimed.
+	frameHasQueries = gpuQueries && inFlight.size() < MaxFramesInFlight;
+	if (!frameHasQueries)
+	{
+		return;
+	}
+
+	if (frameNumber % calibrateEvery == 0)
+	{
+		Calibrate();
+	}
+
+	// Where the frame starts on the GPU's clock, so the passes can be placed on the same timeline as the CPU phases.
+	current.anchor = GetQuery(freeTimestamps);
+	glQueryCounter(current.anchor, GL_TIMESTAMP);
+}
+
+void FrameProfiler::EndFrame()
+{
+	if (!inFrame)
+	{
+		return;
+	}
+
+	// Close anything left open, so one missing End doesn't spoil every frame after it.
+	while (!openCPU.empty())
+	{
+		EndCPU();
+	}
+	EndGPU();
+
+	inFrame = false;
+
+	if (current.passes.empty())
+	{
+		if (current.anchor != 0)
+		{
+			freeTimestamps.push_back(current.anchor);
+		}
+		Finish(current.profile);
+		return;
+	}
+
+	inFlight.push_back(current);
+}
+
+void FrameProfiler::BeginCPU(const char* name)
+{
+	if (!inFrame)
+	{
+		return;
+	}
+
+	ProfileEvent event;
+	event.name = name;
+	event.gpu = false;
+	event.start = FramePacer::Now();
+	event.duration = 0.0;
+
+	// The counts at the start for now. EndCPU turns them into the difference.
+	if (counters != nullptr)
+	{
+		event.counts = counters->Read();
+	}
+
+	openCPU.push_back((unsigned int)current.profile.events.size());
+	current.profile.events.push_back(event);
+}
+
+void FrameProfiler::EndCPU()
+{
+	if (!inFrame || openCPU.empty())
+	{
+		return;
+	}
+
+	ProfileEvent& event = current.profile.events[openCPU.back()];
+	event.duration = FramePacer::Now() - event.start;
+	if (counters != nullptr)
+	{
+		event.counts = counters->Read() - event.counts;
+	}
+	openCPU.pop_back();
+}
+
+void FrameProfiler::BeginGPU(const char* name)
+{
+	if (!inFrame || !frameHasQueries || gpuPassOpen)
+	{
+		return;
+	}
+
+	PendingPass pass;
+	pass.name = name;
+	pass.query = GetQuery(freeElapsed);
+	current.passes.push_back(pass);
+
+	glBeginQuery(GL_TIME_ELAPSED, pass.query);
+	gpuPassOpen = true;
+}
+
+void FrameProfiler::EndGPU()
+{
+	if (!gpuPassOpen)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	gpuPassOpen = false;
+}
+
+void FrameProfiler::Collect()
+{
+	while (!inFlight.empty())
+	{
+		PendingFrame& oldest = inFlight.front();
+
+		// Only read results that are already there. Asking for one that isn't would wait for the GPU.
+		GLint available = 0;
+		glGetQueryObjectiv(oldest.passes.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			break;
+		}
+
+		GLuint64 anchor = 0;
+		glGetQueryObjectui64v(oldest.anchor, GL_QUERY_RESULT, &anchor);
+		freeTimestamps.push_back(oldest.anchor);
+
+		// A pass can't have taken longer than the time since the frame began. Some drivers (llvmpipe, at least) now and then
+		// return nonsense for a pass at the start of a frame, and one of those would swamp every average it goes into.
+		double longest = FramePacer::Now() - oldest.started;
+
+		// GL_TIME_ELAPSED only says how long each pass took, not when it started, so the passes are laid end to end from the start of the frame.
+		double start = anchor * 1e-9 + gpuOffset;
+		for (unsigned int p = 0; p < oldest.passes.size(); p++)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(oldest.passes[p].query, GL_QUERY_RESULT, &nanoseconds);
+			freeElapsed.push_back(oldest.passes[p].query);
+
+			if (nanoseconds * 1e-9 > longest)
+			{
+				continue;
+			}
+
+			ProfileEvent event;
+			event.name = oldest.passes[p].name;
+			event.gpu = true;
+			event.start = start;
+			event.duration = nanoseconds * 1e-9;
+			oldest.profile.events.push_back(event);
+
+			start += event.duration;
+		}
+
+		Finish(oldest.profile);
+		inFlight.pop_front();
+	}
+}
+
+void FrameProfiler::Finish(FrameProfile& profile)
+{
+	// Add up each phase for this frame first, since one phase can happen several times in a frame.
+	std::vector<PhaseTotal> frameTotals;
+	for (unsigned int e = 0; e < profile.events.size(); e++)
+	{
+		const ProfileEvent& event = profile.events[e];
+
+		unsigned int t = 0;
+		while (t < frameTotals.size() && (frameTotals[t].gpu != event.gpu || strcmp(frameTotals[t].name, event.name) != 0))
+		{
+			t++;
+		}
+		if (t == frameTotals.size())
+		{
+			PhaseTotal total = { event.name, event.gpu, 1, 0.0, 0.0, PerfCounts() };
+			frameTotals.push_back(total);
+		}
+		frameTotals[t].sum += event.duration;
+		frameTotals[t].counts += event.counts;
+	}
+
+	for (unsigned int f = 0; f < frameTotals.size(); f++)
+	{
+		unsigned int t = 0;
+		while (t < totals.size() && (totals[t].gpu != frameTotals[f].gpu || strcmp(totals[t].name, frameTotals[f].name) != 0))
+		{
+			t++;
+		}
+		if (t == totals.size())
+		{
+			PhaseTotal total = { frameTotals[f].name, frameTotals[f].gpu, 0, 0.0, 0.0, PerfCounts() };
+			totals.push_back(total);
+		}
+		totals[t].frames++;
+		totals[t].sum += frameTotals[f].sum;
+		totals[t].counts += frameTotals[f].counts;
+		totals[t].max = std::max(totals[t].max, frameTotals[f].sum);
+	}
+
+	if (trace != nullptr)
+	{
+		WriteTrace(profile);
+	}
+}
+
+void FrameProfiler::WriteTrace(const FrameProfile& profile)
+{
+	// Chrome's trace format: "X" events are complete events with a start and a duration, both in microseconds.
+	// Every event follows the two thread names written by OpenTrace, so each one starts with a comma.
+	for (unsigned int e = 0; e < profile.events.size(); e++)
+	{
+		const ProfileEvent& event = profile.events[e];
+		fprintf(trace, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u",
+			event.name, event.gpu ? "gpu" : "cpu", event.gpu ? 2 : 1, event.start * 1e6, event.duration * 1e6, profile.frame);
+
+		// The hardware counts go in the event's arguments, which the trace viewers show when the event is clicked on.
+		if (counters != nullptr && !event.gpu)
+		{
+			for (int c = 0; c < PERF_COUNTERS; c++)
+			{
+				fprintf(trace, ",\"%s\":%llu", PerfCounters::Name((PerfCounter)c), event.counts.values[c]);
+			}
+		}
+		fprintf(trace, "}}");
+	}
+}
+
+std::vector<PhaseSummary> FrameProfiler::Summary()
+{
+	std::vector<PhaseSummary> summary;
+
+	for (int gpu = 0; gpu < 2; gpu++)
+	{
+		for (unsigned int t = 0; t < totals.size(); t++)
+		{
+			if (totals[t].gpu != (gpu == 1))
+			{
+				continue;
+			}
+
+			PhaseSummary phase;
+			phase.name = totals[t].name;
+			phase.gpu = totals[t].gpu;
+			phase.frames = totals[t].frames;
+			phase.meanMs = totals[t].sum / totals[t].frames * 1000.0;
+			phase.maxMs = totals[t].max * 1000.0;
+			phase.counts = totals[t].counts;
+			summary.push_back(phase);
+		}
+	}
+
+	return summary;
+}
+
+void FrameProfiler::ResetSummary()
+{
+	totals.clear();
+}
+
+#endif // _FRAME_PROFILER_CPP
@@ -0,0 +1,194 @@
+/*
+Title: Swept AABB-2D
+File Name: FrameProfiler.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _FRAME_PROFILER_H
+#define _FRAME_PROFILER_H
+
+#include "GLIncludes.h"
+#include "PerfCounters.h"
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+// One timed piece of a frame, either CPU work (like a physics step) or a GPU pass (like the clear or a draw group).
+struct ProfileEvent
+{
+	const char* name;
+	bool gpu;
+	double start;		// Seconds on FramePacer::Now()'s clock. GPU passes are lined up with it through a timestamp taken at the start of the frame.
+	double duration;	// Seconds
+	PerfCounts counts;	// What the CPU's counters counted during a CPU phase, if the profiler has any (see SetCounters)
+};
+
+// Every event of one frame.
+struct FrameProfile
+{
+	unsigned int frame;
+	std::vector<ProfileEvent> events;
+};
+
+// How long one phase took per frame, over the frames since the last ResetSummary. A phase that ran more than once in a frame
+// (like physics steps) counts as the total for that frame.
+struct PhaseSummary
+{
+	const char* name;
+	bool gpu;
+	unsigned int frames;
+	double meanMs;
+	double maxMs;
+	PerfCounts counts;	// CPU phases only: the counters added up over all of the frames, so divide by frames for a frame's worth
+};
+
+// Times the phases of each frame on the CPU and, with GL_TIME_ELAPSED queries, on the GPU, so it's clear whether the time goes to
+// issuing the draws or to drawing them.
+// The GPU results come back a few frames later: each frame's queries wait in a queue and are only read once the last one says it's
+// available, so reading them never stalls the pipeline. If the GPU falls MaxFramesInFlight frames behind, frames stop getting GPU
+// queries until it catches up rather than waiting.
+// Usage, once a frame:
+//     BeginFrame();
+//     BeginCPU("physics"); ... EndCPU();
+//     BeginGPU("clear"); glClear(...); EndGPU();
+//     EndFrame();
+//     Collect();
+// GPU passes can't overlap each other (OpenGL only allows one GL_TIME_ELAPSED query at a time), CPU phases can nest.
+// Everything does nothing until SetEnabled(true), so the calls can stay in the frame loop.
+class FrameProfiler
+{
+	struct PendingPass
+	{
+		const char* name;
+		GLuint query;
+	};
+
+	struct PendingFrame
+	{
+		FrameProfile profile;
+		double started;	// When BeginFrame was called, on our clock
+		GLuint anchor;	// GL_TIMESTAMP query from the start of the frame
+		std::vector<PendingPass> passes;
+	};
+
+	struct PhaseTotal
+	{
+		const char* name;
+		bool gpu;
+		unsigned int frames;
+		double sum;
+		double max;
+		PerfCounts counts;
+	};
+
+	static const unsigned int MaxFramesInFlight = 4;
+
+	bool enabled;
+	bool gpuQueries;
+	bool inFrame;
+	bool frameHasQueries;
+	double gpuOffset;	// CPU time minus GPU time, in seconds
+	unsigned int frameNumber;
+
+	PendingFrame current;
+	std::vector<unsigned int> openCPU;	// Indices of the CPU events that haven't ended yet
+	bool gpuPassOpen;
+
+	std::deque<PendingFrame> inFlight;
+	// A query object is tied to the kind of query it was first used for, so the two kinds are recycled separately.
+	std::vector<GLuint> freeTimestamps;
+	std::vector<GLuint> freeElapsed;
+	std::vector<PhaseTotal> totals;
+
+	FILE* trace;
+	PerfCounters* counters;
+
+	void Calibrate();
+	GLuint GetQuery(std::vector<GLuint>& freeList);
+	void Finish(FrameProfile&);
+	void WriteTrace(const FrameProfile&);
+
+public:
+	FrameProfiler();
+	~FrameProfiler();
+
+	// Call once the GL context is current (whether or not profiling is enabled yet). Checks for timer queries and lines the GPU's clock up with ours.
+	void Init();
+	void Cleanup();
+
+	void SetEnabled(bool on)
+	{
+		enabled = on;
+	}
+
+	// Also reads these hardware counters at the start and end of every CPU phase (and writes them to the trace). They have to
+	// have been opened on the thread that calls BeginCPU and EndCPU. nullptr stops reading them.
+	void SetCounters(PerfCounters* inCounters)
+	{
+		counters = inCounters;
+	}
+	bool HasCounters()
+	{
+		return counters != nullptr;
+	}
+	bool Enabled()
+	{
+		return enabled;
+	}
+
+	// Starts writing every finished frame to a Chrome trace file (open it with chrome://tracing or ui.perfetto.dev), with CPU phases and GPU passes
+	// on separate rows. Turns profiling on. Returns false if the file can't be created.
+	bool OpenTrace(const std::string& path);
+	void CloseTrace();
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginCPU(const char* name);
+	void EndCPU();
+
+	void BeginGPU(const char* name);
+	void EndGPU();
+
+	// Picks up the frames whose GPU results are ready, without waiting. After a glFinish, that's all of them.
+	void Collect();
+
+	// The per-frame cost of every phase seen since the last ResetSummary, CPU phases first, in the order they were first seen.
+	std::vector<PhaseSummary> Summary();
+	void ResetSummary();
+};
+
+#endif //_FRAME_PROFILER_H
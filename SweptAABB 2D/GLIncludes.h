@@ -45,6 +45,7 @@ object passes through or into the middle of the colliding object).
 #include "glm\gtc\type_ptr.hpp"
 #include "glm\gtc\quaternion.hpp"
 #include "glm\gtx\quaternion.hpp"
+#include "glm\gtc\packing.hpp"
 
 // We create a VertexFormat struct, which defines how the data passed into the shader code wil be formatted
 struct VertexFormat
@@ -67,4 +68,28 @@ struct VertexFormat
 	}
 };
 
+// VertexFormat is 28 bytes per vertex, which is a lot for flat-coloured 2D shapes. A Model can store its vertices on the GPU in a smaller layout instead.
+// The Model still keeps VertexFormat on the CPU side (for things like calculating AABBs), and only packs the data when it fills its buffer.
+enum VertexLayout
+{
+	VERTEX_LAYOUT_FULL,		// VertexFormat as it is: vec4 color, vec3 position. 28 bytes.
+	VERTEX_LAYOUT_COMPACT,	// VertexFormatCompact: vec2 position, RGBA8 color. 12 bytes.
+	VERTEX_LAYOUT_HALF		// VertexFormatHalf: half-float vec2 position, RGBA8 color. 8 bytes. Only use this when positions don't need more than about 3 significant digits.
+};
+
+// 2D float position, plus a color stored as 4 bytes that the GPU turns back into 0.0 - 1.0 floats (normalized).
+// The vertex shader still takes in a vec3 position, and OpenGL fills in the missing z with 0.0.
+struct VertexFormatCompact
+{
+	glm::vec2 position;
+	GLuint color;
+};
+
+// The same as VertexFormatCompact, but the position is two 16-bit half floats.
+struct VertexFormatHalf
+{
+	GLushort position[2];
+	GLuint color;
+};
+
 #endif _GL_INCLUDES_H
\ No newline at end of file
@@ -41,6 +41,16 @@ object passes through or into the middle of the colliding object).
 
 #include "GLIncludes.h"
 #include "GameObject.h"
+#include "World.h"
+#include "SceneGraph.h"
+#include "GeometryArena.h"
+#include "BodyBuffer.h"
+#include "ViewCulling.h"
+#include "RenderQueue.h"
+#include "ShaderLoader.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "ModelRegistry.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -51,9 +61,24 @@ object passes through or into the middle of the colliding object).
 // This program will run on your GPU.
 GLuint program;
 
-// These are your references to your actual compiled shaders
-GLuint vertex_shader;
-GLuint fragment_shader;
+// The program used to draw everything at once through the geometry arena. It takes each object's MVP matrix per instance instead of as a uniform.
+GLuint instancedProgram;
+
+// The program used for vertex pulling: VertexShader.glsl with VERTEX_PULLING defined, so it reads each body's position and scale from a buffer.
+GLuint pullingProgram;
+GLint uniPV;
+GLint uniFirstBody;
+
+// The different ways we know how to draw the world, from the simplest to the ones that need newer OpenGL.
+enum RenderPath
+{
+	RENDER_PATH_UNIFORM,	// One draw call per object, with the MVP matrix calculated on the CPU and passed as a uniform.
+	RENDER_PATH_ARENA,		// Every model in one GeometryArena, drawn with one multi-draw indirect call (OpenGL 4.3).
+	RENDER_PATH_PULLING,	// Only each body's position and scale are uploaded, and the vertex shader builds the transform (OpenGL 4.3).
+};
+
+// Which path to draw with. Can be picked with --render on the command line. If the OpenGL context can't do it, init() falls back to a simpler one.
+RenderPath renderPath = RENDER_PATH_ARENA;
 
 // This is a reference to your uniform MVP matrix in your vertex shader
 GLuint uniMVP;
@@ -75,117 +100,100 @@ float speed = 0.90f;
 // An array of vertices stored in an std::vector for our object.
 std::vector<VertexFormat> vertices;
 
-// References to our two GameObjects and the one Model we'll be using.
-GameObject* obj1;
-GameObject* obj2;
-Model* square;
+// The world owns every object in the simulation. Other threads send it commands instead of changing the objects directly.
+World world;
 
-// This function runs every frame
-void renderScene()
-{
-	// Clear the color buffer and the depth buffer
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+// Keeps objects that are attached to other objects (like a turret on a tank) following their parents.
+SceneGraph sceneGraph;
 
-	// Clear the screen to white
-	glClearColor(1.0, 1.0, 1.0, 1.0);
+// Handles to our two objects in the world, and the one Model we'll be using.
+ObjectHandle obj1;
+ObjectHandle obj2;
+Model* square;
 
-	// Tell OpenGL to use the shader program you've created.
-	glUseProgram(program);
+// Every model comes from here, so a mesh that's made more than once (in code or by loading it) is only stored and uploaded once.
+ModelRegistry modelRegistry;
 
-	// Set the uniform matrix in our shader to our MVP matrix for the first object.
-	glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(MVP));
+// Holds every model in one set of buffers so the whole world can be drawn with one call. Stays null if the OpenGL context is older than 4.3.
+GeometryArena* arena;
 
-	// Draw the square.
-	square->Draw();
+// Holds the bodies uploaded for vertex pulling. Stays null unless that path is used.
+BodyBuffer* bodyBuffer;
 
-	// Set the uniform matrix in our shader to our MVP matrix for the second object.
-	glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(MVP2));
+// Sorts the uniform path's draws by program and model so state only changes when it has to. queueProgramId is our program's id in it.
+RenderQueue renderQueue;
+unsigned int queueProgramId;
 
-	// Draw the square again.
-	square->Draw();
+// Finds the objects inside the camera's view each frame, so only those get drawn. Turned off with --no-cull.
+ViewCuller culler;
+bool viewCulling = true;
 
-	// We're using the same model here to draw, but different transformation matrices so that we can use less data overall.
-	// This is a technique called instancing, although "true" instancing involves binding a matrix array to the uniform variable and using DrawInstanced in place of draw.
-}
+// How many draw calls the last renderScene made, whichever path it took.
+unsigned int drawCalls = 0;
+
+// Times the clear, the culling and the draws on the CPU and the GPU, when it's turned on with --profile or --trace.
+FrameProfiler profiler;
 
-// This method reads the text from a file.
-// Realistically, we wouldn't want plain text shaders hardcoded in, we'd rather read them in from a separate file so that the shader code is separated.
-std::string readShader(std::string fileName)
+// This function runs every frame
+void renderScene()
 {
-	std::string shaderCode;
-	std::string line;
+	// Clear the color buffer and the depth buffer
+	profiler.BeginGPU("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	profiler.EndGPU();
 
-	// We choose ifstream and std::ios::in because we are opening the file for input into our program.
-	// If we were writing to the file, we would use ofstream and std::ios::out.
-	std::ifstream file(fileName, std::ios::in);
+	// Clear the screen to white
+	glClearColor(1.0, 1.0, 1.0, 1.0);
 
-	// This checks to make sure that we didn't encounter any errors when getting the file.
-	if (!file.good())
+	// Ask the broadphase what's inside the part of the z = 0 plane the camera sees. Null means draw everything.
+	const std::vector<unsigned int>* visible = nullptr;
+	if (viewCulling)
 	{
-		std::cout << "Can't read file: " << fileName.data() << std::endl;
-
-		// Return so we don't error out.
-		return "";
+		profiler.BeginCPU("cull");
+		visible = &culler.Cull(world, ViewCuller::ViewRectangle(proj, view));
+		profiler.EndCPU();
 	}
 
-	// ifstream keeps an internal "get" position determining the location of the element to be read next
-	// seekg allows you to modify this location, and tellg allows you to get this location
-	// This location is stored as a streampos member type, and the parameters passed in must be of this type as well
-	// seekg parameters are (offset, direction) or you can just use an absolute (position).
-	// The offset parameter is of the type streamoff, and the direction is of the type seekdir (an enum which can be ios::beg, ios::cur, or ios::end referring to the beginning, 
-	// current position, or end of the stream).
-	file.seekg(0, std::ios::end);					// Moves the "get" position to the end of the file.
-	shaderCode.resize((unsigned int)file.tellg());	// Resizes the shaderCode string to the size of the file being read, given that tellg will give the current "get" which is at the end of the file.
-	file.seekg(0, std::ios::beg);					// Moves the "get" position to the start of the file.
-
-													// File streams contain two member functions for reading and writing binary data (read, write). The read function belongs to ifstream, and the write function belongs to ofstream.
-													// The parameters are (memoryBlock, size) where memoryBlock is of type char* and represents the address of an array of bytes are to be read from/written to.
-													// The size parameter is an integer that determines the number of characters to be read/written from/to the memory block.
-	file.read(&shaderCode[0], shaderCode.size());	// Reads from the file (starting at the "get" position which is currently at the start of the file) and writes that data to the beginning
-													// of the shaderCode variable, up until the full size of shaderCode. This is done with binary data, which is why we must ensure that the sizes are all correct.
-
-	file.close(); // Now that we're done, close the file and return the shaderCode.
-
-	return shaderCode;
-}
-
-// This method will consolidate some of the shader code we've written to return a GLuint to the compiled shader.
-// It only requires the shader source code and the shader type.
-GLuint createShader(std::string sourceCode, GLenum shaderType)
-{
-	// glCreateShader, creates a shader given a type (such as GL_VERTEX_SHADER) and returns a GLuint reference to that shader.
-	GLuint shader = glCreateShader(shaderType);
-	const char *shader_code_ptr = sourceCode.c_str(); // We establish a pointer to our shader code string
-	const int shader_code_size = sourceCode.size();   // And we get the size of that string.
-
-													  // glShaderSource replaces the source code in a shader object
-													  // It takes the reference to the shader (a GLuint), a count of the number of elements in the string array (in case you're passing in multiple strings), a pointer to the string array 
-													  // that contains your source code, and a size variable determining the length of the array.
-	glShaderSource(shader, 1, &shader_code_ptr, &shader_code_size);
-	glCompileShader(shader); // This just compiles the shader, given the source code.
-
-	GLint isCompiled = 0;
+	// Each path's draws are one batch (a multi-draw, an instanced draw per model, or the sorted queue), so each is timed as one pass.
 
-	// Check the compile status to see if the shader compiled correctly.
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-
-	if (isCompiled == GL_FALSE)
+	// If we can, draw every visible object in the world (including our two squares) with a single multi-draw indirect call.
+	if (renderPath == RENDER_PATH_ARENA)
 	{
-		char infolog[1024];
-		glGetShaderInfoLog(shader, 1024, NULL, infolog);
+		profiler.BeginGPU("draw arena");
+		glUseProgram(instancedProgram);
+		arena->Draw(world, PV, &sceneGraph, visible);
+		drawCalls = arena->InstancesDrawn() > 0 ? 1 : 0;
+		profiler.EndGPU();
+		return;
+	}
 
-		// Print the compile error.
-		std::cout << "The shader failed to compile with the error:" << std::endl << infolog << std::endl;
+	// Or send just the position and scale of each body and let the vertex shader do the rest.
+	if (renderPath == RENDER_PATH_PULLING)
+	{
+		profiler.BeginGPU("draw pulling");
+		glUseProgram(pullingProgram);
+		glUniformMatrix4fv(uniPV, 1, GL_FALSE, glm::value_ptr(PV));
+		bodyBuffer->Draw(world, uniFirstBody, visible);
+		drawCalls = bodyBuffer->NumDraws();
+		profiler.EndGPU();
+		return;
+	}
 
-		// Provide the infolog in whatever manor you deem best.
-		// Exit with failure.
-		glDeleteShader(shader); // Don't leak the shader.
+	// Otherwise every visible object (including our two squares) goes through the render queue: a command per object, sorted so that objects
+	// sharing a program and model are drawn one after the other, and the executor only calls glUseProgram or rebinds buffers when those change.
+	profiler.BeginCPU("fill and sort");
+	renderQueue.Clear();
+	renderQueue.Fill(world, visible, queueProgramId);
+	renderQueue.Sort();
+	profiler.EndCPU();
 
-								// NOTE: I almost always put a break point here, so that instead of the program continuing with a deleted/failed shader, it stops and gives me a chance to look at what may 
-								// have gone wrong. You can check the console output to see what the error was, and usually that will point you in the right direction.
-	}
+	profiler.BeginGPU("draw queue");
+	renderQueue.Execute(world, PV, &sceneGraph);
+	drawCalls = renderQueue.Stats().draws;
+	profiler.EndGPU();
 
-	return shader;
+	// We're using the same model here to draw, but different transformation matrices so that we can use less data overall.
+	// This is a technique called instancing, although "true" instancing involves binding a matrix array to the uniform variable and using DrawInstanced in place of draw.
 }
 
 void setupSquare()
@@ -201,24 +209,17 @@ void setupSquare()
 	vertices.push_back(VertexFormat(glm::vec3(1.0f, 1.0f, 0.0f), glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)));
 	vertices.push_back(VertexFormat(glm::vec3(1.0f, -1.0f, 0.0f), glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)));
 
-	// Create our square model from the data.
-	square = new Model(vertices.size(), vertices.data(), 6, elements);
+	// Create our square model from the data (or get the one that's already been made, if anything else asked for the same square first).
+	square = modelRegistry.Acquire(vertices.size(), vertices.data(), 6, elements);
 
-	// Create two GameObjects based off of the square model (note that they are both holding pointers to the square, not actual copies of the square vertex data).
-	obj1 = new GameObject(square);
-	obj2 = new GameObject(square);
-
-	// Set beginning properties of GameObjects.
-	obj1->SetVelocity(glm::vec3(0, 0.0f, 0.0f)); // The first object doesn't move.
-	obj2->SetVelocity(glm::vec3(-speed, -speed, 0.0f));
-	obj1->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
-	obj2->SetPosition(glm::vec3(0.7f, 0.7f, 0.0f));
-	obj1->SetScale(glm::vec3(0.25f, 0.25f, 0.25f));
-	obj2->SetScale(glm::vec3(0.05f, 0.05f, 0.05f));
+	// Create two objects in the world based off of the square model (note that they are both holding pointers to the square, not actual copies of the square vertex data).
+	// Spawn takes the model, then the beginning position, velocity and scale of the GameObject.
+	obj1 = world.Spawn(square, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0, 0.0f, 0.0f), glm::vec3(0.25f, 0.25f, 0.25f)); // The first object doesn't move.
+	obj2 = world.Spawn(square, glm::vec3(0.7f, 0.7f, 0.0f), glm::vec3(-speed, -speed, 0.0f), glm::vec3(0.05f, 0.05f, 0.05f));
 }
 
-// Initialization code
-void init()
+// Initialization code. Returns false (after printing why) if the shaders couldn't be built, in which case there's nothing to draw with.
+bool init()
 {
 	// Initializes the glew library
 	glewInit();
@@ -228,28 +229,73 @@ void init()
 
 	setupSquare();
 
-	// Read in the shader code from a file.
-	std::string vertShader = readShader("../VertexShader.glsl");
-	std::string fragShader = readShader("../FragmentShader.glsl");
+	// Fall back to a simpler path if the OpenGL context doesn't support the one asked for.
+	if (renderPath == RENDER_PATH_PULLING && !BodyBuffer::IsSupported())
+	{
+		std::cout << "Vertex pulling needs OpenGL 4.3, falling back." << std::endl;
+		renderPath = RENDER_PATH_ARENA;
+	}
+	if (renderPath == RENDER_PATH_ARENA && !GeometryArena::IsSupported())
+	{
+		renderPath = RENDER_PATH_UNIFORM;
+	}
 
-	// createShader consolidates all of the shader compilation code
-	vertex_shader = createShader(vertShader, GL_VERTEX_SHADER);
-	fragment_shader = createShader(fragShader, GL_FRAGMENT_SHADER);
+	// Get the shader code. It's built into the program (see EmbedShaders.cmake), so there are no files to find.
+	std::string vertShader = loadShaderSource("VertexShader.glsl");
+	std::string fragShader = loadShaderSource("FragmentShader.glsl");
 
 	// A shader is a program that runs on your GPU instead of your CPU. In this sense, OpenGL refers to your groups of shaders as "programs".
-	// Using glCreateProgram creates a shader program and returns a GLuint reference to it.
-	program = glCreateProgram();
-	glAttachShader(program, vertex_shader);		// This attaches our vertex shader to our program.
-	glAttachShader(program, fragment_shader);	// This attaches our fragment shader to our program.
+	// The program cache compiles and links our programs, or, if this computer has linked the same ones before, loads the saved result instead.
+	// Every program we need is started before any are checked on, so a driver with parallel shader compiling can do them all at once.
+	double shaderStart = FramePacer::Now();
+	ProgramCache programCache;
+
+	program = programCache.Begin(vertShader, fragShader);
 
-												// This links the program, using the vertex and fragment shaders to create executables to run on the GPU.
-	glLinkProgram(program);
+	// With OpenGL 4.3 we can put every model in one arena and draw the whole world with one call, using a second program that takes the MVP per instance.
+	// The fragment shader is the same for every program.
+	if (renderPath == RENDER_PATH_ARENA)
+	{
+		instancedProgram = programCache.Begin(loadShaderSource("InstancedVertexShader.glsl"), fragShader);
+	}
+
+	// Vertex pulling uses the same vertex shader file, just compiled with VERTEX_PULLING defined.
+	if (renderPath == RENDER_PATH_PULLING)
+	{
+		pullingProgram = programCache.Begin(enableVertexPulling(vertShader), fragShader);
+	}
+
+	if (!programCache.Finish())
+	{
+		std::cout << "Couldn't build the shader programs." << std::endl;
+		return false;
+	}
+	std::cout << "Shaders ready in " << (FramePacer::Now() - shaderStart) * 1000.0 << " ms (" << programCache.LoadedFromCache() << " from the cache, "
+		<< programCache.Compiled() << " compiled)" << std::endl;
 	// End of shader and program creation
 
 	// This gets us a reference to the uniform variable in the vertex shader, which is called "MVP".
 	// We're using this variable as a 4x4 transformation matrix
 	// Only 2 parameters required: A reference to the shader program and the name of the uniform variable within the shader code.
 	uniMVP = glGetUniformLocation(program, "MVP");
+	queueProgramId = renderQueue.RegisterProgram(program, uniMVP);
+
+	profiler.Init();
+
+	if (renderPath == RENDER_PATH_ARENA)
+	{
+		arena = new GeometryArena();
+		arena->Add(square);
+		arena->Upload();
+	}
+
+	if (renderPath == RENDER_PATH_PULLING)
+	{
+		uniPV = glGetUniformLocation(pullingProgram, "PV");
+		uniFirstBody = glGetUniformLocation(pullingProgram, "firstBody");
+
+		bodyBuffer = new BodyBuffer();
+	}
 
 	// Creates the view matrix using glm::lookAt.
 	// First parameter is camera position, second parameter is point to be centered on-screen, and the third paramter is the up axis.
@@ -263,12 +309,9 @@ void init()
 	PV = proj * view;
 
 	// Create your MVP matrices based on the objects' transforms.
-	MVP = PV * *obj1->GetTransform();
-	MVP2 = PV * *obj2->GetTransform();
-
-	// Calculate the Axis-Aligned Bounding Box for your object.
-	obj1->CalculateAABB();
-	obj2->CalculateAABB();
+	// (The world already calculated each object's Axis-Aligned Bounding Box when it was spawned.)
+	MVP = PV * world.GetTransform(world.DenseIndex(obj1));
+	MVP2 = PV * world.GetTransform(world.DenseIndex(obj2));
 
 	// This is not necessary, but I prefer to handle my vertices in the clockwise order. glFrontFace defines which face of the triangles you're drawing is the front.
 	// Essentially, if you draw your vertices in counter-clockwise order, by default (in OpenGL) the front face will be facing you/the screen. If you draw them clockwise, the front face 
@@ -285,19 +328,34 @@ void init()
 	// The mode determines how the polygons will be rasterized. GL_POINT will draw points at each vertex, GL_LINE will draw lines between the vertices, and 
 	// GL_FILL will fill the area inside those lines.
 	glPolygonMode(GL_FRONT, GL_FILL);
+
+	return true;
 }
 
 void cleanup()
 {
 	// After the program is over, cleanup your data!
-	glDeleteShader(vertex_shader);
-	glDeleteShader(fragment_shader);
+	// (The shaders were already deleted once they were linked into the programs.)
 	glDeleteProgram(program);
+
+	// The profiler's queries and trace file.
+	profiler.Cleanup();
+
+	// The arena owns OpenGL buffers, so it has to go before the context does.
+	if (arena != nullptr)
+	{
+		delete(arena);
+		glDeleteProgram(instancedProgram);
+	}
+	if (bodyBuffer != nullptr)
+	{
+		delete(bodyBuffer);
+		glDeleteProgram(pullingProgram);
+	}
 	// Note: If at any point you stop using a "program" or shaders, you should free the data up then and there.
 
-	delete(obj1);
-	delete(obj2);
-	delete(square);
+	// The world only holds pointers to the model, so it's ours to clean up. Releasing the last reference deletes it.
+	modelRegistry.Release(square);
 
 	// Frees up GLFW memory
 	glfwTerminate();
@@ -39,6 +39,7 @@ object passes through or into the middle of the colliding object).
 #define _GAME_OBJECT_CPP
 
 #include "GameObject.h"
+#include "BoundsBatch.h"
 
 // Note that the model does not actually get copied, but instead we just save a pointer to it.
 // So make sure that model is stored and cleaned up elsewhere!
@@ -73,59 +74,19 @@ void GameObject::Update(float dt)
 
 void GameObject::CalculateAABB()
 {
-	// Create local variables for the vertices of the model.
-	VertexFormat* vertexArray = model->Vertices();
-	int numVertexArray = model->NumVertices();
-
-	// Create a temporary AABB that uses vec4 for the purposes of matrix multiplication.
-	CalculatorAABB newBox;
-
-	// Set the min and max equal to the first vertex in the object times the transformation matrix.
-	newBox.min = transformation * glm::vec4(vertexArray[0].position, 1.0f);
-	newBox.max = newBox.min;
-
-	// Loop through the rest of the vertices.
-	for (int i = 1; i < numVertexArray; i++)
+	// Transform the model's hull vertices and find the smallest and largest x, y and z among them. The hull is worked out once when the model
+	// is made (see Model::CalculateHull), and whichever way the object is rotated, its furthest point in any direction is on the hull,
+	// so the box comes out the same as transforming every vertex would make it.
+	// computeBounds does 8 vertices at a time when the CPU can, and splits really big hulls between threads. See BoundsBatch.h.
+	if (model->HullSize() == 0)
 	{
-		// Create a temporary vertex that is the vertices at index i turned into a vector4 and modified by the transformation matrix.
-		glm::vec4 tempVert = transformation * glm::vec4(vertexArray[i].position, 1.0f);
-
-		// If this vertex has a value larger than the max value of our newBox, replace the newBox max value with that value.
-		if (tempVert.x > newBox.max.x)
-		{
-			newBox.max.x = tempVert.x;
-		}
-		if (tempVert.y > newBox.max.y)
-		{
-			newBox.max.y = tempVert.y;
-		}
-		if (tempVert.z > newBox.max.z)
-		{
-			newBox.max.z = tempVert.z;
-		}
-
-		// Do the same for the minimum value.
-		if (tempVert.x < newBox.min.x)
-		{
-			newBox.min.x = tempVert.x;
-		}
-		if (tempVert.y < newBox.min.y)
-		{
-			newBox.min.y = tempVert.y;
-		}
-		if (tempVert.z < newBox.min.z)
-		{
-			newBox.min.z = tempVert.z;
-		}
+		// A model without vertices is just a point at our position.
+		box.min = glm::vec3(transformation[3]);
+		box.max = box.min;
+		return;
 	}
 
-	// Now set the actual AABB min/max (vec3 instead of vec4) to be stored in this GameObject.
-	box.min.x = newBox.min.x;
-	box.min.y = newBox.min.y;
-	box.min.z = newBox.min.z;
-	box.max.x = newBox.max.x;
-	box.max.y = newBox.max.y;
-	box.max.z = newBox.max.z;
+	computeBounds(transformation, model->HullSize(), model->HullX(), model->HullY(), model->HullZ(), box.min, box.max);
 }
 
 // Calculates the transformation matrix based on translation, then rotation, then scale.
@@ -0,0 +1,224 @@
+/*
+Title: Swept AABB-2D
+File Name: GeometryArena.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _GEOMETRY_ARENA_CPP
+#define _GEOMETRY_ARENA_CPP
+
+#include "GeometryArena.h"
+
+GeometryArena::GeometryArena()
+{
+	vao = 0;
+	vbo = 0;
+	ebo = 0;
+	instanceBuffer = 0;
+	indirectBuffer = 0;
+	instancesDrawn = 0;
+	objectsSkipped = 0;
+}
+
+GeometryArena::~GeometryArena()
+{
+	// Deleting a name of 0 is ignored, so this is fine even if Upload() was never called.
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteBuffers(1, &indirectBuffer);
+	glDeleteVertexArrays(1, &vao);
+}
+
+bool GeometryArena::IsSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+}
+
+int GeometryArena::Add(Model* model)
+{
+	std::unordered_map<Model*, int>::iterator found = modelIds.find(model);
+	if (found != modelIds.end())
+	{
+		return found->second;
+	}
+
+	if (!model->HasCPUData())
+	{
+		return -1;
+	}
+
+	// The model's indices stay relative to its own first vertex. The draw command's baseVertex adds the offset on the GPU.
+	ModelRange range;
+	range.baseVertex = (GLint)vertexData.size();
+	range.firstIndex = (GLuint)indexData.size();
+	range.numIndices = (GLuint)model->NumIndices();
+
+	vertexData.insert(vertexData.end(), model->Vertices(), model->Vertices() + model->NumVertices());
+	indexData.insert(indexData.end(), model->Indices(), model->Indices() + model->NumIndices());
+
+	int id = (int)models.size();
+	models.push_back(model);
+	ranges.push_back(range);
+	modelIds[model] = id;
+
+	return id;
+}
+
+void GeometryArena::Upload()
+{
+	if (vao == 0)
+	{
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &vbo);
+		glGenBuffers(1, &ebo);
+		glGenBuffers(1, &instanceBuffer);
+		glGenBuffers(1, &indirectBuffer);
+	}
+
+	// A vertex array object remembers the buffer bindings and attribute setup below, so drawing later only needs to bind the vao.
+	glBindVertexArray(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indexData.size(), indexData.data(), GL_STATIC_DRAW);
+
+	// Position and color, the same as Model::InitBuffer does for VertexFormat.
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)16);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)0);
+
+	// The MVP matrix of each instance. A mat4 attribute takes up 4 locations (one per column), so it's set up as 4 vec4s.
+	// The divisor of 1 means it moves on to the next matrix once per instance instead of once per vertex.
+	// Unlike gl_InstanceID, instanced attributes do start at the draw command's baseInstance, which is how each model finds its own objects' matrices.
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	for (int column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(2 + column);
+		glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4) * column));
+		glVertexAttribDivisor(2 + column, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::Draw(World& world, const glm::mat4& PV, SceneGraph* sceneGraph, const std::vector<unsigned int>* visible)
+{
+	// Either the objects we were given or every object in the world. The k-th object drawn is (*visible)[k] (or just k).
+	unsigned int numObjects = visible != nullptr ? (unsigned int)visible->size() : world.NumObjects();
+	Model** objectModelPointers = world.Models();
+
+	// First pass: find each object's model and count how many objects use each model.
+	objectModels.resize(numObjects);
+	instanceCounts.assign(models.size(), 0);
+	objectsSkipped = 0;
+
+	for (unsigned int k = 0; k < numObjects; k++)
+	{
+		unsigned int i = visible != nullptr ? (*visible)[k] : k;
+		std::unordered_map<Model*, int>::iterator found = modelIds.find(objectModelPointers[i]);
+
+		if (found == modelIds.end())
+		{
+			objectModels[k] = -1;
+			objectsSkipped++;
+			continue;
+		}
+
+		objectModels[k] = found->second;
+		instanceCounts[found->second]++;
+	}
+
+	// Each model's instances go in one block of the instance buffer, starting at its baseInstance.
+	commands.resize(models.size());
+	GLuint nextInstance = 0;
+
+	for (unsigned int m = 0; m < models.size(); m++)
+	{
+		commands[m].count = ranges[m].numIndices;
+		commands[m].instanceCount = instanceCounts[m];
+		commands[m].firstIndex = ranges[m].firstIndex;
+		commands[m].baseVertex = ranges[m].baseVertex;
+		commands[m].baseInstance = nextInstance;
+
+		nextInstance += instanceCounts[m];
+
+		// Reuse the counts as each model's next free spot for the second pass.
+		instanceCounts[m] = commands[m].baseInstance;
+	}
+
+	// Second pass: write each object's MVP into its model's block.
+	instanceMVPs.resize(nextInstance);
+
+	for (unsigned int k = 0; k < numObjects; k++)
+	{
+		if (objectModels[k] < 0)
+		{
+			continue;
+		}
+
+		unsigned int i = visible != nullptr ? (*visible)[k] : k;
+		const glm::mat4* attached = sceneGraph != nullptr ? sceneGraph->GetWorldTransform(world.HandleAt(i)) : nullptr;
+		instanceMVPs[instanceCounts[objectModels[k]]++] = PV * (attached != nullptr ? *attached : world.GetTransform(i));
+	}
+
+	instancesDrawn = nextInstance;
+
+	if (nextInstance == 0)
+	{
+		return;
+	}
+
+	// Upload this frame's matrices and commands. GL_STREAM_DRAW since they're written once and used once.
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * instanceMVPs.size(), instanceMVPs.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * commands.size(), commands.data(), GL_STREAM_DRAW);
+
+	// One call draws every model. The last parameter (0) means the commands are packed one right after the other.
+	glBindVertexArray(vao);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)commands.size(), 0);
+	glBindVertexArray(0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+#endif // _GEOMETRY_ARENA_CPP
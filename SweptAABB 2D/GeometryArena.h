@@ -0,0 +1,124 @@
+/*
+Title: Swept AABB-2D
+File Name: GeometryArena.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _GEOMETRY_ARENA_H
+#define _GEOMETRY_ARENA_H
+
+#include "World.h"
+#include "SceneGraph.h"
+#include <unordered_map>
+#include <vector>
+
+// One vertex buffer, one element buffer and one vertex array object holding every model we draw.
+// Each model gets its own range of the buffers, and each frame the arena builds a list of draw commands from the world (one per model,
+// with every object using that model as an instance) and hands the whole list to the GPU with a single glMultiDrawElementsIndirect call.
+// That's one draw call per frame no matter how many objects or models there are, and no rebinding between models.
+// Needs OpenGL 4.3 (or ARB_multi_draw_indirect) and a program built from InstancedVertexShader.glsl.
+class GeometryArena
+{
+	// Where a model's data lives inside the shared buffers.
+	struct ModelRange
+	{
+		GLint baseVertex;
+		GLuint firstIndex;
+		GLuint numIndices;
+	};
+
+	// The layout glMultiDrawElementsIndirect reads from the GL_DRAW_INDIRECT_BUFFER, one per model.
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	GLuint vao;
+	GLuint vbo;
+	GLuint ebo;
+	GLuint instanceBuffer;	// One MVP matrix per object, read as a per-instance vertex attribute.
+	GLuint indirectBuffer;	// The draw commands.
+
+	std::vector<Model*> models;
+	std::vector<ModelRange> ranges;
+	std::unordered_map<Model*, int> modelIds;
+
+	// The combined data of every model, kept until Upload() sends it to the GPU.
+	std::vector<VertexFormat> vertexData;
+	std::vector<GLuint> indexData;
+
+	// Reused every frame so building the draw doesn't allocate.
+	std::vector<int> objectModels;
+	std::vector<GLuint> instanceCounts;
+	std::vector<glm::mat4> instanceMVPs;
+	std::vector<DrawElementsIndirectCommand> commands;
+
+	unsigned int instancesDrawn;
+	unsigned int objectsSkipped;
+
+public:
+	GeometryArena();
+	~GeometryArena();
+
+	// Whether the current OpenGL context can do multi-draw indirect. Call after glewInit().
+	static bool IsSupported();
+
+	// Copies the model's vertices and indices onto the end of the arena. Returns its id in the arena (adding the same model twice returns the same id).
+	// Nothing reaches the GPU until Upload() is called. A model that has dropped its CPU copy can't be added (returns -1), and its objects aren't drawn.
+	int Add(Model*);
+
+	// Sends everything added so far to the GPU and sets up the vertex array object. Needs a current OpenGL context.
+	void Upload();
+
+	// Draws every object in the world whose model is in the arena with one call. PV is the projection * view matrix.
+	// If a scene graph is given, attached objects use its transform. Objects with a model that isn't in the arena are skipped (see ObjectsSkipped()).
+	// If visible is given, only those objects (dense indices, like the ones from ViewCuller) are drawn.
+	void Draw(World&, const glm::mat4& PV, SceneGraph* sceneGraph = nullptr, const std::vector<unsigned int>* visible = nullptr);
+
+	unsigned int InstancesDrawn()
+	{
+		return instancesDrawn;
+	}
+	unsigned int ObjectsSkipped()
+	{
+		return objectsSkipped;
+	}
+};
+
+#endif //_GEOMETRY_ARENA_H
@@ -0,0 +1,285 @@
+/*
+Title: Swept AABB-2D
+File Name: Headless.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _HEADLESS_CPP
+#define _HEADLESS_CPP
+
+#include "Headless.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// Older eglext.h files don't have Mesa's surfaceless platform yet.
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+HeadlessContext::HeadlessContext()
+{
+	display = nullptr;
+	context = nullptr;
+	hiddenWindow = nullptr;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+bool HeadlessContext::Create(bool software)
+{
+#ifdef HEADLESS_EGL
+	if (software)
+	{
+		setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+		setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+	}
+
+	// The surfaceless platform needs no X server or GPU device. If the driver doesn't have it, try the default display.
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr)
+	{
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (eglDisplay == EGL_NO_DISPLAY)
+	{
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+	{
+		return false;
+	}
+
+	// Desktop OpenGL, not OpenGL ES. Ask for 4.5 compatibility like a GLFW window would get, then settle for whatever the driver offers.
+	eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint attributes[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 5, EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT, EGL_NONE };
+	EGLContext eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+	if (eglContext == EGL_NO_CONTEXT)
+	{
+		eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, nullptr);
+	}
+
+	if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+	{
+		if (eglContext != EGL_NO_CONTEXT)
+		{
+			eglDestroyContext(eglDisplay, eglContext);
+		}
+		eglTerminate(eglDisplay);
+		return false;
+	}
+
+	display = eglDisplay;
+	context = eglContext;
+	return true;
+#else
+	// Picking the rasterizer is up to the OpenGL driver here (a Mesa opengl32.dll reads GALLIUM_DRIVER itself).
+	(void)software;
+
+	if (!glfwInit())
+	{
+		return false;
+	}
+
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+	hiddenWindow = glfwCreateWindow(64, 64, "headless", nullptr, nullptr);
+	glfwDefaultWindowHints();
+
+	if (hiddenWindow == nullptr)
+	{
+		glfwTerminate();
+		return false;
+	}
+
+	glfwMakeContextCurrent(hiddenWindow);
+	return true;
+#endif
+}
+
+void HeadlessContext::Destroy()
+{
+#ifdef HEADLESS_EGL
+	if (context != nullptr)
+	{
+		eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+		eglTerminate((EGLDisplay)display);
+		context = nullptr;
+		display = nullptr;
+	}
+#else
+	if (hiddenWindow != nullptr)
+	{
+		glfwDestroyWindow(hiddenWindow);
+		glfwTerminate();
+		hiddenWindow = nullptr;
+	}
+#endif
+}
+
+const char* HeadlessContext::Kind()
+{
+#ifdef HEADLESS_EGL
+	return "EGL surfaceless";
+#else
+	return "hidden GLFW window";
+#endif
+}
+
+OffscreenTarget::OffscreenTarget()
+{
+	fbo = 0;
+	color = 0;
+	depth = 0;
+	width = 0;
+	height = 0;
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+	// Like the other GL objects, this has to be destroyed while the context is still around, so Destroy() is called by hand.
+}
+
+bool OffscreenTarget::Create(int inWidth, int inHeight)
+{
+	width = inWidth;
+	height = inHeight;
+
+	glGenRenderbuffers(1, &color);
+	glBindRenderbuffer(GL_RENDERBUFFER, color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	// The scene uses the depth test, so the target needs a depth buffer too.
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return complete;
+}
+
+void OffscreenTarget::Destroy()
+{
+	if (fbo != 0)
+	{
+		glDeleteFramebuffers(1, &fbo);
+		glDeleteRenderbuffers(1, &color);
+		glDeleteRenderbuffers(1, &depth);
+		fbo = 0;
+		color = 0;
+		depth = 0;
+	}
+}
+
+void OffscreenTarget::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, width, height);
+}
+
+void OffscreenTarget::ReadPixels(std::vector<unsigned char>& rgb)
+{
+	rgb.resize((size_t)width * height * 3);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+
+	// OpenGL's first row is the bottom of the image, image files start at the top.
+	size_t rowSize = (size_t)width * 3;
+	std::vector<unsigned char> row(rowSize);
+	for (int y = 0; y < height / 2; y++)
+	{
+		unsigned char* top = &rgb[y * rowSize];
+		unsigned char* bottom = &rgb[(height - 1 - y) * rowSize];
+		std::copy(top, top + rowSize, row.begin());
+		std::copy(bottom, bottom + rowSize, top);
+		std::copy(row.begin(), row.end(), bottom);
+	}
+}
+
+bool OffscreenTarget::SavePPM(const std::string& path)
+{
+	std::vector<unsigned char> rgb;
+	ReadPixels(rgb);
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	bool written = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+	fclose(file);
+
+	return written;
+}
+
+unsigned long long OffscreenTarget::Hash()
+{
+	std::vector<unsigned char> rgb;
+	ReadPixels(rgb);
+
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < rgb.size(); i++)
+	{
+		hash = (hash ^ rgb[i]) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+#endif // _HEADLESS_CPP
@@ -0,0 +1,107 @@
+/*
+Title: Swept AABB-2D
+File Name: Headless.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+
+#include "GLIncludes.h"
+#include <string>
+#include <vector>
+
+// An OpenGL context without a window, for rendering on machines with no display (like build servers).
+// Built with HEADLESS_EGL (CMake turns it on when it finds libEGL), it's an EGL "surfaceless" context, which Mesa provides even with no GPU
+// by drawing with its llvmpipe software rasterizer. Otherwise it falls back to a hidden GLFW window, which still needs a desktop to exist.
+// There is no default framebuffer either way, so draw into an OffscreenTarget.
+class HeadlessContext
+{
+	void* display;
+	void* context;
+	GLFWwindow* hiddenWindow;
+
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	// Creates the context and makes it current. software asks Mesa for llvmpipe even if there is a GPU (so results match the build servers).
+	bool Create(bool software = false);
+	void Destroy();
+
+	// "EGL surfaceless" or "hidden GLFW window", for reports.
+	const char* Kind();
+};
+
+// A framebuffer object with a color and a depth renderbuffer, so we can render and read back pixels without a window.
+class OffscreenTarget
+{
+	GLuint fbo;
+	GLuint color;
+	GLuint depth;
+	int width;
+	int height;
+
+public:
+	OffscreenTarget();
+	~OffscreenTarget();
+
+	// Needs a current context. Returns false if the driver won't accept the framebuffer.
+	bool Create(int inWidth, int inHeight);
+	void Destroy();
+
+	// Draws go to this target (and the viewport covers it) from now on.
+	void Bind();
+
+	// Reads the whole image back as tightly packed RGB, top row first.
+	void ReadPixels(std::vector<unsigned char>& rgb);
+
+	// Writes the image as a binary PPM, which almost any image viewer or diff tool can open.
+	bool SavePPM(const std::string& path);
+
+	// A 64-bit FNV-1a hash of the image, so two runs (or two render paths) can be compared without saving anything.
+	unsigned long long Hash();
+
+	int Width()
+	{
+		return width;
+	}
+	int Height()
+	{
+		return height;
+	}
+};
+
+#endif //_HEADLESS_H
@@ -0,0 +1,50 @@
+/*
+Title: Swept AABB-2D
+File Name: InstancedVertexShader.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard 
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded 
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object 
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless 
+of how fast or slow the computer is running. The Swept portion of this algorithm determines 
+when the collision will actually happen (so if your velocity is 10, and you are a distance 
+of 5 away from the collision, it will detect this) and will perform the collision response 
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the 
+object passes through or into the middle of the colliding object).
+*/
+
+#version 430 core // Multi-draw indirect (used by GeometryArena) needs OpenGL 4.3
+ 
+layout(location = 0) in vec3 in_position;	// Get in a vec3 for position
+layout(location = 1) in vec4 in_color;		// Get in a vec4 for color
+layout(location = 2) in mat4 in_MVP;		// The MVP matrix of this instance. A mat4 takes up locations 2 through 5, and only changes once per instance.
+
+out vec4 color; // Our vec4 color variable containing r, g, b, a
+
+void main(void)
+{
+	color = in_color;	// Pass the color through
+	gl_Position = in_MVP * vec4(in_position, 1.0); //w is 1.0, also notice cast to a vec4
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+/*
+Title: Swept AABB-2D
+File Name: LatencyTracker.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _LATENCY_TRACKER_CPP
+#define _LATENCY_TRACKER_CPP
+
+#include "LatencyTracker.h"
+#include <algorithm>
+
+LatencyTracker::LatencyTracker()
+{
+	useTimerQueries = false;
+	gpuOffset = 0.0;
+
+	ResetStats();
+}
+
+void LatencyTracker::Init(double now)
+{
+	// GL_TIMESTAMP queries came with OpenGL 3.3. Without them we still know when a frame is done from its fence, just less precisely.
+	useTimerQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+
+	Calibrate(now);
+}
+
+void LatencyTracker::Cleanup()
+{
+	for (unsigned int i = 0; i < inFlight.size(); i++)
+	{
+		glDeleteSync(inFlight[i].fence);
+		freeQueries.push_back(inFlight[i].query);
+	}
+	inFlight.clear();
+
+	for (unsigned int i = 0; i < freeQueries.size(); i++)
+	{
+		if (freeQueries[i] != 0)
+		{
+			glDeleteQueries(1, &freeQueries[i]);
+		}
+	}
+	freeQueries.clear();
+}
+
+void LatencyTracker::Calibrate(double now)
+{
+	if (!useTimerQueries)
+	{
+		return;
+	}
+
+	// This reads the GPU's clock as of when all earlier commands have reached the GPU (without waiting for them to run),
+	// which is close enough to "now" for lining up two clocks measured in milliseconds.
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpuOffset = now - gpuNow * 1e-9;
+}
+
+void LatencyTracker::InputReceived(double now)
+{
+	waiting.push_back(now);
+}
+
+void LatencyTracker::InputsConsumed(double now)
+{
+	for (unsigned int i = 0; i < waiting.size(); i++)
+	{
+		InputTimes times;
+		times.received = waiting[i];
+		times.consumed = now;
+		consumed.push_back(times);
+	}
+	waiting.clear();
+}
+
+void LatencyTracker::FrameSubmitted(double submitTime)
+{
+	// Nothing new on screen this frame, so there's nothing to time.
+	if (consumed.empty())
+	{
+		return;
+	}
+
+	// If the GPU is this far behind, wait for the oldest frame instead of piling up more fences.
+	if (inFlight.size() >= MaxFramesInFlight)
+	{
+		PendingFrame& oldest = inFlight.front();
+		glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	}
+
+	PendingFrame pending;
+	pending.submitted = submitTime;
+	pending.inputs.swap(consumed);
+	pending.query = 0;
+
+	if (useTimerQueries)
+	{
+		if (freeQueries.empty())
+		{
+			GLuint query;
+			glGenQueries(1, &query);
+			freeQueries.push_back(query);
+		}
+		pending.query = freeQueries.back();
+		freeQueries.pop_back();
+
+		// Records the GPU's clock once everything before it (this frame's draws and the swap) has finished.
+		glQueryCounter(pending.query, GL_TIMESTAMP);
+	}
+
+	pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	// Without a flush the fence might sit in the driver's queue, and we'd never see it signal without blocking.
+	glFlush();
+
+	inFlight.push_back(pending);
+}
+
+void LatencyTracker::Collect(double now)
+{
+	// Frames finish in order, so stop at the first one that isn't done yet.
+	while (!inFlight.empty())
+	{
+		PendingFrame& oldest = inFlight.front();
+
+		// A timeout of zero just checks without waiting.
+		GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		// The fence says the frame is done, which is no later than now. The timer query says exactly when.
+		double gpuDone = now;
+		if (oldest.query != 0)
+		{
+			GLuint64 gpuTime = 0;
+			glGetQueryObjectui64v(oldest.query, GL_QUERY_RESULT, &gpuTime);
+			gpuDone = gpuTime * 1e-9 + gpuOffset;
+			freeQueries.push_back(oldest.query);
+		}
+
+		glDeleteSync(oldest.fence);
+
+		Finish(oldest, gpuDone);
+		inFlight.pop_front();
+	}
+}
+
+void LatencyTracker::Finish(PendingFrame& done, double gpuDone)
+{
+	// The two clocks can disagree by a little, so don't let that turn into the GPU finishing before the draws were issued.
+	gpuDone = std::max(gpuDone, done.submitted);
+
+	for (unsigned int i = 0; i < done.inputs.size(); i++)
+	{
+		const InputTimes& times = done.inputs[i];
+
+		endToEnd.push_back(gpuDone - times.received);
+		sumToConsume += times.consumed - times.received;
+		sumToSubmit += done.submitted - times.consumed;
+		sumToGPU += gpuDone - done.submitted;
+	}
+}
+
+LatencyReport LatencyTracker::Report()
+{
+	LatencyReport report;
+	report.samples = (unsigned int)endToEnd.size();
+	report.p50Ms = 0.0;
+	report.p99Ms = 0.0;
+	report.inputToConsumeMs = 0.0;
+	report.consumeToSubmitMs = 0.0;
+	report.submitToGPUMs = 0.0;
+	report.gpuTimestamps = useTimerQueries;
+
+	if (endToEnd.empty())
+	{
+		return report;
+	}
+
+	std::vector<double> sorted = endToEnd;
+	std::sort(sorted.begin(), sorted.end());
+
+	report.p50Ms = sorted[sorted.size() / 2] * 1000.0;
+	report.p99Ms = sorted[std::min((size_t)(sorted.size() * 0.99), sorted.size() - 1)] * 1000.0;
+	report.inputToConsumeMs = sumToConsume / sorted.size() * 1000.0;
+	report.consumeToSubmitMs = sumToSubmit / sorted.size() * 1000.0;
+	report.submitToGPUMs = sumToGPU / sorted.size() * 1000.0;
+
+	return report;
+}
+
+void LatencyTracker::ResetStats()
+{
+	endToEnd.clear();
+	sumToConsume = 0.0;
+	sumToSubmit = 0.0;
+	sumToGPU = 0.0;
+}
+
+#endif // _LATENCY_TRACKER_CPP
@@ -0,0 +1,126 @@
+/*
+Title: Swept AABB-2D
+File Name: LatencyTracker.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _LATENCY_TRACKER_H
+#define _LATENCY_TRACKER_H
+
+#include "GLIncludes.h"
+#include <deque>
+#include <vector>
+
+// How long input took to show up on screen, over the inputs since the last ResetStats. All times are in milliseconds.
+struct LatencyReport
+{
+	unsigned int samples;		// Inputs that made it all the way to a finished frame
+	double p50Ms;				// Half of the inputs were on screen within this long
+	double p99Ms;				// 99% of the inputs were on screen within this long
+	double inputToConsumeMs;	// Average wait from the input being polled to something using it (a physics step, or the late latch)
+	double consumeToSubmitMs;	// Average time from using it to the draw calls of the frame showing it being issued
+	double submitToGPUMs;		// Average time from issuing the draws to the GPU finishing them (and the buffer swap)
+	bool gpuTimestamps;			// True if GPU times came from timer queries, false if they're from noticing the fence had signalled (coarser)
+};
+
+// Follows each input from the moment glfwPollEvents hands it to us, through the physics step (or late latch) that used it, to the frame
+// that showed it, and finally to the GPU finishing that frame.
+// Usage, all on the thread with the GL context:
+//     InputReceived(now)         in the GLFW input callbacks
+//     InputsConsumed(now)        when a physics step (or the late latch) applies the waiting inputs to the world
+//     FrameSubmitted(submitTime) after swapping buffers, with the time the draw calls were issued
+//     Collect(now)               once a frame, to pick up frames the GPU has finished without waiting for them
+// A frame only gets a fence and a timer query if it is showing some input, so most frames cost nothing.
+// The time an input spent in the OS's queue before glfwPollEvents, and the monitor's scan-out after the swap, can't be seen from here,
+// so the real latency is this plus at most a frame or two of those.
+class LatencyTracker
+{
+	struct InputTimes
+	{
+		double received;
+		double consumed;
+	};
+
+	struct PendingFrame
+	{
+		GLsync fence;
+		GLuint query;
+		double submitted;
+		std::vector<InputTimes> inputs;
+	};
+
+	// Stop adding fences if the GPU is this many frames behind, since something is badly wrong and the oldest ones get waited on.
+	static const unsigned int MaxFramesInFlight = 8;
+
+	std::vector<double> waiting;		// Received, not used yet
+	std::vector<InputTimes> consumed;	// Used, waiting for a frame to show them
+	std::deque<PendingFrame> inFlight;	// Submitted, waiting for the GPU
+	std::vector<GLuint> freeQueries;
+
+	std::vector<double> endToEnd;
+	double sumToConsume;
+	double sumToSubmit;
+	double sumToGPU;
+
+	bool useTimerQueries;
+	double gpuOffset;	// CPU time minus GPU time, in seconds
+
+	void Finish(PendingFrame&, double gpuDone);
+
+public:
+	LatencyTracker();
+
+	// Call once the GL context is current. now has to come from the same clock as every other time passed in.
+	void Init(double now);
+	void Cleanup();
+
+	// Lines the GPU's timestamp clock up with ours again. Init does this, and it's worth repeating every so often because the two drift.
+	void Calibrate(double now);
+
+	void InputReceived(double now);
+	void InputsConsumed(double now);
+	void FrameSubmitted(double submitTime);
+	void Collect(double now);
+
+	bool HasWaitingInputs()
+	{
+		return !waiting.empty();
+	}
+
+	LatencyReport Report();
+	void ResetStats();
+};
+
+#endif //_LATENCY_TRACKER_H
@@ -39,11 +39,25 @@ object passes through or into the middle of the colliding object).
 #include "GLIncludes.h"
 #include "GLRender.h"
 #include "GameObject.h"
+#include "Benchmark.h"
+#include "Collision.h"
+#include "FramePacer.h"
+#include "LatencyTracker.h"
+#include "Headless.h"
+#include "AssetLoader.h"
+#include "TrajectoryRecorder.h"
+#include "SweptCapture.h"
+#include "PerfCounters.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cmath>
 
 // Variables for FPS and Physics Timestep calculations.
 int frame = 0;
@@ -54,6 +68,59 @@ int fps = 0;
 double FPSTime = 0.0;
 double physicsStep = 0.012; // This is the number of milliseconds we intend for the physics to update.
 
+// Nothing on screen changes between physics steps, so instead of running flat out the main loop waits for the next one.
+// --pacing off|spin|sleep|hybrid picks how it waits, and --fps caps how often it draws (0 means once per physics step).
+FramePacer framePacer(FRAME_PACING_HYBRID);
+double targetFPS = 0.0;
+
+// --latency measures how long input takes to get on screen. --late-latch uses the newest input right before drawing,
+// instead of leaving it for the next physics step (see lateLatch below).
+LatencyTracker latencyTracker;
+bool measureLatency = false;
+bool lateLatch = false;
+
+// --headless [frames] renders that many frames into an offscreen framebuffer instead of opening a window, and reports how long they took (see runHeadless).
+// --dump prefix saves the last frame as prefix.ppm, and with --dump-every N every Nth frame as prefix_00042.ppm as well.
+// --software asks for Mesa's llvmpipe rasterizer even if there is a GPU, and --objects N adds N more squares to draw.
+// --profile times each phase of the frame on the CPU and the GPU (see FrameProfiler.h) and shows it in the title, or prints it after --headless.
+// --trace file.json does the same and also writes every frame to a trace file.
+// --counters adds the CPU's performance counters (cycles, instructions, cache misses, branch misses) to each CPU phase the profiler times,
+// where the system allows it. They're printed after --headless and written to the --trace file.
+std::string tracePath;
+bool profiling = false;
+bool countHardware = false;
+PerfCounters perfCounters;
+
+int headlessFrames = 0;
+std::string dumpPrefix;
+int dumpEvery = 0;
+bool softwareRendering = false;
+unsigned int extraObjects = 0;
+
+// --scene file.scene loads a scene in the background while the demo keeps running, and spawns it once all of its meshes are on the GPU.
+// --upload-budget ms is how long each frame may spend copying loaded meshes to the GPU (see AssetLoader::Update).
+AssetLoader loader(modelRegistry);
+std::string scenePath;
+double uploadBudget = 0.002;
+SceneId scene = 0;
+bool sceneLoading = false;
+
+// --record file.traj writes every object's position and velocity on every physics step to a trajectory file (see TrajectoryRecorder).
+TrajectoryRecorder recorder;
+std::string recordPath;
+
+// --capture-swept file writes the inputs and results of the swept tests to a file the benchmarks can replay (see SweptCapture),
+// keeping about one in every --capture-every N (1 unless given, since the demo only makes one test a step).
+SweptCapture sweptCapture;
+std::string sweptCapturePath;
+unsigned int sweptCaptureEvery = 1;
+
+// Holding the left mouse button drags the first square around. The callbacks only remember where the cursor is, applyInput() does the moving.
+bool dragging = false;
+bool cursorChanged = false;
+double cursorX = 0.0;
+double cursorY = 0.0;
+
 
 
 // Reference to the window object being created by GLFW.
@@ -61,199 +128,130 @@ GLFWwindow* window;
 
 
 
-// Regular AABB collision detection. (Not used in this demo, but should work just fine.)
-bool TestAABB(AABB a, AABB b)
-{
-	// If any axis is separated, exit with no intersection.
-	if (a.max.x < b.min.x || a.min.x > b.max.x) return false;
-	if (a.max.y < b.min.y || a.min.y > b.max.y) return false;
-	
-	// Z-axis is irrelevant because we are in 2D
-	//if (a.max.z < b.min.z || a.min.z > b.max.z) return false;
-	
-	return true;
-}
-
-// Swept AABB collision detection, giving you the time of collision and thus allowing you to even calculate the point of collision and collision responses (such as bounce).
-float SweptAABB(AABB* box1, AABB* box2, glm::vec3 vel1, float& normalx, float& normaly)
+// GLFW calls these from inside glfwPollEvents, which is as early as we can find out about the input.
+void cursorPositionCallback(GLFWwindow*, double x, double y)
 {
-	// These variables stand for the distance in each axis between the moving object and the stationary object in terms of when the moving object would "enter" the colliding object.
-	float xDistanceEntry, yDistanceEntry;
-
-	// These variables stand for the distance in each axis in terms of when the moving object would "exit" the colliding object.
-	float xDistanceExit, yDistanceExit;
+	cursorX = x;
+	cursorY = y;
 
-	// Find the distance between the objects on the near and far sides for both x and y
-	// Depending on the direction of the velocity, we'll reverse the calculation order to maintain the right sign (positive/negative).
-	if (vel1.x > 0.0f)
-	{
-		xDistanceEntry = (*box2).min.x - (*box1).max.x;
-		xDistanceExit = (*box2).max.x - (*box1).min.x;
-	}
-	else
+	if (dragging)
 	{
-		xDistanceEntry = (*box2).max.x - (*box1).min.x;
-		xDistanceExit = (*box2).min.x - (*box1).max.x;
-	}
+		cursorChanged = true;
 
-	if (vel1.y > 0.0f)
-	{
-		yDistanceEntry = (*box2).min.y - (*box1).max.y;
-		yDistanceExit = (*box2).max.y - (*box1).min.y;
+		if (measureLatency)
+		{
+			latencyTracker.InputReceived(glfwGetTime());
+		}
 	}
-	else
+}
+
+void mouseButtonCallback(GLFWwindow*, int button, int action, int)
+{
+	if (button != GLFW_MOUSE_BUTTON_LEFT)
 	{
-		yDistanceEntry = (*box2).max.y - (*box1).min.y;
-		yDistanceExit = (*box2).min.y - (*box1).max.y;
+		return;
 	}
 
-	// These variables stand for the time at which the moving object would enter/exit the stationary object.
-	float xEntryTime, yEntryTime;
-	float xExitTime, yExitTime;
+	dragging = (action == GLFW_PRESS);
 
-	// Find time of collision and time of leaving for each axis (if statement is to prevent divide by zero)
-	if (vel1.x == 0.0f)
+	if (dragging)
 	{
-		// If the largest distance (entry or exit) between the two objects is greater than the size of both objects combined, then the objects are clearly not colliding.
-		if (std::max(fabsf(xDistanceEntry), fabsf(xDistanceExit)) > (((*box1).max.x - (*box1).min.x) + ((*box2).max.x - (*box2).min.x)))
-		{
-			// Setting this to 2.0f will cause an absence of collision later in this function.
-			xEntryTime = 2.0f;
-		}
-		else
+		cursorChanged = true;
+
+		if (measureLatency)
 		{
-			// Otherwise, pass negative infinity to basically ignore this variable.
-			xEntryTime = -std::numeric_limits<float>::infinity();
+			latencyTracker.InputReceived(glfwGetTime());
 		}
-		
-		// Setting this to postivie infinity will ignore this variable.
-		xExitTime = std::numeric_limits<float>::infinity();
 	}
-	else
+}
+
+// Moves the first square to the point on the z = 0 plane under the cursor, if the cursor moved while dragging.
+// A physics step only has to set the position (its AABB gets recalculated with everything else), but the late latch happens
+// after the step, so it teleports the square to put the new AABB straight into the broadphase for view culling.
+void applyInput(bool late)
+{
+	if (!cursorChanged)
 	{
-		// If there is a velocity in the x-axis, then we can determine the time of collision based on the distance divided by the velocity. (Assuming velocity does not change.)
-		xEntryTime = xDistanceEntry / vel1.x;
-		xExitTime = xDistanceExit / vel1.x;
+		return;
 	}
+	cursorChanged = false;
+
+	int width, height;
+	glfwGetWindowSize(window, &width, &height);
 
-	if (vel1.y == 0.0f)
+	glm::vec3 target;
+	if (width > 0 && height > 0 && ViewCuller::PointOnPlane(proj, view, (float)(2.0 * cursorX / width - 1.0), (float)(1.0 - 2.0 * cursorY / height), target))
 	{
-		if (std::max(fabsf(yDistanceEntry), fabsf(yDistanceExit)) > (((*box1).max.y - (*box1).min.y) + ((*box2).max.y - (*box2).min.y)))
+		if (late)
 		{
-			yEntryTime = 2.0f;
+			world.Teleport(obj1, target);
 		}
 		else
 		{
-			yEntryTime = -std::numeric_limits<float>::infinity();
+			world.SetPosition(obj1, target);
 		}
-
-		yExitTime = std::numeric_limits<float>::infinity();
 	}
-	else
-	{
-		yEntryTime = yDistanceEntry / vel1.y;
-		yExitTime = yDistanceExit / vel1.y;
-	}
-
-
-	// Get the maximum entry time to determine the latest collision, which is actually when the objects are colliding. (Because all 3 axes must collide.)
-	float entryTime = std::max(xEntryTime, yEntryTime);
 
-	// Get the minimum exit time to determine when the objects are no longer colliding. (AKA the objects passed through one another.)
-	float exitTime = std::min(xExitTime, yExitTime);
-
-	// If anything in the following statement is true, there's no collision.
-	// If entryTime > exitTime, that means that one of the axes is exiting the "collision" before the other axes are crossing, thus they don't cross the object in unison and there's no collison.
-	// If all three of the entry times are less than zero, then the collision already happened (or we missed it, but either way..)
-	// If any of the entry times are greater than 1.0f, then the collision isn't happening this update/physics step so we'll move on.
-	if (entryTime > exitTime || xEntryTime < 0.0f && yEntryTime < 0.0f  || xEntryTime > 1.0f || yEntryTime > 1.0f)
+	if (measureLatency)
 	{
-		// With no collision, we pass out zero'd normals.
-		normalx = 0.0f;
-		normaly = 0.0f;
-
-		// If collision detection isn't working, try uncommenting the if statement and putting a break point on the std::cout statement.
-		// Then you can check variable values within this algorithm to make sure everything is in order.
-		/*if (glm::distance(obj1->GetPosition(), obj2->GetPosition()) < 0.1)
-		{
-			std::cout << "Something went wrong, and the objects are inside of each other but haven't been detected as a collision.";
-		}*/
-
-		// 2.0f signifies that there was no collision.
-		return 2.0f;
-	}
-	else // If there was a collision
-	{
-		// Calculate normal of collided surface
-		if (xEntryTime > yEntryTime) // If the x-axis is the last to cross, then that is the colliding axis.
-		{
-			if (xDistanceEntry < 0.0f) // Determine the normal based on positive or negative.
-			{
-				normalx = 1.0f;
-				normaly = 0.0f;
-			}
-			else
-			{
-				normalx = -1.0f;
-				normaly = 0.0f;
-			}
-		}
-		else if (yEntryTime > xEntryTime)
-		{
-			if (yDistanceEntry < 0.0f)
-			{
-				normalx = 0.0f;
-				normaly = 1.0f;
-			}
-			else
-			{
-				normalx = 0.0f;
-				normaly = -1.0f;
-			}
-		}
-
-		// Return the time of collision
-		return entryTime;
+		latencyTracker.InputsConsumed(glfwGetTime());
 	}
 }
 
+
+
 // This runs once every physics timestep.
 void update(float dt)
 {
+	// Apply everything other threads asked the world to do since the last step. Nothing else may change the objects until EndStep().
+	// (Don't send Destroy for obj1 or obj2, since this demo keeps using them below.)
+	world.BeginStep();
+
+	// Drag the first square to the cursor, if the left mouse button is down.
+	applyInput(false);
+
 	// This section just checks to make sure the object stays within a certain boundary. This is not really collision detection.
-	glm::vec3 tempPos = obj2->GetPosition();
+	glm::vec3 tempPos = world.GetPosition(obj2);
 	
 	if (fabsf(tempPos.x) > 0.9f)
 	{
-		glm::vec3 tempVel = obj2->GetVelocity();
+		glm::vec3 tempVel = world.GetVelocity(obj2);
 
 		// "Bounce" the velocity along the axis that was over-extended.
-		obj2->SetVelocity(glm::vec3(-1.0f * tempVel.x, tempVel.y, tempVel.z));
+		world.SetVelocity(obj2, glm::vec3(-1.0f * tempVel.x, tempVel.y, tempVel.z));
 	}
 	if (fabsf(tempPos.y) > 0.8f)
 	{
-		glm::vec3 tempVel = obj2->GetVelocity();
-		obj2->SetVelocity(glm::vec3(tempVel.x, -1.0f * tempVel.y, tempVel.z));
+		glm::vec3 tempVel = world.GetVelocity(obj2);
+		world.SetVelocity(obj2, glm::vec3(tempVel.x, -1.0f * tempVel.y, tempVel.z));
 	}
 
-	// Rotate the objects if you'd like, this will show you how the AABB stays aligned on the X and Y axes regardless of the object's orientation.
-	//obj1->Rotate(glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(1.0f)));
-	//obj2->Rotate(glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(1.0f)));
+	// World objects don't rotate, but a GameObject can. Use GameObject::Rotate to see how the AABB stays aligned on the X and Y axes regardless of the object's orientation.
 
 	// Re-calculate the Axis-Aligned Bounding Box for your object.
 	// We do this because if the object's orientation changes, we should update the bounding box as well.
 	// Be warned: For some objects this can actually cause a collision to be missed, so be careful.
 	// (This is because we determine the time of the collision based on the AABB, but if the AABB changes significantly, the time of collision can change between frames,
 	// and if that lines up just right you'll miss the collision altogether.)
-	obj1->CalculateAABB();
-	obj2->CalculateAABB();
+	unsigned int dense1 = world.DenseIndex(obj1);
+	unsigned int dense2 = world.DenseIndex(obj2);
+	world.CalculateAABB(dense1);
+	world.CalculateAABB(dense2);
 
 	// Our normals will be passed out of the SweptAABB algorithm and used to determine where to "bounce" the object.
-	float normalx, normaly;
+	// SweptAABB leaves them alone on a perfect corner hit (both axes crossing at the same moment), so start them at zero to be able to tell.
+	float normalx = 0.0f, normaly = 0.0f;
 
 	// This function requires that the moving object be passed in first, the second object be stationary, and that the velocity refers to the 
 	// velocity of the moving object this frame. For perfection, you should have some sort of physics timestep setup. (See the checkTime() function).
-	float collisionTime = SweptAABB(&obj2->GetAABB(), &obj1->GetAABB(), obj2->GetVelocity() * dt, normalx, normaly);
+	AABB box1 = world.GetAABB(obj1);
+	AABB box2 = world.GetAABB(obj2);
+	float collisionTime = SweptAABB(&box2, &box1, world.GetVelocity(obj2) * dt, normalx, normaly);
+
+	if (sweptCapture.IsOpen())
+	{
+		sweptCapture.OnSweptTest(box2, box1, world.GetVelocity(obj2) * dt, collisionTime, normalx, normaly);
+	}
 	
 	// Since we know we'll collide at collisionTime * dt, we can define that 1.0f - collisionTime is the remaining time this frame after that collision.
 	// Thus, we'll "bounce" off the collided object, then update the rest of the object's movement by remainingTime * dt.
@@ -264,40 +262,370 @@ void update(float dt)
 	if (remainingTime >= 0.0f)
 	{
 		// Create a local velocity variable based off of the moving object's velocity.
-		glm::vec3 velocity = obj2->GetVelocity();
+		glm::vec3 velocity = world.GetVelocity(obj2);
+
+		// A collision with both normals still zero was a perfect corner hit, which bounces along both axes.
+		bool cornerHit = abs(normalx) <= 0.0001f && abs(normaly) <= 0.0001f;
 
 		// If the normal is not some ridiculously small (or zero) value.
-		if (abs(normalx) > 0.0001f)
+		if (abs(normalx) > 0.0001f || cornerHit)
 		{
 			// Bounce the velocity along that axis.
 			velocity.x *= -1;
 		}
-		if (abs(normaly) > 0.0001f)
+		if (abs(normaly) > 0.0001f || cornerHit)
 		{
 			velocity.y *= -1;
 		}
 
 		// Update the objects by the collisionTime * dt (which is the part of the update before it collides with the object).
-		obj1->Update(collisionTime * dt);
-		obj2->Update(collisionTime * dt);
+		world.UpdateObject(dense1, collisionTime * dt);
+		world.UpdateObject(dense2, collisionTime * dt);
 
 		// Then change the velocity to be the "bounced" velocity.
-		obj2->SetVelocity(velocity);
+		world.SetVelocity(obj2, velocity);
 
 		// Now update the objects by the remainingTime * dt (which is the part of the update after the collision).
-		obj1->Update(remainingTime * dt);
-		obj2->Update(remainingTime * dt);
+		world.UpdateObject(dense1, remainingTime * dt);
+		world.UpdateObject(dense2, remainingTime * dt);
 	}
 	else
 	{
 		// No collision, update normally.
-		obj1->Update(dt);
-		obj2->Update(dt);
+		world.UpdateObject(dense1, dt);
+		world.UpdateObject(dense2, dt);
+	}
+
+	// Any other objects in the world just move along with their velocity.
+	for (unsigned int i = 0; i < world.NumObjects(); i++)
+	{
+		if (i != dense1 && i != dense2)
+		{
+			world.UpdateObject(i, dt);
+			world.CalculateAABB(i);
+		}
+	}
+
+	// Now that the parents have moved, move anything attached to them. This has to happen before EndStep(), which puts the new AABBs into the broadphase.
+	sceneGraph.Propagate(world);
+
+	world.EndStep();
+
+	// Hand the step to the recorder's writer thread, if there is one.
+	if (recorder.IsOpen())
+	{
+		recorder.Record(world);
 	}
 
 	// Update your MVP matrices based on the objects' transforms.
-	MVP = PV * *obj1->GetTransform();
-	MVP2 = PV * *obj2->GetTransform();
+	MVP = PV * world.GetTransform(dense1);
+	MVP2 = PV * world.GetTransform(dense2);
+}
+
+// Spreads count more squares over what the camera sees, each drifting in its own direction, so there's more to draw than the two in the demo.
+void spawnObjects(unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	AABB rectangle = ViewCuller::ViewRectangle(proj, view);
+	unsigned int columns = (unsigned int)ceil(sqrt((double)count));
+	unsigned int rows = (count + columns - 1) / columns;
+
+	std::vector<glm::vec3> positions(count);
+	std::vector<glm::vec3> velocities(count);
+	std::vector<glm::vec3> scales(count, glm::vec3(0.02f, 0.02f, 0.02f));
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float x = rectangle.min.x + (rectangle.max.x - rectangle.min.x) * ((i % columns) + 0.5f) / columns;
+		float y = rectangle.min.y + (rectangle.max.y - rectangle.min.y) * ((i / columns) + 0.5f) / rows;
+		positions[i] = glm::vec3(x, y, 0.0f);
+		velocities[i] = glm::vec3(cosf((float)i), sinf((float)i), 0.0f) * 0.05f;
+	}
+
+	world.SpawnBulk(count, square, positions.data(), velocities.data(), scales.data(), nullptr);
+}
+
+// Starts the loader threads and has them read the --scene file, if there is one.
+void startLoading()
+{
+	if (scenePath.empty())
+	{
+		return;
+	}
+
+	// The arena copies each model's vertices when the scene is added to it. The other paths draw from the models' own buffers,
+	// so there the CPU copies can go once they're uploaded.
+	loader.SetDropCPUData(renderPath != RENDER_PATH_ARENA);
+	loader.Init();
+	scene = loader.LoadScene(scenePath);
+	sceneLoading = true;
+}
+
+// Once a frame: uploads a little more of whatever the loader threads have finished, and spawns the scene once it's all there.
+void updateLoading()
+{
+	if (!sceneLoading)
+	{
+		return;
+	}
+
+	profiler.BeginCPU("upload");
+	loader.Update(uploadBudget);
+	profiler.EndCPU();
+
+	AssetState state = loader.SceneState(scene);
+	if (state == ASSET_FAILED)
+	{
+		std::cout << "Couldn't load " << scenePath << ": " << loader.SceneError(scene) << std::endl;
+		sceneLoading = false;
+		return;
+	}
+	if (state != ASSET_READY)
+	{
+		return;
+	}
+
+	unsigned int spawned = loader.SpawnScene(scene, world);
+
+	// The arena draws from its own copy of every model, so the new ones have to go in it too. The other paths use the models' own buffers.
+	if (renderPath == RENDER_PATH_ARENA)
+	{
+		std::vector<AssetId> meshes = loader.SceneMeshes(scene);
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			arena->Add(loader.GetModel(meshes[i]));
+		}
+		arena->Upload();
+	}
+
+	ModelRegistryStats models = modelRegistry.Stats();
+	std::cout << "Loaded " << scenePath << ": " << spawned << " objects, " << models.uniqueModels << " different models (" << models.hits << " meshes shared, "
+		<< models.bytesShared / 1024 << " KB not duplicated)" << std::endl;
+	sceneLoading = false;
+}
+
+// Opens the --record and --capture-swept files, if there are any.
+void startRecording()
+{
+	if (!recordPath.empty() && !recorder.Open(recordPath))
+	{
+		std::cout << "Couldn't create " << recordPath << std::endl;
+	}
+	if (!sweptCapturePath.empty() && !sweptCapture.Open(sweptCapturePath, sweptCaptureEvery))
+	{
+		std::cout << "Couldn't create " << sweptCapturePath << std::endl;
+	}
+}
+
+// Writes out the rest of the recordings and says how they went.
+void stopRecording()
+{
+	if (sweptCapture.IsOpen())
+	{
+		sweptCapture.Close();
+		printf("Captured %llu of %llu swept tests to %s\n", sweptCapture.Samples(), sweptCapture.Tests(), sweptCapturePath.c_str());
+	}
+
+	if (!recorder.IsOpen())
+	{
+		return;
+	}
+
+	recorder.Close();
+
+	TrajectoryRecorderStats stats = recorder.Stats();
+	printf("Recorded %llu steps to %s (%llu dropped): %.1f MB, %.1fx smaller than uncompressed\n", stats.ticksRecorded, recordPath.c_str(), stats.ticksDropped,
+		stats.fileBytes / 1.0e6, stats.fileBytes > 0 ? (double)stats.rawBytes / stats.fileBytes : 0.0);
+}
+
+// Has the profiler read the CPU's counters too, with --counters. They count this thread, so this has to be the one running the frame loop.
+void startCounters()
+{
+	if (!countHardware)
+	{
+		return;
+	}
+
+	if (perfCounters.Open())
+	{
+		profiler.SetCounters(&perfCounters);
+	}
+	else
+	{
+		std::cout << "The CPU's performance counters aren't available here (see PerfCounters.h)." << std::endl;
+	}
+}
+
+// Prints the mean, median, 99th percentile and worst of a list of times (in seconds) as one row of a table, in milliseconds.
+void printFrameTimes(const char* name, std::vector<double> times)
+{
+	if (times.empty())
+	{
+		printf("%-24s %10s\n", name, "n/a");
+		return;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < times.size(); i++)
+	{
+		sum += times[i];
+	}
+
+	printf("%-24s %10.3f %10.3f %10.3f %10.3f\n", name, sum / times.size() * 1000.0, times[times.size() / 2] * 1000.0,
+		times[std::min((size_t)(times.size() * 0.99), times.size() - 1)] * 1000.0, times.back() * 1000.0);
+}
+
+// Renders headlessFrames frames into an OffscreenTarget with no window, stepping the physics by exactly one step per frame so that
+// every run draws the same pictures. Prints the CPU time spent issuing each frame's draws, how long the GPU (or llvmpipe) spent on them,
+// the draw calls, and a hash of the last frame, which should only change when what's drawn changes.
+int runHeadless()
+{
+	HeadlessContext context;
+	if (!context.Create(softwareRendering))
+	{
+		std::cout << "Couldn't create a headless OpenGL context." << std::endl;
+		return 1;
+	}
+
+	if (!init())
+	{
+		return 1;
+	}
+	spawnObjects(extraObjects);
+	startLoading();
+	startRecording();
+
+	if (!tracePath.empty() && !profiler.OpenTrace(tracePath))
+	{
+		std::cout << "Couldn't create " << tracePath << std::endl;
+	}
+	startCounters();
+
+	OffscreenTarget target;
+	if (!target.Create(800, 600))
+	{
+		std::cout << "Couldn't create the offscreen framebuffer." << std::endl;
+		stopRecording();
+		loader.Cleanup();
+		cleanup();
+		return 1;
+	}
+	target.Bind();
+
+	std::cout << "Rendering " << headlessFrames << " frames of " << world.NumObjects() << " objects offscreen (" << context.Kind() << ", "
+		<< glGetString(GL_RENDERER) << ")" << std::endl;
+
+	// The profiler times the GPU passes with GL_TIME_ELAPSED queries (OpenGL 3.3). On llvmpipe those only cover queueing the commands up,
+	// because the actual drawing happens on its worker threads when the frame is flushed. So with software rendering, the glFinish wait
+	// is the GPU time to look at.
+	profiler.SetEnabled(true);
+
+	std::vector<double> submitTimes;
+	std::vector<double> finishTimes;
+	unsigned long long totalDrawCalls = 0;
+
+	// Frame -1 is a warm-up that isn't counted: the driver compiles the shaders for real and allocates its buffers on the first draw.
+	for (int f = -1; f < headlessFrames; f++)
+	{
+		profiler.BeginFrame();
+
+		updateLoading();
+
+		profiler.BeginCPU("physics");
+		update((float)physicsStep);
+		profiler.EndCPU();
+
+		profiler.BeginCPU("render");
+		double start = FramePacer::Now();
+		renderScene();
+		double submitted = FramePacer::Now();
+		profiler.EndCPU();
+
+		profiler.EndFrame();
+
+		// Wait for the frame to be finished, so each frame's GPU time is its own. A real frame loop wouldn't, but this is about measuring.
+		glFinish();
+		double finished = FramePacer::Now();
+
+		// Nothing is waiting on the GPU any more, so this picks up the frame we just drew.
+		profiler.Collect();
+
+		if (f < 0)
+		{
+			profiler.ResetSummary();
+			continue;
+		}
+
+		submitTimes.push_back(submitted - start);
+		finishTimes.push_back(finished - submitted);
+		totalDrawCalls += drawCalls;
+
+		if (!dumpPrefix.empty() && dumpEvery > 0 && f % dumpEvery == 0)
+		{
+			char suffix[32];
+			snprintf(suffix, sizeof(suffix), "_%05d.ppm", f);
+			target.SavePPM(dumpPrefix + suffix);
+		}
+	}
+
+	printf("\n%-24s %10s %10s %10s %10s\n", "per frame", "mean ms", "p50 ms", "p99 ms", "max ms");
+	printFrameTimes("CPU submit", submitTimes);
+	printFrameTimes("GPU (glFinish wait)", finishTimes);
+
+	std::vector<PhaseSummary> phases = profiler.Summary();
+	printf("\n%-24s %10s %10s\n", "phase", "mean ms", "max ms");
+	for (unsigned int i = 0; i < phases.size(); i++)
+	{
+		std::string name = std::string(phases[i].gpu ? "GPU " : "CPU ") + phases[i].name;
+		printf("%-24s %10.3f %10.3f\n", name.c_str(), phases[i].meanMs, phases[i].maxMs);
+	}
+
+	// What the CPU was doing in each phase, per frame, and for physics per object as well, since that's what it loops over.
+	if (profiler.HasCounters())
+	{
+		printf("\n%-24s %14s %8s %12s %12s %14s\n", "phase per frame", "cycles", "IPC", "L1D misses", "LLC misses", "branch misses");
+		for (unsigned int i = 0; i < phases.size(); i++)
+		{
+			if (phases[i].gpu || phases[i].frames == 0)
+			{
+				continue;
+			}
+
+			const PerfCounts& counts = phases[i].counts;
+			double frames = phases[i].frames;
+			printf("CPU %-20s %14.0f %8.2f %12.0f %12.0f %14.0f\n", phases[i].name, counts[PERF_CYCLES] / frames,
+				counts[PERF_CYCLES] > 0 ? (double)counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES] : 0.0,
+				counts[PERF_L1D_MISSES] / frames, counts[PERF_LLC_MISSES] / frames, counts[PERF_BRANCH_MISSES] / frames);
+
+			if (strcmp(phases[i].name, "physics") == 0 && world.NumObjects() > 0)
+			{
+				double objects = frames * world.NumObjects();
+				printf("%-24s %14.1f %8s %12.3f %12.3f %14.3f\n", "  per object", counts[PERF_CYCLES] / objects, "",
+					counts[PERF_L1D_MISSES] / objects, counts[PERF_LLC_MISSES] / objects, counts[PERF_BRANCH_MISSES] / objects);
+			}
+		}
+	}
+
+	printf("\nDraw calls per frame: %.1f\n", headlessFrames > 0 ? (double)totalDrawCalls / headlessFrames : 0.0);
+	printf("Last frame hash: %016llx\n", target.Hash());
+
+	if (!dumpPrefix.empty() && !target.SavePPM(dumpPrefix + ".ppm"))
+	{
+		std::cout << "Couldn't write " << dumpPrefix << ".ppm" << std::endl;
+	}
+
+	target.Destroy();
+	stopRecording();
+	loader.Cleanup();
+	cleanup();
+
+	return 0;
 }
 
 // This runs once every frame to determine the FPS and how often to call update based on the physics step.
@@ -324,6 +652,46 @@ void checkTime()
 
 			std::string s = "FPS: " + std::to_string(fps); // This just creates a string that looks like "FPS: 60" or however much.
 
+			// How much CPU waiting between frames saves, and how steady the frame times are for it.
+			if (framePacer.Mode() != FRAME_PACING_OFF)
+			{
+				FramePacingReport pacing = framePacer.Report(targetFPS > 0.0 ? std::max(physicsStep, 1.0 / targetFPS) : physicsStep);
+				s += " | CPU: " + std::to_string((int)pacing.cpuPercent) + "%, jitter: " + std::to_string(pacing.jitterMs) + " ms";
+			}
+
+			// The pacer keeps every frame's time until this, even with pacing off, so reset it whatever the mode or it grows for the whole session.
+			framePacer.ResetStats();
+
+			// On the render queue path, also show how much drawing and state changing the last frame did.
+			if (renderPath == RENDER_PATH_UNIFORM)
+			{
+				const RenderQueueStats& stats = renderQueue.Stats();
+				s += " | draws: " + std::to_string(stats.draws) + ", program changes: " + std::to_string(stats.programChanges) + ", model changes: " + std::to_string(stats.modelChanges);
+			}
+
+			// Where the last second's frames went, CPU phases then GPU passes.
+			if (profiler.Enabled())
+			{
+				std::vector<PhaseSummary> phases = profiler.Summary();
+				for (unsigned int i = 0; i < phases.size(); i++)
+				{
+					s += std::string(i == 0 ? " | " : ", ") + (phases[i].gpu ? "GPU " : "") + phases[i].name + ": " + std::to_string(phases[i].meanMs) + " ms";
+				}
+				profiler.ResetSummary();
+			}
+
+			// How long dragging the square took to show up on screen over the last second.
+			if (measureLatency)
+			{
+				LatencyReport latency = latencyTracker.Report();
+				if (latency.samples > 0)
+				{
+					s += " | latency p50: " + std::to_string(latency.p50Ms) + " ms, p99: " + std::to_string(latency.p99Ms) + " ms";
+				}
+				latencyTracker.ResetStats();
+				latencyTracker.Calibrate(glfwGetTime());
+			}
+
 			glfwSetWindowTitle(window, s.c_str()); // This will set the window title to that string, displaying the FPS as the window title.
 		}
 
@@ -343,7 +711,9 @@ void checkTime()
 		// leftover time and use it in the next checkTime() call.
 		while (accumulator >= physicsStep)
 		{
+			profiler.BeginCPU("physics");
 			update(physicsStep);
+			profiler.EndCPU();
 
 			accumulator -= physicsStep;
 		}
@@ -354,6 +724,138 @@ void checkTime()
 
 int main(int argc, char **argv)
 {
+	// Passing --bench runs the benchmarks instead of opening the demo window.
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--bench")
+		{
+			return runBenchmarks(argc, argv);
+		}
+
+		// --render uniform|arena|pulling picks how the world is drawn (see RenderPath in GLRender.h).
+		if (std::string(argv[i]) == "--render" && i + 1 < argc)
+		{
+			std::string path = argv[i + 1];
+			if (path == "uniform")
+			{
+				renderPath = RENDER_PATH_UNIFORM;
+			}
+			else if (path == "arena")
+			{
+				renderPath = RENDER_PATH_ARENA;
+			}
+			else if (path == "pulling")
+			{
+				renderPath = RENDER_PATH_PULLING;
+			}
+		}
+
+		if (std::string(argv[i]) == "--pacing" && i + 1 < argc)
+		{
+			std::string pacing = argv[i + 1];
+			if (pacing == "off")
+			{
+				framePacer.SetMode(FRAME_PACING_OFF);
+			}
+			else if (pacing == "spin")
+			{
+				framePacer.SetMode(FRAME_PACING_SPIN);
+			}
+			else if (pacing == "sleep")
+			{
+				framePacer.SetMode(FRAME_PACING_SLEEP);
+			}
+			else if (pacing == "hybrid")
+			{
+				framePacer.SetMode(FRAME_PACING_HYBRID);
+			}
+		}
+
+		if (std::string(argv[i]) == "--fps" && i + 1 < argc)
+		{
+			targetFPS = atof(argv[i + 1]);
+		}
+
+		// --no-cull draws every object, even the ones outside the camera's view.
+		if (std::string(argv[i]) == "--no-cull")
+		{
+			viewCulling = false;
+		}
+
+		if (std::string(argv[i]) == "--latency")
+		{
+			measureLatency = true;
+		}
+		if (std::string(argv[i]) == "--late-latch")
+		{
+			lateLatch = true;
+		}
+
+		if (std::string(argv[i]) == "--profile")
+		{
+			profiling = true;
+		}
+		if (std::string(argv[i]) == "--counters")
+		{
+			countHardware = true;
+		}
+		if (std::string(argv[i]) == "--trace" && i + 1 < argc)
+		{
+			tracePath = argv[i + 1];
+		}
+
+		if (std::string(argv[i]) == "--headless")
+		{
+			headlessFrames = 300;
+			if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0]))
+			{
+				headlessFrames = atoi(argv[i + 1]);
+			}
+		}
+		if (std::string(argv[i]) == "--dump" && i + 1 < argc)
+		{
+			dumpPrefix = argv[i + 1];
+		}
+		if (std::string(argv[i]) == "--dump-every" && i + 1 < argc)
+		{
+			dumpEvery = atoi(argv[i + 1]);
+		}
+		if (std::string(argv[i]) == "--software")
+		{
+			softwareRendering = true;
+		}
+		if (std::string(argv[i]) == "--objects" && i + 1 < argc)
+		{
+			extraObjects = (unsigned int)atoi(argv[i + 1]);
+		}
+		if (std::string(argv[i]) == "--scene" && i + 1 < argc)
+		{
+			scenePath = argv[i + 1];
+		}
+		if (std::string(argv[i]) == "--upload-budget" && i + 1 < argc)
+		{
+			uploadBudget = atof(argv[i + 1]) / 1000.0;
+		}
+		if (std::string(argv[i]) == "--record" && i + 1 < argc)
+		{
+			recordPath = argv[i + 1];
+		}
+		if (std::string(argv[i]) == "--capture-swept" && i + 1 < argc)
+		{
+			sweptCapturePath = argv[i + 1];
+		}
+		if (std::string(argv[i]) == "--capture-every" && i + 1 < argc)
+		{
+			sweptCaptureEvery = (unsigned int)atoi(argv[i + 1]);
+		}
+	}
+
+	// No window at all in headless mode.
+	if (headlessFrames > 0)
+	{
+		return runHeadless();
+	}
+
 	// Initializes the GLFW library
 	glfwInit();
 
@@ -371,28 +873,98 @@ int main(int argc, char **argv)
 	glfwSwapInterval(0);
 
 	// Initializes most things needed before the main loop
-	init();
+	if (!init())
+	{
+		glfwTerminate();
+		return 1;
+	}
+
+	spawnObjects(extraObjects);
+	startLoading();
+	startRecording();
+
+	profiler.SetEnabled(profiling);
+	if (!tracePath.empty() && !profiler.OpenTrace(tracePath))
+	{
+		std::cout << "Couldn't create " << tracePath << std::endl;
+	}
+	startCounters();
+
+	glfwSetCursorPosCallback(window, cursorPositionCallback);
+	glfwSetMouseButtonCallback(window, mouseButtonCallback);
+
+	if (measureLatency)
+	{
+		latencyTracker.Init(glfwGetTime());
+	}
 
 	// Enter the main loop.
+	double lastFrameStart = 0.0;
 	while (!glfwWindowShouldClose(window))
 	{
+		lastFrameStart = glfwGetTime();
+
+		profiler.BeginFrame();
+
+		// Upload a bit more of the scene being loaded, if there is one, and spawn it once it's done.
+		updateLoading();
+
 		// Call to checkTime() which will determine how to go about updating via a set physics timestep as well as calculating FPS.
 		checkTime();
 
+		// The late latch: look for input one last time and put it in the world right before drawing, so it's on screen this frame
+		// instead of waiting for the next physics step. It's the same trick VR uses to get the newest head position into the frame.
+		if (lateLatch)
+		{
+			glfwPollEvents();
+			applyInput(true);
+		}
+
 		// Call the render function.
+		profiler.BeginCPU("render");
 		renderScene();
+		profiler.EndCPU();
+		double submitTime = glfwGetTime();
 
 		// Swaps the back buffer to the front buffer
 		// Remember, you're rendering to the back buffer, then once rendering is complete, you're moving the back buffer to the front so it can be displayed.
+		profiler.BeginCPU("swap");
+		profiler.BeginGPU("swap");
 		glfwSwapBuffers(window);
+		profiler.EndGPU();
+		profiler.EndCPU();
+
+		profiler.EndFrame();
+
+		// Pick up the GPU times of frames from a few frames ago that are ready by now.
+		profiler.Collect();
+
+		// Put a fence after this frame if it shows some input, and pick up any earlier frames the GPU has finished since.
+		if (measureLatency)
+		{
+			latencyTracker.FrameSubmitted(submitTime);
+			latencyTracker.Collect(glfwGetTime());
+		}
 
 		// Add one to our frame counter, since we've successfully 
 		frame++;
 
 		// Checks to see if any events are pending and then processes them.
 		glfwPollEvents();
+
+		// Wait for the next physics step (or the next frame at --fps, if that's later), since drawing again before then would draw the same picture.
+		double deadline = timebase + physicsStep;
+		if (targetFPS > 0.0)
+		{
+			deadline = std::max(deadline, lastFrameStart + 1.0 / targetFPS);
+		}
+		framePacer.WaitFor(deadline - glfwGetTime());
+		framePacer.FrameDone();
 	}
 
+	latencyTracker.Cleanup();
+	stopRecording();
+	loader.Cleanup();
 	cleanup();
 
 	return 0;
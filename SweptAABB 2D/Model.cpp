@@ -39,16 +39,35 @@ object passes through or into the middle of the colliding object).
 #define _MODEL_CPP
 
 #include "Model.h"
+#include <algorithm>
+#include <vector>
 
 // Creates a new model with a given vertices and indices.
 // If no vertices are passed in (numVerts = 0) then it will skip initialization completely.
 // If no indices are passed in (numInds = 0) but vertices are, it will set the indices equal to the vertices in order. (So just 0, 1, 2, 3, 4, etc.)
-Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
+Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds, VertexLayout vertexLayout, bool initBuffer)
 {
+	layout = vertexLayout;
+	indexType = GL_UNSIGNED_INT;
+
+	// Start empty, so a model without vertices (or without buffers yet) can still be destroyed safely.
+	numVertices = 0;
+	vertices = nullptr;
+	numIndices = 0;
+	indices = nullptr;
+	ownsVertices = false;
+	ownsIndices = false;
+	vbo = 0;
+	ebo = 0;
+	localMin = glm::vec3(0.0f);
+	localMax = glm::vec3(0.0f);
+
 	if (numVerts > 0)
 	{
 		// Allocate space for the size of the vertices array.
 		vertices = (VertexFormat*)malloc(sizeof(VertexFormat) * numVerts);
+		ownsVertices = true;
+		ownsIndices = true;
 
 		// Copy the data from the passed in verts to the vertices array.
 		memcpy(vertices, verts, sizeof(VertexFormat) * numVerts);
@@ -82,22 +101,211 @@ Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
 			numIndices = numVerts;
 		}
 
-		// Initialize the buffer.
+		CalculateBounds();
+		CalculateHull();
+
+		// Initialize the buffer, unless whoever made us will do it later on the thread with the OpenGL context.
+		if (initBuffer)
+		{
+			InitBuffer();
+		}
+	}
+}
+
+Model::Model(ModelSpan<VertexFormat> verts, ModelSpan<GLuint> inds, ModelDataRelease release, VertexLayout vertexLayout, bool initBuffer)
+{
+	layout = vertexLayout;
+	indexType = GL_UNSIGNED_INT;
+	vbo = 0;
+	ebo = 0;
+	localMin = glm::vec3(0.0f);
+	localMax = glm::vec3(0.0f);
+
+	// Point straight at the caller's data. Nothing is copied, so the model costs no extra memory on top of wherever the data already lives.
+	numVertices = verts.data != nullptr ? verts.count : 0;
+	vertices = numVertices > 0 ? verts.data : nullptr;
+	numIndices = inds.data != nullptr ? inds.count : 0;
+	indices = numIndices > 0 ? inds.data : nullptr;
+	ownsVertices = false;
+	ownsIndices = false;
+	releaseData = release;
+
+	if (numVertices == 0)
+	{
+		numIndices = 0;
+		indices = nullptr;
+		return;
+	}
+
+	// Without indices we still need one per vertex, and those are ours.
+	if (numIndices == 0)
+	{
+		indices = (GLuint*)malloc(sizeof(GLuint) * numVertices);
+		for (int i = 0; i < numVertices; i++)
+		{
+			indices[i] = i;
+		}
+		numIndices = numVertices;
+		ownsIndices = true;
+	}
+
+	CalculateBounds();
+	CalculateHull();
+
+	if (initBuffer)
+	{
 		InitBuffer();
 	}
 }
 
 Model::~Model()
 {
-	// Free up any remaining data.
-	free(vertices);
-	free(indices);
+	// Free up any remaining data (or hand it back to whoever it came from).
+	FreeData();
 
 	numVertices = 0;
 	numIndices = 0;
 
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo);
+	// A model that never got its buffers may be deleted on a thread without an OpenGL context (see ModelRegistry::Intern), so don't call OpenGL at all then.
+	if (vbo != 0)
+	{
+		glDeleteBuffers(1, &vbo);
+		glDeleteBuffers(1, &ebo);
+	}
+}
+
+void Model::FreeData()
+{
+	if (ownsVertices)
+	{
+		free(vertices);
+	}
+	if (ownsIndices)
+	{
+		free(indices);
+	}
+	if (releaseData)
+	{
+		releaseData();
+		releaseData = ModelDataRelease();
+	}
+
+	vertices = nullptr;
+	indices = nullptr;
+	ownsVertices = false;
+	ownsIndices = false;
+}
+
+void Model::OwnData()
+{
+	if (vertices != nullptr && !ownsVertices)
+	{
+		VertexFormat* copy = (VertexFormat*)malloc(sizeof(VertexFormat) * numVertices);
+		memcpy(copy, vertices, sizeof(VertexFormat) * numVertices);
+		vertices = copy;
+		ownsVertices = true;
+	}
+	if (indices != nullptr && !ownsIndices)
+	{
+		GLuint* copy = (GLuint*)malloc(sizeof(GLuint) * numIndices);
+		memcpy(copy, indices, sizeof(GLuint) * numIndices);
+		indices = copy;
+		ownsIndices = true;
+	}
+
+	// Both are copies now, so the originals can go.
+	if (releaseData)
+	{
+		releaseData();
+		releaseData = ModelDataRelease();
+	}
+}
+
+// Which side of the line from a to b the point c is on: positive if turning left, negative if right, 0 if they're in a line.
+// Done in doubles, so that points that are nearly in a line aren't put on the wrong side by rounding.
+static double cross(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+	return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+void Model::CalculateHull()
+{
+	hullX.clear();
+	hullY.clear();
+	hullZ.clear();
+
+	bool flat = true;
+	for (int i = 1; i < numVertices && flat; i++)
+	{
+		flat = vertices[i].position.z == vertices[0].position.z;
+	}
+
+	std::vector<glm::vec3> points;
+	points.reserve(numVertices);
+	for (int i = 0; i < numVertices; i++)
+	{
+		points.push_back(vertices[i].position);
+	}
+
+	if (flat && numVertices > 2)
+	{
+		// Andrew's monotone chain: sort the points left to right, then build the lower and upper halves of the hull, dropping any point
+		// that would make a right turn (or a straight line, since a point in the middle of an edge is never the furthest in any direction).
+		std::sort(points.begin(), points.end(), [](const glm::vec3& a, const glm::vec3& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+
+		std::vector<glm::vec3> hull(2 * points.size());
+		size_t k = 0;
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0)
+			{
+				k--;
+			}
+			hull[k++] = points[i];
+		}
+		for (size_t i = points.size() - 1, lower = k + 1; i > 0; i--)
+		{
+			while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0.0)
+			{
+				k--;
+			}
+			hull[k++] = points[i - 1];
+		}
+
+		// The last point is the first one again. (If every point was the same, k is 1 and that one point is the whole hull.)
+		hull.resize(k > 1 ? k - 1 : k);
+		points.swap(hull);
+	}
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		hullX.push_back(points[i].x);
+		hullY.push_back(points[i].y);
+		hullZ.push_back(points[i].z);
+	}
+}
+
+bool Model::DropCPUData()
+{
+	if (vbo == 0)
+	{
+		return false;
+	}
+
+	FreeData();
+	return true;
+}
+
+void Model::CalculateBounds()
+{
+	localMin = vertices[0].position;
+	localMax = vertices[0].position;
+
+	for (int i = 1; i < numVertices; i++)
+	{
+		localMin = glm::min(localMin, vertices[i].position);
+		localMax = glm::max(localMax, vertices[i].position);
+	}
 }
 
 void Model::InitBuffer()
@@ -118,15 +326,37 @@ void Model::InitBuffer()
 	//// GL_ELEMENT_ARRAY_BUFFER is for vertex array indices, all drawing commands of glDrawElements will use indices from that buffer.
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 
-	//// Creates and initializes a buffer object's data.
-	//// First parameter is the target, second parameter is the size of the buffer, third parameter is a pointer to the data that will copied into the buffer, and fourth parameter is the 
-	//// expected usage pattern of the data. Possible usage patterns: GL_STREAM_DRAW, GL_STREAM_READ, GL_STREAM_COPY, GL_STATIC_DRAW, GL_STATIC_READ, GL_STATIC_COPY, GL_DYNAMIC_DRAW, 
-	//// GL_DYNAMIC_READ, or GL_DYNAMIC_COPY
-	//// Stream means that the data will be modified once, and used only a few times at most. Static means that the data will be modified once, and used a lot. Dynamic means that the data 
-	//// will be modified repeatedly, and used a lot. Draw means that the data is modified by the application, and used as a source for GL drawing. Read means the data is modified by 
-	//// reading data from GL, and used to return that data when queried by the application. Copy means that the data is modified by reading from the GL, and used as a source for drawing.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * numVertices, vertices, GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * numIndices, indices, GL_STATIC_DRAW);
+	//// Fills both buffers with our vertices and indices, packed into the layout this model uses. See FillBuffers below.
+	FillBuffers();
+
+	//// Tells OpenGL how to read a vertex. See SetupAttributes below.
+	SetupAttributes();
+}
+
+void Model::SetupAttributes()
+{
+	if (layout == VERTEX_LAYOUT_COMPACT)
+	{
+		//// Position is 2 floats at the start of the vertex. The shader's in_position is a vec3, and OpenGL fills in z = 0.0 for us.
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(VertexFormatCompact), (void*)0);
+
+		//// Color is 4 unsigned bytes right after the position. Setting normalized to GL_TRUE turns 0 - 255 into 0.0 - 1.0, so the shader still sees a vec4 of floats.
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VertexFormatCompact), (void*)8);
+		return;
+	}
+
+	if (layout == VERTEX_LAYOUT_HALF)
+	{
+		//// Same as the compact layout, but the position is two 16-bit half floats, which the GPU converts to full floats for us.
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexFormatHalf), (void*)0);
+
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VertexFormatHalf), (void*)4);
+		return;
+	}
 
 	//// By default, all client-side capabilities are disabled, including all generic vertex attribute arrays.
 	//// When enabled, the values in a generic vertex attribute array will be accessed and used for rendering when calls are made to vertex array commands (like glDrawArrays/glDrawElements)
@@ -151,6 +381,136 @@ void Model::InitBuffer()
 
 void Model::UpdateBuffer()
 {
+	// Nothing to fill them with once the CPU copy is gone (see DropCPUData).
+	if (vertices == nullptr)
+	{
+		return;
+	}
+
+	FillBuffers();
+}
+
+int Model::VertexStride(VertexLayout vertexLayout)
+{
+	switch (vertexLayout)
+	{
+	case VERTEX_LAYOUT_COMPACT:
+		return sizeof(VertexFormatCompact);
+	case VERTEX_LAYOUT_HALF:
+		return sizeof(VertexFormatHalf);
+	default:
+		return sizeof(VertexFormat);
+	}
+}
+
+void Model::Stage(ModelStaging& staging)
+{
+	staging.indexType = numVertices <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	staging.vertexBytes.resize((size_t)VertexStride(layout) * numVertices);
+	unsigned char* vertexOut = staging.vertexBytes.data();
+
+	// The same packing as FillBuffers, written straight into the staging bytes.
+	if (layout == VERTEX_LAYOUT_COMPACT)
+	{
+		VertexFormatCompact* compact = (VertexFormatCompact*)vertexOut;
+		for (int i = 0; i < numVertices; i++)
+		{
+			compact[i].position = glm::vec2(vertices[i].position);
+			compact[i].color = glm::packUnorm4x8(vertices[i].color);
+		}
+	}
+	else if (layout == VERTEX_LAYOUT_HALF)
+	{
+		VertexFormatHalf* half = (VertexFormatHalf*)vertexOut;
+		for (int i = 0; i < numVertices; i++)
+		{
+			half[i].position[0] = glm::packHalf1x16(vertices[i].position.x);
+			half[i].position[1] = glm::packHalf1x16(vertices[i].position.y);
+			half[i].color = glm::packUnorm4x8(vertices[i].color);
+		}
+	}
+	else if (numVertices > 0)
+	{
+		memcpy(vertexOut, vertices, sizeof(VertexFormat) * numVertices);
+	}
+
+	if (staging.indexType == GL_UNSIGNED_SHORT)
+	{
+		staging.indexBytes.resize(sizeof(GLushort) * numIndices);
+		GLushort* shortIndices = (GLushort*)staging.indexBytes.data();
+		for (int i = 0; i < numIndices; i++)
+		{
+			shortIndices[i] = (GLushort)indices[i];
+		}
+	}
+	else
+	{
+		staging.indexBytes.resize(sizeof(GLuint) * numIndices);
+		memcpy(staging.indexBytes.data(), indices, sizeof(GLuint) * numIndices);
+	}
+}
+
+void Model::CreateBuffers(const ModelStaging& staging, bool fill)
+{
+	indexType = staging.indexType;
+
+	if (vbo == 0)
+	{
+		glGenBuffers(1, &vbo);
+		glGenBuffers(1, &ebo);
+	}
+
+	// Both go through GL_ARRAY_BUFFER. A buffer can be filled through any binding point, and binding GL_ELEMENT_ARRAY_BUFFER here would change
+	// whichever vertex array object happens to be bound.
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, staging.vertexBytes.size(), fill ? staging.vertexBytes.data() : nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ARRAY_BUFFER, staging.indexBytes.size(), fill ? staging.indexBytes.data() : nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Model::FillBuffers()
+{
+	// 16-bit indices can address up to 65536 vertices. If we have that few, they take half the memory of 32-bit ones.
+	indexType = numVertices <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// Pack the vertices into the layout's struct. The full layout is already in the right format, so it doesn't need a copy.
+	const void* vertexData = vertices;
+	std::vector<VertexFormatCompact> compact;
+	std::vector<VertexFormatHalf> half;
+
+	if (layout == VERTEX_LAYOUT_COMPACT)
+	{
+		compact.resize(numVertices);
+		for (int i = 0; i < numVertices; i++)
+		{
+			compact[i].position = glm::vec2(vertices[i].position);
+			compact[i].color = glm::packUnorm4x8(vertices[i].color);
+		}
+		vertexData = compact.data();
+	}
+	else if (layout == VERTEX_LAYOUT_HALF)
+	{
+		half.resize(numVertices);
+		for (int i = 0; i < numVertices; i++)
+		{
+			half[i].position[0] = glm::packHalf1x16(vertices[i].position.x);
+			half[i].position[1] = glm::packHalf1x16(vertices[i].position.y);
+			half[i].color = glm::packUnorm4x8(vertices[i].color);
+		}
+		vertexData = half.data();
+	}
+
+	const void* indexData = indices;
+	std::vector<GLushort> shortIndices;
+
+	if (indexType == GL_UNSIGNED_SHORT)
+	{
+		shortIndices.assign(indices, indices + numIndices);
+		indexData = shortIndices.data();
+	}
+
 	//// Creates and initializes a buffer object's data.
 	//// First parameter is the target, second parameter is the size of the buffer, third parameter is a pointer to the data that will copied into the buffer, and fourth parameter is the 
 	//// expected usage pattern of the data. Possible usage patterns: GL_STREAM_DRAW, GL_STREAM_READ, GL_STREAM_COPY, GL_STATIC_DRAW, GL_STATIC_READ, GL_STATIC_COPY, GL_DYNAMIC_DRAW, 
@@ -158,8 +518,8 @@ void Model::UpdateBuffer()
 	//// Stream means that the data will be modified once, and used only a few times at most. Static means that the data will be modified once, and used a lot. Dynamic means that the data 
 	//// will be modified repeatedly, and used a lot. Draw means that the data is modified by the application, and used as a source for GL drawing. Read means the data is modified by 
 	//// reading data from GL, and used to return that data when queried by the application. Copy means that the data is modified by reading from the GL, and used as a source for drawing.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * numVertices, vertices, GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * numIndices, indices, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, VertexStride(layout) * numVertices, vertexData, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint)) * numIndices, indexData, GL_STATIC_DRAW);
 }
 
 void Model::Draw()
@@ -177,12 +537,28 @@ void Model::Draw()
 	// There are several different drawing modes, GL_TRIANGLES takes every 3 vertices and makes them a triangle.
 	// For reference, GL_TRIANGLE_STRIP would take each additional vertex after the first 3 and consider that a 
 	// triangle with the previous 2 vertices (so you could make 2 triangles with 4 vertices)
-	// The second parameter is the number of vertices, the third parameter is the type of the element buffer data, and the fourth parameter is the offset.
-	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+	// The second parameter is the number of vertices, the third parameter is the type of the element buffer data (16 or 32-bit, see FillBuffers), and the fourth parameter is the offset.
+	glDrawElements(GL_TRIANGLES, numIndices, indexType, 0);
+}
+
+void Model::Bind()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	SetupAttributes();
+}
+
+void Model::DrawInstanced(int count)
+{
+	// The same as Draw, but the last parameter says how many copies (instances) to draw.
+	glDrawElementsInstanced(GL_TRIANGLES, numIndices, indexType, 0, count);
 }
 
 GLuint Model::AddVertex(VertexFormat* vert)
 {
+	// Growing the arrays frees the old ones, which we can only do if they're ours.
+	OwnData();
+
 	if (numVertices > 0)
 	{
 		// Allocate space equivalent to our current vertices array.
@@ -209,6 +585,14 @@ GLuint Model::AddVertex(VertexFormat* vert)
 		// Set the last value in the vertices array to the new vertex.
 		vertices[numVertices - 1] = *vert;
 
+		// Grow the bounds to fit it. It also joins the hull: that's more points than the hull needs if it's inside, but any set of
+		// the model's vertices that includes the hull still gives the same AABB, and it saves working the hull out again on every vertex.
+		localMin = glm::min(localMin, vert->position);
+		localMax = glm::max(localMax, vert->position);
+		hullX.push_back(vert->position.x);
+		hullY.push_back(vert->position.y);
+		hullZ.push_back(vert->position.z);
+
 		// Update our buffer to match this change.
 		UpdateBuffer();
 
@@ -219,6 +603,7 @@ GLuint Model::AddVertex(VertexFormat* vert)
 	{
 		// Create a new vertices array of size 1.
 		vertices = (VertexFormat*)malloc(sizeof(VertexFormat));
+		ownsVertices = true;
 
 		// Set the value to the new vertex.
 		vertices[0] = *vert;
@@ -226,6 +611,11 @@ GLuint Model::AddVertex(VertexFormat* vert)
 		// Set the number of vertices to 1.
 		numVertices = 1;
 
+		// The bounds (and hull) are just this one point so far.
+		localMin = vert->position;
+		localMax = vert->position;
+		CalculateHull();
+
 		// Initialize the buffer.
 		InitBuffer();
 
@@ -235,6 +625,8 @@ GLuint Model::AddVertex(VertexFormat* vert)
 }
 void Model::AddIndex(GLuint index)
 {
+	OwnData();
+
 	if (numIndices > 0)
 	{
 		// Allocate space equivalent to our current indices array.
@@ -265,6 +657,7 @@ void Model::AddIndex(GLuint index)
 	{
 		// Create a new indices array of size 1.
 		indices = (GLuint*)malloc(sizeof(GLuint));
+		ownsIndices = true;
 
 		// Set the value to the new index.
 		indices[0] = index;
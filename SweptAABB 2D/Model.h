@@ -39,6 +39,28 @@ object passes through or into the middle of the colliding object).
 #define _MODEL_H
 
 #include "GLIncludes.h"
+#include <functional>
+#include <vector>
+
+// The bytes a model's GPU buffers hold, already packed into its vertex layout and index type.
+// Building them needs no OpenGL, so a loader thread can do it and leave only the upload for the thread with the context (see AssetLoader).
+struct ModelStaging
+{
+	std::vector<unsigned char> vertexBytes;
+	std::vector<unsigned char> indexBytes;
+	GLenum indexType;
+};
+
+// count Ts starting at data, owned by someone other than the model (part of a memory-mapped file, a block of an arena, a loader's buffer).
+template <typename T>
+struct ModelSpan
+{
+	T* data;
+	int count;
+};
+
+// Called once a model is done with data it was handed instead of copying (to unmap the file, give the block back to the arena, and so on).
+typedef std::function<void()> ModelDataRelease;
 
 class Model
 {
@@ -49,14 +71,59 @@ private:
 	int numIndices;
 	GLuint* indices;
 
+	// Whether vertices and indices were malloc'd by us (and so are ours to free), and what to call for data that came from somewhere else.
+	bool ownsVertices;
+	bool ownsIndices;
+	ModelDataRelease releaseData;
+
 	GLuint vbo;
 	GLuint ebo;
 
+	// The smallest box around every vertex, before any position or scale. Kept up to date as vertices are added, so nobody has to loop over them again.
+	glm::vec3 localMin;
+	glm::vec3 localMax;
+
+	// The vertices on the model's convex hull, as separate x, y and z arrays. However an object is rotated, its furthest point in any direction is
+	// one of these, so its AABB only needs them and not every vertex. Kept even when the CPU copy of the vertices is dropped.
+	std::vector<float> hullX;
+	std::vector<float> hullY;
+	std::vector<float> hullZ;
+
+	// How the vertices are stored in the vbo, and whether the ebo holds 16-bit (GL_UNSIGNED_SHORT) or 32-bit (GL_UNSIGNED_INT) indices.
+	VertexLayout layout;
+	GLenum indexType;
+
+	// Packs the vertices/indices into the layout and index type the GPU buffers use, then fills the currently bound buffers with them.
+	void FillBuffers();
+
+	// Tells OpenGL where the position and color are in one vertex of our layout.
+	void SetupAttributes();
+
+	// Finds localMin and localMax from every vertex.
+	void CalculateBounds();
+
+	// Finds the hull vertices. For a flat model (every vertex at the same z, like all of ours) that's its 2D convex hull, which for a detailed
+	// mesh is a small fraction of the vertices. Otherwise every vertex is kept, since a 3D hull isn't worth it for a 2D demo.
+	void CalculateHull();
+
+	// Frees (or hands back) the CPU copy of the vertices and indices, leaving the counts alone.
+	void FreeData();
+
+	// Copies vertices or indices we don't own into memory we do, so they can be grown.
+	void OwnData();
+
 	//GLuint shaderProgram;
 	//GLuint m_Buffer;
 
 public:
-	Model(int numVerts = 0, VertexFormat* verts = nullptr, int numInds = 0, GLuint* inds = nullptr);
+	// The layout only changes how the vertices are stored on the GPU. Indices are stored as 16-bit whenever there are few enough vertices.
+	// With initBuffer = false the model gets no GPU buffers until InitBuffer or CreateBuffers is called, so it can be made on a thread without an OpenGL context.
+	Model(int numVerts = 0, VertexFormat* verts = nullptr, int numInds = 0, GLuint* inds = nullptr, VertexLayout vertexLayout = VERTEX_LAYOUT_FULL, bool initBuffer = true);
+
+	// Uses the vertices and indices where they are instead of copying them. With a release function the model adopts them, and calls it once
+	// it's done with them (when it's deleted, or in DropCPUData). Without one it's only a view, and the data has to outlive the model.
+	// No indices means one per vertex in order, like above, which the model makes and owns itself.
+	Model(ModelSpan<VertexFormat> verts, ModelSpan<GLuint> inds, ModelDataRelease release = ModelDataRelease(), VertexLayout vertexLayout = VERTEX_LAYOUT_FULL, bool initBuffer = true);
 	~Model();
 
 	GLuint AddVertex(VertexFormat*);
@@ -65,8 +132,46 @@ public:
 	void InitBuffer();
 	void UpdateBuffer();
 
+	// Packs the vertices and indices the way FillBuffers would. Only reads the CPU-side data, so any thread can do it.
+	void Stage(ModelStaging&);
+
+	// Creates the GPU buffers at the staged sizes. With fill = true they get the staged bytes straight away, otherwise they're left empty
+	// for the caller to fill piece by piece with glBufferSubData. Unlike InitBuffer, this doesn't touch the vertex attributes (Bind does that before drawing).
+	void CreateBuffers(const ModelStaging&, bool fill = true);
+
+	// Whether the model has its GPU buffers yet.
+	bool HasBuffers()
+	{
+		return vbo != 0;
+	}
+
+	// Lets go of the CPU copy of the vertices and indices once they're on the GPU. The counts and bounds stay, which is all drawing and the
+	// world's AABBs need. Anything that reads Vertices() or Indices() (GeometryArena::Add, UpdateBuffer, AddVertex) can't be used on the model afterwards.
+	// Returns false, keeping the data, if the model has no GPU buffers yet.
+	bool DropCPUData();
+
+	// Whether Vertices() and Indices() still point at anything.
+	bool HasCPUData()
+	{
+		return vertices != nullptr;
+	}
+	GLuint VertexBuffer()
+	{
+		return vbo;
+	}
+	GLuint IndexBuffer()
+	{
+		return ebo;
+	}
+
 	void Draw();
 
+	// Binds the model's buffers and points the vertex attributes at them, so that the next Draw draws this model (needed when several models are drawn in a row).
+	void Bind();
+
+	// Draws the model count times in one call. The vertex shader tells the copies apart with gl_InstanceID.
+	void DrawInstanced(int count);
+
 	// Our get variables.
 	int NumVertices()
 	{
@@ -84,6 +189,45 @@ public:
 	{
 		return indices;
 	}
+	VertexLayout Layout()
+	{
+		return layout;
+	}
+
+	// The hull vertices (see hullX), for working out a transformed AABB with computeBounds.
+	unsigned int HullSize()
+	{
+		return (unsigned int)hullX.size();
+	}
+	const float* HullX()
+	{
+		return hullX.data();
+	}
+	const float* HullY()
+	{
+		return hullY.data();
+	}
+	const float* HullZ()
+	{
+		return hullZ.data();
+	}
+
+	// The bounds of the vertices, before any position or scale (all zero without vertices).
+	glm::vec3 LocalMin()
+	{
+		return localMin;
+	}
+	glm::vec3 LocalMax()
+	{
+		return localMax;
+	}
+	GLenum IndexType()
+	{
+		return indexType;
+	}
+
+	// The size of one vertex in the GPU buffer for a layout.
+	static int VertexStride(VertexLayout);
 
 	/*Model(int p_nVertices = 3, float _size = 1.0f, float _originX = 0.0f, float _originY = 0.0f, float _originZ = 0.0f)
 	{
@@ -0,0 +1,275 @@
+/*
+Title: Swept AABB-2D
+File Name: ModelRegistry.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _MODEL_REGISTRY_CPP
+#define _MODEL_REGISTRY_CPP
+
+#include "ModelRegistry.h"
+
+// FNV-1a, the same as the shader cache uses to tell sources apart.
+static unsigned long long hashBytes(unsigned long long hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+ModelRegistry::ModelRegistry()
+{
+	hits = 0;
+	misses = 0;
+	bytesShared = 0;
+}
+
+ModelRegistry::~ModelRegistry()
+{
+}
+
+unsigned long long ModelRegistry::Hash(int numVerts, const VertexFormat* verts, int numInds, const GLuint* inds, VertexLayout layout)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	hash = hashBytes(hash, &layout, sizeof(layout));
+	hash = hashBytes(hash, &numVerts, sizeof(numVerts));
+	hash = hashBytes(hash, verts, sizeof(VertexFormat) * numVerts);
+
+	// No indices means one per vertex, in order, which is what the model will make. Hash those so it matches a mesh that spells them out.
+	if (numInds > 0)
+	{
+		hash = hashBytes(hash, &numInds, sizeof(numInds));
+		hash = hashBytes(hash, inds, sizeof(GLuint) * numInds);
+	}
+	else
+	{
+		hash = hashBytes(hash, &numVerts, sizeof(numVerts));
+		for (GLuint i = 0; i < (GLuint)numVerts; i++)
+		{
+			hash = hashBytes(hash, &i, sizeof(i));
+		}
+	}
+
+	return hash;
+}
+
+unsigned long long ModelRegistry::Hash(Model* model)
+{
+	return Hash(model->NumVertices(), model->Vertices(), model->NumIndices(), model->Indices(), model->Layout());
+}
+
+Model* ModelRegistry::Find(unsigned long long hash, int numVerts, const VertexFormat* verts, int numInds, const GLuint* inds, VertexLayout layout)
+{
+	std::pair<std::unordered_multimap<unsigned long long, Model*>::iterator, std::unordered_multimap<unsigned long long, Model*>::iterator> range = byHash.equal_range(hash);
+
+	for (std::unordered_multimap<unsigned long long, Model*>::iterator it = range.first; it != range.second; ++it)
+	{
+		Model* model = it->second;
+
+		// The hashes match, but so could two different meshes', so check the bytes too. Without its CPU copy there's nothing to compare
+		// against, and a hash collision would hand out the wrong mesh, so a model that dropped it isn't shared anymore.
+		if (!model->HasCPUData() || model->Layout() != layout || model->NumVertices() != numVerts || model->NumIndices() != (numInds > 0 ? numInds : numVerts))
+		{
+			continue;
+		}
+
+		if (memcmp(model->Vertices(), verts, sizeof(VertexFormat) * numVerts) != 0)
+		{
+			continue;
+		}
+
+		bool sameIndices = true;
+		if (numInds > 0)
+		{
+			sameIndices = memcmp(model->Indices(), inds, sizeof(GLuint) * numInds) == 0;
+		}
+		else
+		{
+			for (int i = 0; i < numVerts && sameIndices; i++)
+			{
+				sameIndices = model->Indices()[i] == (GLuint)i;
+			}
+		}
+
+		if (sameIndices)
+		{
+			return model;
+		}
+	}
+
+	return nullptr;
+}
+
+Model* ModelRegistry::Share(Model* model)
+{
+	entries[model].references++;
+	hits++;
+	bytesShared += sizeof(VertexFormat) * model->NumVertices() + sizeof(GLuint) * model->NumIndices();
+	return model;
+}
+
+Model* ModelRegistry::Acquire(int numVerts, VertexFormat* verts, int numInds, GLuint* inds, VertexLayout layout)
+{
+	unsigned long long hash = Hash(numVerts, verts, numInds, inds, layout);
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	Model* model = Find(hash, numVerts, verts, numInds, inds, layout);
+	if (model != nullptr)
+	{
+		return Share(model);
+	}
+
+	model = new Model(numVerts, verts, numInds, inds, layout);
+
+	Entry entry = { hash, 1 };
+	entries[model] = entry;
+	byHash.insert(std::make_pair(hash, model));
+	misses++;
+
+	return model;
+}
+
+Model* ModelRegistry::Intern(Model* model, unsigned long long hash)
+{
+	std::unique_lock<std::mutex> guard(lock);
+
+	Model* existing = Find(hash, model->NumVertices(), model->Vertices(), model->NumIndices(), model->Indices(), model->Layout());
+	if (existing != nullptr)
+	{
+		Share(existing);
+		guard.unlock();
+
+		// Only ours to delete if the registry didn't already have it (interning the same model twice just adds a reference).
+		if (existing != model)
+		{
+			delete(model);
+		}
+		return existing;
+	}
+
+	Entry entry = { hash, 1 };
+	entries[model] = entry;
+	byHash.insert(std::make_pair(hash, model));
+	misses++;
+
+	return model;
+}
+
+void ModelRegistry::Retain(Model* model)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	std::unordered_map<Model*, Entry>::iterator found = entries.find(model);
+	if (found != entries.end())
+	{
+		found->second.references++;
+	}
+}
+
+void ModelRegistry::Release(Model* model)
+{
+	std::unique_lock<std::mutex> guard(lock);
+
+	std::unordered_map<Model*, Entry>::iterator found = entries.find(model);
+	if (found == entries.end() || --found->second.references > 0)
+	{
+		return;
+	}
+
+	// That was the last reference, so take it out of both maps and delete it.
+	std::pair<std::unordered_multimap<unsigned long long, Model*>::iterator, std::unordered_multimap<unsigned long long, Model*>::iterator> range = byHash.equal_range(found->second.hash);
+	for (std::unordered_multimap<unsigned long long, Model*>::iterator it = range.first; it != range.second; ++it)
+	{
+		if (it->second == model)
+		{
+			byHash.erase(it);
+			break;
+		}
+	}
+	entries.erase(found);
+	guard.unlock();
+
+	delete(model);
+}
+
+bool ModelRegistry::DropCPUData(Model* model)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return model->DropCPUData();
+}
+
+unsigned int ModelRegistry::References(Model* model)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	std::unordered_map<Model*, Entry>::iterator found = entries.find(model);
+	return found != entries.end() ? found->second.references : 0;
+}
+
+ModelRegistryStats ModelRegistry::Stats()
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	ModelRegistryStats stats;
+	stats.uniqueModels = (unsigned int)entries.size();
+	stats.references = 0;
+	for (std::unordered_map<Model*, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		stats.references += it->second.references;
+	}
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.bytesShared = bytesShared;
+
+	return stats;
+}
+
+void ModelRegistry::Clear()
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	for (std::unordered_map<Model*, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		delete(it->first);
+	}
+	entries.clear();
+	byHash.clear();
+}
+
+#endif // _MODEL_REGISTRY_CPP
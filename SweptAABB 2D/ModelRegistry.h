@@ -0,0 +1,128 @@
+/*
+Title: Swept AABB-2D
+File Name: ModelRegistry.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _MODEL_REGISTRY_H
+#define _MODEL_REGISTRY_H
+
+#include "Model.h"
+#include <mutex>
+#include <unordered_map>
+
+// How much sharing the registry has done since it was made.
+struct ModelRegistryStats
+{
+	unsigned int uniqueModels;		// Models alive right now, each with its own copy of the data and its own GPU buffers
+	unsigned int references;		// Acquires and Interns that haven't been released yet
+	unsigned long long hits;		// Requests that got a model that already existed
+	unsigned long long misses;		// Requests that needed a new model
+	unsigned long long bytesShared;	// Vertex and index bytes the hits didn't have to copy (or upload)
+};
+
+// Hands out one shared model per distinct mesh. A mesh is looked up by a hash of its vertices, indices and layout, and on a match
+// the bytes are compared as well, so two meshes only share a model if they really are the same. Each model is reference counted
+// and deleted when the last user releases it, so memory and GPU buffers grow with the number of different meshes instead of
+// the number of times one gets made. The model also works out its bounds when it's made, so those are done once per mesh too.
+// A shared model mustn't be changed (AddVertex, AddIndex), since that would change it for everyone using it. It can drop its CPU copy
+// (through DropCPUData below), but then there's nothing left to compare a new mesh against, so it isn't handed out again: the next request
+// for the same mesh makes a new model. Its current users keep it until they release it.
+// Safe to use from any thread, except that Acquire makes GPU buffers and so needs the OpenGL context.
+class ModelRegistry
+{
+	struct Entry
+	{
+		unsigned long long hash;
+		unsigned int references;
+	};
+
+	// Every model by the hash of its mesh (several models can have the same hash if their meshes collide), and the other way around.
+	std::unordered_multimap<unsigned long long, Model*> byHash;
+	std::unordered_map<Model*, Entry> entries;
+
+	unsigned long long hits;
+	unsigned long long misses;
+	unsigned long long bytesShared;
+
+	std::mutex lock;
+
+	// The model already holding exactly this mesh, or nullptr. Needs the lock.
+	Model* Find(unsigned long long hash, int numVerts, const VertexFormat* verts, int numInds, const GLuint* inds, VertexLayout);
+
+	// Adds a reference to a model found by Find and counts the hit. Needs the lock.
+	Model* Share(Model*);
+
+public:
+	ModelRegistry();
+
+	// The models need OpenGL to be deleted, so any still alive are left to Clear(). This doesn't delete them.
+	~ModelRegistry();
+
+	// A hash of the mesh as the Model constructor would store it (no indices means 0, 1, 2, ...), so equal meshes always hash the same.
+	// The model needs its CPU copy for this.
+	static unsigned long long Hash(int numVerts, const VertexFormat* verts, int numInds, const GLuint* inds, VertexLayout);
+	static unsigned long long Hash(Model*);
+
+	// The model for this mesh, made (with its GPU buffers) if it's the first time it's been asked for. Release it when done.
+	Model* Acquire(int numVerts, VertexFormat* verts, int numInds = 0, GLuint* inds = nullptr, VertexLayout = VERTEX_LAYOUT_FULL);
+
+	// Takes over a model made somewhere else (like a loader thread, before it has GPU buffers). If the registry already has the same mesh,
+	// the model given is deleted and the existing one returned instead. hash must be Hash(model), which the caller can work out beforehand.
+	Model* Intern(Model* model, unsigned long long hash);
+	Model* Intern(Model* model)
+	{
+		return Intern(model, Hash(model));
+	}
+
+	// Adds a reference to a model the registry already holds.
+	void Retain(Model*);
+
+	// Drops a reference, deleting the model when it was the last one. Needs the OpenGL context if that happens.
+	void Release(Model*);
+
+	// Model::DropCPUData, but with the registry locked so another thread can't be comparing against the data while it goes.
+	bool DropCPUData(Model*);
+
+	// How many references a model has (0 if the registry doesn't hold it).
+	unsigned int References(Model*);
+
+	ModelRegistryStats Stats();
+
+	// Deletes every model, whatever their references. Needs the OpenGL context.
+	void Clear();
+};
+
+#endif //_MODEL_REGISTRY_H
@@ -0,0 +1,194 @@
+/*
+Title: Swept AABB-2D
+File Name: ObjectPool.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _OBJECT_POOL_H
+#define _OBJECT_POOL_H
+
+#include <vector>
+
+// A handle to an object in the world. Hold on to these instead of pointers or array indices.
+// The index says which slot the object lives in, and the generation says which object in that slot it was.
+// Every time a slot is freed its generation goes up, so an old handle to a destroyed object simply stops being valid instead of pointing at whatever took its place.
+struct ObjectHandle
+{
+	unsigned int index;
+	unsigned int generation;
+
+	ObjectHandle()
+	{
+		index = 0xFFFFFFFF;
+		generation = 0;
+	}
+	ObjectHandle(unsigned int inIndex, unsigned int inGeneration)
+	{
+		index = inIndex;
+		generation = inGeneration;
+	}
+
+	bool IsNull() const
+	{
+		return index == 0xFFFFFFFF;
+	}
+
+	bool operator==(const ObjectHandle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+	bool operator!=(const ObjectHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+// Hands out handles and keeps track of where each object's data lives.
+// The pool doesn't store any object data itself. The owner keeps its data in dense arrays (one entry per live object, no holes),
+// and the pool maps each handle to a position in those arrays. Removing an object moves the last entry into the hole (swap and pop),
+// so the arrays stay packed and can be looped over without checking for dead objects.
+class ObjectPool
+{
+	static const unsigned int InvalidIndex = 0xFFFFFFFF;
+
+	struct Slot
+	{
+		unsigned int generation;
+
+		// While the slot is in use, this is the object's position in the dense arrays.
+		// While it's free, this is the next free slot instead, which makes up the free list.
+		unsigned int denseOrNextFree;
+	};
+
+	std::vector<Slot> slots;
+
+	// The handle of the object at each dense position. Used to fix up a slot when its object gets moved.
+	std::vector<ObjectHandle> denseHandles;
+
+	// The first free slot, or InvalidIndex if they are all in use.
+	unsigned int freeHead;
+
+public:
+	ObjectPool()
+	{
+		freeHead = InvalidIndex;
+	}
+
+	// Makes room for this many objects so that spawning up to that many never needs to reallocate.
+	void Reserve(unsigned int count)
+	{
+		slots.reserve(count);
+		denseHandles.reserve(count);
+	}
+
+	// Creates a new handle. Its dense position is always Size() - 1 (the end of the arrays), so the owner should push_back its data.
+	ObjectHandle Allocate()
+	{
+		unsigned int index;
+
+		if (freeHead != InvalidIndex)
+		{
+			// Reuse a free slot. It keeps its generation, which was already bumped when it was freed.
+			index = freeHead;
+			freeHead = slots[index].denseOrNextFree;
+		}
+		else
+		{
+			Slot slot;
+			slot.generation = 1;
+			slots.push_back(slot);
+			index = (unsigned int)slots.size() - 1;
+		}
+
+		slots[index].denseOrNextFree = (unsigned int)denseHandles.size();
+
+		ObjectHandle handle(index, slots[index].generation);
+		denseHandles.push_back(handle);
+
+		return handle;
+	}
+
+	// O(1): the slot exists and still holds the same generation the handle was made with.
+	bool IsValid(ObjectHandle handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+	}
+
+	// Where the object's data is in the dense arrays. The handle must be valid.
+	unsigned int DenseIndex(ObjectHandle handle) const
+	{
+		return slots[handle.index].denseOrNextFree;
+	}
+
+	ObjectHandle HandleAt(unsigned int dense) const
+	{
+		return denseHandles[dense];
+	}
+
+	// The current handle for a slot index. Only meaningful if the slot is in use.
+	ObjectHandle SlotHandle(unsigned int index) const
+	{
+		return ObjectHandle(index, slots[index].generation);
+	}
+
+	unsigned int Size() const
+	{
+		return (unsigned int)denseHandles.size();
+	}
+
+	// Frees the handle and returns the dense position it had. The owner must then do the same swap and pop on its own arrays:
+	// move the last entry into the returned position and pop the last entry off.
+	// The handle must be valid.
+	unsigned int Free(ObjectHandle handle)
+	{
+		unsigned int dense = slots[handle.index].denseOrNextFree;
+		unsigned int last = (unsigned int)denseHandles.size() - 1;
+
+		// Move the last object into the hole and point its slot at the new position.
+		ObjectHandle moved = denseHandles[last];
+		denseHandles[dense] = moved;
+		slots[moved.index].denseOrNextFree = dense;
+		denseHandles.pop_back();
+
+		// Bump the generation so every existing handle to this slot is now stale, then put the slot on the free list.
+		slots[handle.index].generation++;
+		slots[handle.index].denseOrNextFree = freeHead;
+		freeHead = handle.index;
+
+		return dense;
+	}
+};
+
+#endif //_OBJECT_POOL_H
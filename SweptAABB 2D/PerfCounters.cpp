@@ -0,0 +1,197 @@
+/*
+Title: Swept AABB-2D
+File Name: PerfCounters.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _PERF_COUNTERS_CPP
+#define _PERF_COUNTERS_CPP
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+PerfCounters::PerfCounters()
+{
+	group = -1;
+	numOpen = 0;
+
+	for (int i = 0; i < PERF_COUNTERS; i++)
+	{
+		files[i] = -1;
+		slots[i] = -1;
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+bool PerfCounters::Open()
+{
+	Close();
+
+#ifdef __linux__
+	const unsigned long long configs[PERF_COUNTERS] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+	const unsigned int types[PERF_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+
+	for (int i = 0; i < PERF_COUNTERS; i++)
+	{
+		perf_event_attr attributes;
+		memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = types[i];
+		attributes.config = configs[i];
+
+		// The group starts stopped and is started all at once below. Only our own code counts: not the kernel's, not the hypervisor's.
+		attributes.disabled = group < 0 ? 1 : 0;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// This thread, on whichever CPU it runs on. The first counter that opens leads the group.
+		int file = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0);
+		if (file < 0)
+		{
+			continue;
+		}
+
+		if (group < 0)
+		{
+			group = file;
+		}
+
+		files[i] = file;
+		slots[i] = numOpen++;
+	}
+
+	if (group < 0)
+	{
+		return false;
+	}
+
+	ioctl(group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void PerfCounters::Close()
+{
+#ifdef __linux__
+	for (int i = 0; i < PERF_COUNTERS; i++)
+	{
+		if (files[i] >= 0)
+		{
+			close(files[i]);
+		}
+	}
+#endif
+
+	for (int i = 0; i < PERF_COUNTERS; i++)
+	{
+		files[i] = -1;
+		slots[i] = -1;
+	}
+
+	group = -1;
+	numOpen = 0;
+}
+
+PerfCounts PerfCounters::Read()
+{
+	PerfCounts counts;
+
+#ifdef __linux__
+	if (group < 0)
+	{
+		return counts;
+	}
+
+	// A group reading is the number of counters, the time the group was enabled and the time it was actually counting, then each counter's value.
+	unsigned long long buffer[3 + PERF_COUNTERS];
+	if (read(group, buffer, sizeof(buffer)) < (ssize_t)((3 + numOpen) * sizeof(unsigned long long)))
+	{
+		return counts;
+	}
+
+	unsigned long long enabled = buffer[1];
+	unsigned long long running = buffer[2];
+
+	for (int i = 0; i < PERF_COUNTERS; i++)
+	{
+		if (slots[i] < 0)
+		{
+			continue;
+		}
+
+		unsigned long long value = buffer[3 + slots[i]];
+
+		// If the counters had to take turns, this one only counted for running out of every enabled nanoseconds.
+		if (running > 0 && running < enabled)
+		{
+			value = (unsigned long long)((double)value * enabled / running);
+		}
+
+		counts.values[i] = value;
+	}
+#endif
+
+	return counts;
+}
+
+const char* PerfCounters::Name(PerfCounter counter)
+{
+	const char* names[PERF_COUNTERS] = { "cycles", "instructions", "L1D misses", "LLC misses", "branch misses" };
+	return names[counter];
+}
+
+#endif // _PERF_COUNTERS_CPP
@@ -0,0 +1,132 @@
+/*
+Title: Swept AABB-2D
+File Name: PerfCounters.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+// The hardware events PerfCounters can count.
+enum PerfCounter
+{
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,		// Level 1 data cache read misses
+	PERF_LLC_MISSES,		// Last level cache misses, which go all the way to memory
+	PERF_BRANCH_MISSES,		// Mispredicted branches
+	PERF_COUNTERS
+};
+
+// How many of each event happened. Subtract two readings to get what happened in between.
+struct PerfCounts
+{
+	unsigned long long values[PERF_COUNTERS];
+
+	PerfCounts()
+	{
+		for (int i = 0; i < PERF_COUNTERS; i++)
+		{
+			values[i] = 0;
+		}
+	}
+
+	unsigned long long operator[](PerfCounter counter) const
+	{
+		return values[counter];
+	}
+
+	PerfCounts operator-(const PerfCounts& other) const
+	{
+		PerfCounts difference;
+		for (int i = 0; i < PERF_COUNTERS; i++)
+		{
+			difference.values[i] = values[i] - other.values[i];
+		}
+		return difference;
+	}
+
+	PerfCounts& operator+=(const PerfCounts& other)
+	{
+		for (int i = 0; i < PERF_COUNTERS; i++)
+		{
+			values[i] += other.values[i];
+		}
+		return *this;
+	}
+};
+
+// Reads the CPU's performance counters, to see why something is slow and not just that it is: whether the time goes to cache misses,
+// mispredicted branches, or simply too many instructions. Uses perf_event_open, so it only works on Linux, and only if the kernel lets
+// us (perf_event_paranoid of 2 or less is enough, since only our own code is counted, not the kernel's) and the CPU has the counters
+// (virtual machines often don't pass them through). Open() says whether it worked, and the counters it couldn't get just stay at zero.
+// All the counters run as one group, so they're counted over exactly the same instructions and a reading is a single system call
+// (around a microsecond). If the CPU has fewer counters than events, the kernel takes turns and the counts are scaled up to match.
+// Only the thread that called Open() is counted.
+class PerfCounters
+{
+	int group;
+	int files[PERF_COUNTERS];
+
+	// Where each counter's value comes in a group reading, or -1 if it couldn't be opened.
+	int slots[PERF_COUNTERS];
+	int numOpen;
+
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	// Starts counting. Returns false if no counter at all could be opened.
+	bool Open();
+	void Close();
+
+	bool IsOpen()
+	{
+		return numOpen > 0;
+	}
+
+	// Whether this counter could be opened.
+	bool Has(PerfCounter counter)
+	{
+		return slots[counter] >= 0;
+	}
+
+	// The totals since Open().
+	PerfCounts Read();
+
+	static const char* Name(PerfCounter);
+};
+
+#endif //_PERF_COUNTERS_H
@@ -0,0 +1,506 @@
+/*
+Title: Swept AABB-2D
+File Name: PhysicsWorld.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _PHYSICS_WORLD_H
+#define _PHYSICS_WORLD_H
+
+#include "World.h"
+#include "Collision.h"
+#include "PerfCounters.h"
+#include "SweptCapture.h"
+#include <chrono>
+#include <vector>
+
+// The physics step for a World, put together at compile time from a set of policies.
+// Every policy is a plain class whose functions the step calls directly, so the compiler can inline all of it and there are no virtual calls in the step loop.
+// A production build picks exactly what it needs (see DefaultPhysicsConfig), and pays for nothing else.
+//
+// A config is a struct with these members:
+//     typedef ... Scalar;          float or double, used for the swept collision math.
+//     typedef ... BroadphaseType;  Finds collision candidates: GridBroadphase or BruteForceBroadphase.
+//     typedef ... ResponseType;    What happens on a hit: BounceResponse, SlideResponse or SpeculativeResponse.
+//     typedef ... EventSinkType;   Receives contacts: NullEventSink or ContactListSink.
+//     static const bool Instrumented;  Whether to count pairs and time each phase (and read the CPU's counters for it, see SetCounters).
+//     typedef ... CaptureType;     Sees every swept test: NullSweptCapture or SweptCapture.
+// PhysicsConfig below builds one from template parameters.
+
+// Broadphase policies. ForEachCandidate calls visit(denseIndex) for each object that might overlap the box.
+
+// Uses the world's uniform grid.
+class GridBroadphase
+{
+	std::vector<ObjectHandle> found;
+
+public:
+	template <typename Visitor>
+	void ForEachCandidate(World& world, const AABB& box, Visitor& visit)
+	{
+		found.clear();
+		world.Query(box, found);
+
+		for (unsigned int i = 0; i < found.size(); i++)
+		{
+			visit(world.DenseIndex(found[i]));
+		}
+	}
+};
+
+// Tests against every object. Slow for big worlds, but there's nothing to keep up to date, so it's fine for a handful of objects.
+class BruteForceBroadphase
+{
+public:
+	template <typename Visitor>
+	void ForEachCandidate(World& world, const AABB&, Visitor& visit)
+	{
+		for (unsigned int i = 0; i < world.NumObjects(); i++)
+		{
+			visit(i);
+		}
+	}
+};
+
+// Response policies. Respond changes the velocity of the moving object after it hit something with the given normal,
+// and returns how much of the rest of the step it should keep moving for (1 = all of it, 0 = stop at the contact).
+// It's only called for hits, so both normals being zero means a perfect corner hit (see SweptAABBGeneric), which counts as hitting both axes.
+
+// "Bounces" the velocity along the axis of collision (both axes on a corner hit), just like update() in Main.cpp.
+class BounceResponse
+{
+public:
+	template <typename Scalar>
+	float Respond(glm::vec3& velocity, Scalar normalx, Scalar normaly)
+	{
+		bool corner = normalx == 0 && normaly == 0;
+
+		if (normalx != 0 || corner)
+		{
+			velocity.x *= -1;
+		}
+		if (normaly != 0 || corner)
+		{
+			velocity.y *= -1;
+		}
+
+		return 1.0f;
+	}
+};
+
+// Removes the part of the velocity going into the surface, so the object slides along it for the rest of the step.
+class SlideResponse
+{
+public:
+	template <typename Scalar>
+	float Respond(glm::vec3& velocity, Scalar normalx, Scalar normaly)
+	{
+		bool corner = normalx == 0 && normaly == 0;
+
+		if (normalx != 0 || corner)
+		{
+			velocity.x = 0.0f;
+		}
+		if (normaly != 0 || corner)
+		{
+			velocity.y = 0.0f;
+		}
+
+		return 1.0f;
+	}
+};
+
+// Only moves the object up to the contact and stops there for this step, without using the rest of the step's time.
+// The velocity into the surface is dropped, so nothing ever ends up inside anything else. This is the cheapest and most stable option.
+class SpeculativeResponse
+{
+public:
+	template <typename Scalar>
+	float Respond(glm::vec3& velocity, Scalar normalx, Scalar normaly)
+	{
+		bool corner = normalx == 0 && normaly == 0;
+
+		if (normalx != 0 || corner)
+		{
+			velocity.x = 0.0f;
+		}
+		if (normaly != 0 || corner)
+		{
+			velocity.y = 0.0f;
+		}
+
+		return 0.0f;
+	}
+};
+
+// Event sink policies. OnContact is called for every hit, after the response was applied.
+
+// Ignores contacts. The empty function is inlined away entirely.
+class NullEventSink
+{
+public:
+	void OnContact(ObjectHandle, ObjectHandle, float, float, float)
+	{
+	}
+};
+
+// Keeps a list of every contact since the last Clear().
+class ContactListSink
+{
+public:
+	struct Contact
+	{
+		ObjectHandle moving;
+		ObjectHandle other;
+		float time;
+		float normalx, normaly;
+	};
+
+	std::vector<Contact> contacts;
+
+	void OnContact(ObjectHandle moving, ObjectHandle other, float time, float normalx, float normaly)
+	{
+		Contact contact;
+		contact.moving = moving;
+		contact.other = other;
+		contact.time = time;
+		contact.normalx = normalx;
+		contact.normaly = normaly;
+		contacts.push_back(contact);
+	}
+
+	void Clear()
+	{
+		contacts.clear();
+	}
+};
+
+// Capture policies. OnSweptTest is called with the inputs and result of every swept test, to record real workloads (see SweptCapture).
+
+// Captures nothing, and is inlined away entirely.
+class NullSweptCapture
+{
+public:
+	void OnSweptTest(const AABB&, const AABB&, const glm::vec3&, float, float, float)
+	{
+	}
+};
+
+// Builds a config from template parameters.
+template <typename ScalarT, typename BroadphaseT, typename ResponseT, typename EventSinkT, bool InstrumentedT, typename CaptureT = NullSweptCapture>
+struct PhysicsConfig
+{
+	typedef ScalarT Scalar;
+	typedef BroadphaseT BroadphaseType;
+	typedef ResponseT ResponseType;
+	typedef EventSinkT EventSinkType;
+	static const bool Instrumented = InstrumentedT;
+	typedef CaptureT CaptureType;
+};
+
+// What the game uses: float math, the grid, bouncing like the demo, no events and no instrumentation.
+typedef PhysicsConfig<float, GridBroadphase, BounceResponse, NullEventSink, false> DefaultPhysicsConfig;
+
+// Counters and timings for the last step. Only filled in when the config is Instrumented.
+// The hardware counts of each phase are only filled in if the world was given PerfCounters (they stay zero otherwise).
+// Divide the collide phase's by pairsTested or bodiesIntegrated to see what each pair or body costs.
+struct PhysicsStats
+{
+	unsigned long long bodiesIntegrated;
+	unsigned long long pairsTested;
+	unsigned long long contacts;
+	double commandSeconds;
+	double collideSeconds;
+	double publishSeconds;
+	PerfCounts commandCounts;
+	PerfCounts collideCounts;
+	PerfCounts publishCounts;
+
+	PhysicsStats()
+	{
+		bodiesIntegrated = 0;
+		pairsTested = 0;
+		contacts = 0;
+		commandSeconds = 0.0;
+		collideSeconds = 0.0;
+		publishSeconds = 0.0;
+	}
+};
+
+template <typename Config>
+class PhysicsWorld
+{
+	typedef typename Config::Scalar Scalar;
+
+	World* world;
+
+	typename Config::BroadphaseType broadphase;
+	typename Config::ResponseType response;
+	typename Config::EventSinkType events;
+	typename Config::CaptureType capture;
+
+	PhysicsStats stats;
+	PerfCounters* counters;
+
+	static double Now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	PerfCounts Count()
+	{
+		return counters != nullptr ? counters->Read() : PerfCounts();
+	}
+
+	// Finds the earliest hit of one moving object against the candidates from the broadphase.
+	struct EarliestHit
+	{
+		PhysicsWorld* physics;
+		unsigned int self;
+		AABB box;
+		glm::vec3 move;
+
+		Scalar time;
+		Scalar normalx, normaly;
+		unsigned int other;
+
+		void operator()(unsigned int candidate)
+		{
+			if (candidate == self)
+			{
+				return;
+			}
+
+			if (Config::Instrumented)
+			{
+				physics->stats.pairsTested++;
+			}
+
+			Scalar nx, ny;
+			const AABB& candidateBox = physics->world->Boxes()[candidate];
+			Scalar t = SweptAABBGeneric<Scalar>(box, candidateBox, move, nx, ny);
+
+			physics->capture.OnSweptTest(box, candidateBox, move, (float)t, (float)nx, (float)ny);
+
+			if (t < time)
+			{
+				time = t;
+				normalx = nx;
+				normaly = ny;
+				other = candidate;
+			}
+		}
+	};
+
+public:
+	PhysicsWorld(World& inWorld)
+	{
+		world = &inWorld;
+		counters = nullptr;
+	}
+
+	// With an Instrumented config, reads these counters at the start and end of each phase (see PhysicsStats). They have to have been
+	// opened on the thread that runs Step. nullptr stops reading them.
+	void SetCounters(PerfCounters* inCounters)
+	{
+		counters = inCounters;
+	}
+
+	// Runs one full step of dt seconds: applies the queued commands, moves every object (colliding each moving object against
+	// everything the broadphase finds, treating the others as stationary like the demo does), then publishes the step.
+	void Step(float dt)
+	{
+		double start = 0.0, collideStart = 0.0, publishStart = 0.0;
+		PerfCounts startCounts, collideStartCounts, publishStartCounts;
+
+		if (Config::Instrumented)
+		{
+			stats = PhysicsStats();
+			startCounts = Count();
+			start = Now();
+		}
+
+		world->BeginStep();
+
+		if (Config::Instrumented)
+		{
+			collideStart = Now();
+			collideStartCounts = Count();
+		}
+
+		glm::vec3* velocities = world->Velocities();
+		AABB* boxes = world->Boxes();
+
+		for (unsigned int i = 0; i < world->NumObjects(); i++)
+		{
+			glm::vec3 move = velocities[i] * dt;
+
+			if (move.x != 0.0f || move.y != 0.0f)
+			{
+				// The box covering everywhere the object could be this step. Only objects overlapping it can be hit.
+				AABB sweptBox(glm::min(boxes[i].min, boxes[i].min + move), glm::max(boxes[i].max, boxes[i].max + move));
+
+				EarliestHit hit;
+				hit.physics = this;
+				hit.self = i;
+				hit.box = boxes[i];
+				hit.move = move;
+				hit.time = (Scalar)2;
+				hit.normalx = 0;
+				hit.normaly = 0;
+				hit.other = i;
+
+				broadphase.ForEachCandidate(*world, sweptBox, hit);
+
+				if (hit.time <= (Scalar)1)
+				{
+					// Move up to the contact, respond, then use whatever is left of the step.
+					float collisionTime = (float)hit.time;
+					world->UpdateObject(i, collisionTime * dt);
+
+					float keep = response.Respond(velocities[i], hit.normalx, hit.normaly);
+					world->UpdateObject(i, (1.0f - collisionTime) * dt * keep);
+
+					events.OnContact(world->HandleAt(i), world->HandleAt(hit.other), collisionTime, (float)hit.normalx, (float)hit.normaly);
+
+					if (Config::Instrumented)
+					{
+						stats.contacts++;
+					}
+				}
+				else
+				{
+					world->UpdateObject(i, dt);
+				}
+			}
+			else
+			{
+				world->UpdateObject(i, dt);
+			}
+
+			world->CalculateAABB(i);
+		}
+
+		if (Config::Instrumented)
+		{
+			stats.bodiesIntegrated = world->NumObjects();
+			publishStartCounts = Count();
+			publishStart = Now();
+		}
+
+		world->EndStep();
+
+		if (Config::Instrumented)
+		{
+			double end = Now();
+			PerfCounts endCounts = Count();
+			stats.commandSeconds = collideStart - start;
+			stats.collideSeconds = publishStart - collideStart;
+			stats.publishSeconds = end - publishStart;
+			stats.commandCounts = collideStartCounts - startCounts;
+			stats.collideCounts = publishStartCounts - collideStartCounts;
+			stats.publishCounts = endCounts - publishStartCounts;
+		}
+	}
+
+	World& GetWorld()
+	{
+		return *world;
+	}
+	const PhysicsStats& Stats()
+	{
+		return stats;
+	}
+	typename Config::BroadphaseType& Broadphase()
+	{
+		return broadphase;
+	}
+	typename Config::ResponseType& Response()
+	{
+		return response;
+	}
+	typename Config::EventSinkType& Events()
+	{
+		return events;
+	}
+	typename Config::CaptureType& Capture()
+	{
+		return capture;
+	}
+};
+
+// For tools (editors, debuggers, the benchmark runner) that want to pick a configuration at run time.
+// This costs one virtual call per step, not per object, so the step loop itself stays fully inlined.
+class PhysicsWorldInterface
+{
+public:
+	virtual ~PhysicsWorldInterface()
+	{
+	}
+
+	virtual void Step(float dt) = 0;
+	virtual const PhysicsStats& Stats() = 0;
+	virtual World& GetWorld() = 0;
+};
+
+template <typename Config>
+class PolymorphicPhysicsWorld : public PhysicsWorldInterface
+{
+	PhysicsWorld<Config> physics;
+
+public:
+	PolymorphicPhysicsWorld(World& world) : physics(world)
+	{
+	}
+
+	void Step(float dt)
+	{
+		physics.Step(dt);
+	}
+	const PhysicsStats& Stats()
+	{
+		return physics.Stats();
+	}
+	World& GetWorld()
+	{
+		return physics.GetWorld();
+	}
+	PhysicsWorld<Config>& Physics()
+	{
+		return physics;
+	}
+};
+
+#endif //_PHYSICS_WORLD_H
@@ -0,0 +1,279 @@
+/*
+Title: Swept AABB-2D
+File Name: RenderQueue.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _RENDER_QUEUE_CPP
+#define _RENDER_QUEUE_CPP
+
+#include "RenderQueue.h"
+#include "TransformBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+static double renderQueueTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned int RenderQueue::RegisterProgram(GLuint program, GLint uniMVP)
+{
+	programs.push_back(program);
+	programMVPs.push_back(uniMVP);
+	return (unsigned int)programs.size() - 1;
+}
+
+unsigned int RenderQueue::ModelId(Model* model)
+{
+	std::pair<std::unordered_map<Model*, unsigned int>::iterator, bool> inserted = modelIds.insert(std::make_pair(model, (unsigned int)models.size()));
+
+	if (inserted.second)
+	{
+		models.push_back(model);
+	}
+
+	return inserted.first->second;
+}
+
+void RenderQueue::Clear()
+{
+	commands.clear();
+	stats = RenderQueueStats();
+}
+
+void RenderQueue::Add(unsigned long long key, unsigned int object)
+{
+	RenderCommand command;
+	command.key = key;
+	command.object = object;
+	commands.push_back(command);
+}
+
+void RenderQueue::FillRange(World& world, const std::vector<unsigned int>* visible, unsigned int programId, unsigned int first, unsigned int begin, unsigned int end)
+{
+	Model** objectModels = world.Models();
+	RenderCommand* out = commands.data() + first;
+
+	// The model map is only read here (other threads are reading it too), so a model without an id is marked and sorted out afterwards.
+	// Objects next to each other usually share a model, so the last lookup is remembered.
+	Model* lastModel = nullptr;
+	unsigned int lastId = UnknownModel;
+
+	for (unsigned int k = begin; k < end; k++)
+	{
+		unsigned int i = visible != nullptr ? (*visible)[k] : k;
+
+		if (objectModels[i] != lastModel || lastId == UnknownModel)
+		{
+			std::unordered_map<Model*, unsigned int>::const_iterator found = modelIds.find(objectModels[i]);
+			lastModel = objectModels[i];
+			lastId = found != modelIds.end() ? found->second : UnknownModel;
+		}
+
+		out[k].key = MakeKey(programId, lastId, 0);
+		out[k].object = i;
+	}
+}
+
+void RenderQueue::Fill(World& world, const std::vector<unsigned int>* visible, unsigned int programId, int numThreads)
+{
+	double start = renderQueueTime();
+
+	unsigned int count = visible != nullptr ? (unsigned int)visible->size() : world.NumObjects();
+	unsigned int first = (unsigned int)commands.size();
+	commands.resize(first + count);
+
+	// Starting threads isn't free, so small queues are filled on this one.
+	if (numThreads <= 0)
+	{
+		numThreads = count < 4096 ? 1 : (int)std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	if (numThreads == 1)
+	{
+		FillRange(world, visible, programId, first, 0, count);
+	}
+	else
+	{
+		// Every thread gets its own slice of the commands, so they never write to the same place.
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numThreads; t++)
+		{
+			unsigned int begin = (unsigned int)((unsigned long long)count * t / numThreads);
+			unsigned int end = (unsigned int)((unsigned long long)count * (t + 1) / numThreads);
+			threads.push_back(std::thread(&RenderQueue::FillRange, this, std::ref(world), visible, programId, first, begin, end));
+		}
+		for (unsigned int t = 0; t < threads.size(); t++)
+		{
+			threads[t].join();
+		}
+	}
+
+	// Give ids to any models the threads hadn't seen before. This only happens the first time a model is drawn.
+	for (unsigned int c = first; c < commands.size(); c++)
+	{
+		if (((commands[c].key >> 24) & 0xFFFFFF) == UnknownModel)
+		{
+			commands[c].key = MakeKey(programId, ModelId(world.Models()[commands[c].object]), (unsigned int)(commands[c].key & 0xFFFFFF));
+		}
+	}
+
+	stats.fillSeconds += renderQueueTime() - start;
+}
+
+void RenderQueue::Sort()
+{
+	double start = renderQueueTime();
+
+	unsigned int count = (unsigned int)commands.size();
+	if (count == 0)
+	{
+		return;
+	}
+
+	sortScratch.resize(count);
+
+	// Count how many keys have each value of each byte, all 8 bytes in one go.
+	memset(counts, 0, sizeof(counts));
+
+	for (unsigned int c = 0; c < count; c++)
+	{
+		unsigned long long key = commands[c].key;
+		for (int b = 0; b < 8; b++)
+		{
+			counts[b][(key >> (b * 8)) & 0xFF]++;
+		}
+	}
+
+	RenderCommand* from = commands.data();
+	RenderCommand* to = sortScratch.data();
+
+	// Least significant byte first. Each pass is stable, so after the last one the keys are sorted on every byte.
+	for (int b = 0; b < 8; b++)
+	{
+		// If every key has the same value in this byte, the pass wouldn't move anything. With few programs and models most bytes are like this.
+		if (counts[b][(from[0].key >> (b * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		// Turn the counts into where each value's keys start.
+		unsigned int offsets[256];
+		unsigned int total = 0;
+		for (int v = 0; v < 256; v++)
+		{
+			offsets[v] = total;
+			total += counts[b][v];
+		}
+
+		for (unsigned int c = 0; c < count; c++)
+		{
+			to[offsets[(from[c].key >> (b * 8)) & 0xFF]++] = from[c];
+		}
+
+		std::swap(from, to);
+	}
+
+	// An odd number of passes leaves the result in the scratch array.
+	if (from != commands.data())
+	{
+		commands.swap(sortScratch);
+	}
+
+	stats.sortSeconds += renderQueueTime() - start;
+}
+
+void RenderQueue::Execute(World& world, const glm::mat4& PV, SceneGraph* sceneGraph)
+{
+	double start = renderQueueTime();
+
+	// Start with nothing bound, so the first command sets everything.
+	unsigned int currentProgram = 0xFFFFFFFF;
+	unsigned int currentModel = 0xFFFFFFFF;
+	unsigned int currentMaterial = 0xFFFFFFFF;
+
+	for (unsigned int c = 0; c < commands.size(); c++)
+	{
+		unsigned long long key = commands[c].key;
+		unsigned int programId = (unsigned int)(key >> 48);
+		unsigned int modelId = (unsigned int)((key >> 24) & 0xFFFFFF);
+		unsigned int material = (unsigned int)(key & 0xFFFFFF);
+
+		if (programId != currentProgram)
+		{
+			glUseProgram(programs[programId]);
+			currentProgram = programId;
+			stats.programChanges++;
+		}
+		if (modelId != currentModel)
+		{
+			models[modelId]->Bind();
+			currentModel = modelId;
+			stats.modelChanges++;
+		}
+		if (material != currentMaterial)
+		{
+			// Nothing to set yet, but it's counted so the stats show what sorting on it would save.
+			currentMaterial = material;
+			stats.materialChanges++;
+		}
+
+		// Attached objects use the transform from the scene graph, since it includes the rotation of their local transform.
+		unsigned int i = commands[c].object;
+		const glm::mat4* attached = sceneGraph != nullptr ? sceneGraph->GetWorldTransform(world.HandleAt(i)) : nullptr;
+
+		glm::mat4 objMVP;
+		if (attached != nullptr)
+		{
+			objMVP = PV * *attached;
+		}
+		else
+		{
+			computeMVPs(PV, 1, world.Positions() + i, world.Scales() + i, &objMVP);
+		}
+
+		glUniformMatrix4fv(programMVPs[programId], 1, GL_FALSE, glm::value_ptr(objMVP));
+		models[modelId]->Draw();
+		stats.draws++;
+	}
+
+	stats.commands = (unsigned int)commands.size();
+	stats.executeSeconds += renderQueueTime() - start;
+}
+
+#endif // _RENDER_QUEUE_CPP
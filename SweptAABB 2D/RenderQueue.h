@@ -0,0 +1,145 @@
+/*
+Title: Swept AABB-2D
+File Name: RenderQueue.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _RENDER_QUEUE_H
+#define _RENDER_QUEUE_H
+
+#include "World.h"
+#include "SceneGraph.h"
+#include <unordered_map>
+#include <vector>
+
+// One thing to draw: which object, and a key saying what OpenGL state it needs.
+struct RenderCommand
+{
+	unsigned long long key;
+	unsigned int object;	// Dense index into the world
+};
+
+// How much work the last frame took.
+struct RenderQueueStats
+{
+	unsigned int commands;
+	unsigned int draws;
+	unsigned int programChanges;
+	unsigned int modelChanges;
+	unsigned int materialChanges;
+	double fillSeconds;
+	double sortSeconds;
+	double executeSeconds;
+
+	RenderQueueStats()
+	{
+		commands = 0;
+		draws = 0;
+		programChanges = 0;
+		modelChanges = 0;
+		materialChanges = 0;
+		fillSeconds = 0.0;
+		sortSeconds = 0.0;
+		executeSeconds = 0.0;
+	}
+};
+
+// Instead of drawing objects in whatever order they sit in the world (switching programs and buffers back and forth), we first write a command
+// per object with a 64-bit sort key, sort all the keys once, and then draw in key order. Objects that need the same state end up next to each other,
+// so the state only has to change when the key does.
+//
+// The key, from most to least important:
+//     bits 48-63: program id (switching programs is the most expensive change, so it's sorted on first)
+//     bits 24-47: model id (binding a different vertex and index buffer)
+//     bits 0-23:  material (nothing uses this yet, it's there so it can be sorted on without changing the key layout)
+class RenderQueue
+{
+	// Ids in the keys are indices into these.
+	std::vector<GLuint> programs;
+	std::vector<GLint> programMVPs;	// The location of each program's MVP uniform
+	std::vector<Model*> models;
+	std::unordered_map<Model*, unsigned int> modelIds;
+
+	std::vector<RenderCommand> commands;
+	std::vector<RenderCommand> sortScratch;
+	unsigned int counts[8][256];
+
+	RenderQueueStats stats;
+
+	// Writes the commands for objects [begin, end) of the list, starting at command first. Run by each fill thread on its own part of the commands.
+	void FillRange(World&, const std::vector<unsigned int>* visible, unsigned int programId, unsigned int first, unsigned int begin, unsigned int end);
+
+	unsigned int ModelId(Model*);
+
+public:
+	// The model id a fill thread writes when it finds a model that hasn't been given an id yet. Fixed up after the threads finish.
+	static const unsigned int UnknownModel = 0xFFFFFF;
+
+	static unsigned long long MakeKey(unsigned int programId, unsigned int modelId, unsigned int material)
+	{
+		return ((unsigned long long)(programId & 0xFFFF) << 48) | ((unsigned long long)(modelId & 0xFFFFFF) << 24) | (material & 0xFFFFFF);
+	}
+
+	// Gives a program an id to be used in keys. uniMVP is where its MVP uniform is.
+	unsigned int RegisterProgram(GLuint program, GLint uniMVP);
+
+	// Empties the queue and the stats for a new frame.
+	void Clear();
+
+	// Adds one command by hand.
+	void Add(unsigned long long key, unsigned int object);
+
+	// Adds a command for every object in the world (or only the visible ones, if given), all using the program with id programId.
+	// Large worlds are split between numThreads threads (0 picks based on the number of objects). Each thread writes its own part of the queue.
+	void Fill(World&, const std::vector<unsigned int>* visible, unsigned int programId, int numThreads = 0);
+
+	// Sorts the commands by key with a radix sort: 8 passes of 8 bits each, skipping any byte that is the same in every key.
+	void Sort();
+
+	// Draws every command in order, only switching program, model or material when the key changes. Attached objects use the scene graph's
+	// transform (if one is given), everything else gets its MVP built from its position and scale.
+	void Execute(World&, const glm::mat4& PV, SceneGraph* sceneGraph = nullptr);
+
+	const std::vector<RenderCommand>& Commands()
+	{
+		return commands;
+	}
+	const RenderQueueStats& Stats()
+	{
+		return stats;
+	}
+};
+
+#endif //_RENDER_QUEUE_H
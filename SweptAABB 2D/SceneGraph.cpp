@@ -0,0 +1,342 @@
+/*
+Title: Swept AABB-2D
+File Name: SceneGraph.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SCENE_GRAPH_CPP
+#define _SCENE_GRAPH_CPP
+
+#include "SceneGraph.h"
+#include <algorithm>
+#include <thread>
+
+SceneGraph::SceneGraph()
+{
+	structureDirty = false;
+}
+
+SceneGraph::NodeInfo& SceneGraph::InfoFor(ObjectHandle handle)
+{
+	if (handle.index >= info.size())
+	{
+		NodeInfo empty;
+		empty.attached = false;
+		info.resize(handle.index + 1, empty);
+	}
+
+	// If the slot belonged to an object that has since been destroyed, start over with a fresh node.
+	NodeInfo& node = info[handle.index];
+	if (node.attached && node.handle != handle)
+	{
+		node.attached = false;
+	}
+
+	return node;
+}
+
+void SceneGraph::Attach(ObjectHandle child, ObjectHandle parent, const glm::mat4& local)
+{
+	if (child.IsNull() || parent.IsNull() || child == parent)
+	{
+		return;
+	}
+
+	// Don't allow attaching an object to one of its own descendants, since that would make a loop.
+	ObjectHandle ancestor = parent;
+	while (!ancestor.IsNull() && ancestor.index < info.size() && info[ancestor.index].attached && info[ancestor.index].handle == ancestor)
+	{
+		if (ancestor == child)
+		{
+			return;
+		}
+
+		ancestor = info[ancestor.index].parent;
+	}
+
+	// A parent that isn't in the graph yet becomes a root.
+	NodeInfo& parentNode = InfoFor(parent);
+	if (!parentNode.attached)
+	{
+		parentNode.handle = parent;
+		parentNode.parent = ObjectHandle();
+		parentNode.local = glm::mat4();
+		parentNode.attached = true;
+	}
+
+	NodeInfo& childNode = InfoFor(child);
+	childNode.handle = child;
+	childNode.parent = parent;
+	childNode.local = local;
+	childNode.attached = true;
+
+	structureDirty = true;
+}
+
+void SceneGraph::Detach(ObjectHandle handle)
+{
+	if (handle.index >= info.size() || !info[handle.index].attached || info[handle.index].handle != handle)
+	{
+		return;
+	}
+
+	// It stays in the graph as a root, so anything attached to it keeps following it.
+	info[handle.index].parent = ObjectHandle();
+	info[handle.index].local = glm::mat4();
+
+	structureDirty = true;
+}
+
+void SceneGraph::SetLocalTransform(ObjectHandle handle, const glm::mat4& local)
+{
+	if (handle.index >= info.size() || !info[handle.index].attached || info[handle.index].handle != handle)
+	{
+		return;
+	}
+
+	info[handle.index].local = local;
+
+	// If the flat arrays are still good, just update them and mark the node, so only its subtree gets recalculated.
+	if (!structureDirty && flatIndex[handle.index] >= 0)
+	{
+		locals[flatIndex[handle.index]] = local;
+		dirty[flatIndex[handle.index]] = 1;
+	}
+}
+
+const glm::mat4* SceneGraph::GetWorldTransform(ObjectHandle handle)
+{
+	if (structureDirty || handle.index >= flatIndex.size() || flatIndex[handle.index] < 0 || handles[flatIndex[handle.index]] != handle)
+	{
+		return nullptr;
+	}
+
+	return &worlds[flatIndex[handle.index]];
+}
+
+void SceneGraph::Rebuild(World& world)
+{
+	// Forget about objects that were destroyed. Their children become roots.
+	for (unsigned int i = 0; i < info.size(); i++)
+	{
+		if (info[i].attached && !world.IsValid(info[i].handle))
+		{
+			info[i].attached = false;
+		}
+	}
+
+	// Link up each node's children as a list (first child, next sibling), indexed by slot index.
+	std::vector<int> firstChild(info.size(), -1);
+	std::vector<int> nextSibling(info.size(), -1);
+	std::vector<int> rootSlots;
+
+	for (unsigned int i = 0; i < info.size(); i++)
+	{
+		if (!info[i].attached)
+		{
+			continue;
+		}
+
+		ObjectHandle parent = info[i].parent;
+		if (parent.IsNull() || !info[parent.index].attached || info[parent.index].handle != parent)
+		{
+			info[i].parent = ObjectHandle();
+			rootSlots.push_back(i);
+		}
+		else
+		{
+			nextSibling[i] = firstChild[parent.index];
+			firstChild[parent.index] = i;
+		}
+	}
+
+	handles.clear();
+	parents.clear();
+	locals.clear();
+	roots.clear();
+	flatIndex.assign(info.size(), -1);
+
+	// Walk each tree depth first, so every subtree ends up as one contiguous range that starts with its root.
+	std::vector<int> stack;
+	for (unsigned int r = 0; r < rootSlots.size(); r++)
+	{
+		roots.push_back((int)handles.size());
+		stack.push_back(rootSlots[r]);
+
+		while (!stack.empty())
+		{
+			int slot = stack.back();
+			stack.pop_back();
+
+			flatIndex[slot] = (int)handles.size();
+			handles.push_back(info[slot].handle);
+			locals.push_back(info[slot].local);
+			parents.push_back(info[slot].parent.IsNull() ? -1 : flatIndex[info[slot].parent.index]);
+
+			for (int c = firstChild[slot]; c != -1; c = nextSibling[c])
+			{
+				stack.push_back(c);
+			}
+		}
+	}
+
+	// Children always come after their parent, so walking backwards lets each node push its subtree's end up to its parent.
+	int numNodes = (int)handles.size();
+	subtreeEnds.resize(numNodes);
+	for (int i = 0; i < numNodes; i++)
+	{
+		subtreeEnds[i] = i + 1;
+	}
+	for (int i = numNodes - 1; i >= 0; i--)
+	{
+		if (parents[i] >= 0)
+		{
+			subtreeEnds[parents[i]] = std::max(subtreeEnds[parents[i]], subtreeEnds[i]);
+		}
+	}
+
+	// Everything is new, so everything gets calculated on the next pass.
+	worlds.assign(numNodes, glm::mat4());
+	worldBoxes.assign(numNodes, AABB());
+	dirty.assign(numNodes, 1);
+	changed.assign(numNodes, 0);
+
+	structureDirty = false;
+}
+
+void SceneGraph::PropagateRange(World& world, int start, int end)
+{
+	for (int i = start; i < end; i++)
+	{
+		unsigned int dense = world.DenseIndex(handles[i]);
+		int parent = parents[i];
+
+		if (parent < 0)
+		{
+			// Roots are moved by the physics, so their transform comes from the world. If it didn't change, neither do their children.
+			glm::mat4 transform = world.GetTransform(dense);
+			changed[i] = dirty[i] || transform != worlds[i];
+			worlds[i] = transform;
+		}
+		else
+		{
+			changed[i] = dirty[i] || changed[parent];
+
+			if (changed[i])
+			{
+				worlds[i] = worlds[parent] * locals[i];
+
+				// Transform the corners of the model's bounds to find the new AABB, like GameObject::CalculateAABB does with every vertex.
+				AABB localBox = world.GetLocalBox(dense);
+				for (int c = 0; c < 4; c++)
+				{
+					glm::vec4 corner = worlds[i] * glm::vec4((c & 1) ? localBox.max.x : localBox.min.x, (c & 2) ? localBox.max.y : localBox.min.y, localBox.min.z, 1.0f);
+
+					if (c == 0)
+					{
+						worldBoxes[i].min = glm::vec3(corner);
+						worldBoxes[i].max = glm::vec3(corner);
+					}
+					else
+					{
+						worldBoxes[i].min = glm::min(worldBoxes[i].min, glm::vec3(corner));
+						worldBoxes[i].max = glm::max(worldBoxes[i].max, glm::vec3(corner));
+					}
+				}
+			}
+
+			// The physics may have moved the child on its own, so always put it back where its parent says it is. (This is just a copy.)
+			world.Positions()[dense] = glm::vec3(worlds[i][3]);
+			world.Boxes()[dense] = worldBoxes[i];
+		}
+
+		dirty[i] = 0;
+	}
+}
+
+void SceneGraph::Propagate(World& world, int numThreads)
+{
+	// A destroyed object means the tree has to be rebuilt without it.
+	for (unsigned int i = 0; i < handles.size() && !structureDirty; i++)
+	{
+		if (!world.IsValid(handles[i]))
+		{
+			structureDirty = true;
+		}
+	}
+
+	if (structureDirty)
+	{
+		Rebuild(world);
+	}
+
+	int numNodes = (int)handles.size();
+
+	// Starting threads isn't free, so small graphs just run on this one.
+	if (numThreads <= 0)
+	{
+		numThreads = numNodes < 4096 ? 1 : (int)std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	if (numThreads == 1 || roots.size() < 2)
+	{
+		PropagateRange(world, 0, numNodes);
+		return;
+	}
+
+	// Split the roots into numThreads groups of about the same number of nodes. Each group is a contiguous range of the flat arrays,
+	// and no two groups share a tree, so the threads never write to the same node or the same world object.
+	std::vector<std::thread> threads;
+	int nodesPerThread = numNodes / numThreads + 1;
+	int start = 0;
+
+	for (unsigned int r = 0; r < roots.size(); r++)
+	{
+		int end = subtreeEnds[roots[r]];
+
+		if (end - start >= nodesPerThread || r == roots.size() - 1)
+		{
+			threads.push_back(std::thread(&SceneGraph::PropagateRange, this, std::ref(world), start, end));
+			start = end;
+		}
+	}
+
+	for (unsigned int t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+}
+
+#endif // _SCENE_GRAPH_CPP
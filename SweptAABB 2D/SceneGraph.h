@@ -0,0 +1,112 @@
+/*
+Title: Swept AABB-2D
+File Name: SceneGraph.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SCENE_GRAPH_H
+#define _SCENE_GRAPH_H
+
+#include "World.h"
+#include <vector>
+
+// Attaches world objects to other world objects (a turret to a tank, for example), so that children follow their parents around.
+// Every child has a local transform relative to its parent. Propagate() multiplies these down the tree and writes each child's
+// world position and AABB back into the World, so the broadphase and collision see the children where they actually are.
+// Objects that have children but no parent are roots. Roots are moved by the physics like any other object, and the graph just reads their transform.
+//
+// Internally the nodes are kept in flat arrays sorted parents-before-children (depth first), so a single loop can compute every world matrix,
+// and each root's whole subtree is one contiguous range of the arrays. Different roots' ranges share nothing, so they can run on different threads.
+class SceneGraph
+{
+	// What we know about each attached object, indexed by the slot index of its handle. This is what Attach/Detach change.
+	struct NodeInfo
+	{
+		ObjectHandle handle;
+		ObjectHandle parent;	// Null for a root.
+		glm::mat4 local;
+		bool attached;
+	};
+	std::vector<NodeInfo> info;
+
+	// The flat, depth-first arrays used by Propagate(). They are rebuilt from info whenever the shape of the tree changes.
+	std::vector<ObjectHandle> handles;
+	std::vector<int> parents;			// Flat index of the parent, or -1 for a root.
+	std::vector<int> subtreeEnds;		// Node i's subtree is the range [i, subtreeEnds[i]).
+	std::vector<glm::mat4> locals;
+	std::vector<glm::mat4> worlds;
+	std::vector<AABB> worldBoxes;
+	std::vector<unsigned char> dirty;	// The local transform changed since the last Propagate().
+	std::vector<unsigned char> changed;	// Set during Propagate() for nodes whose world matrix was recalculated.
+	std::vector<int> roots;				// Flat index of every root.
+
+	// The flat index of each slot index, or -1 if it isn't in the flat arrays.
+	std::vector<int> flatIndex;
+
+	bool structureDirty;
+
+	void Rebuild(World&);
+	void PropagateRange(World&, int, int);
+	NodeInfo& InfoFor(ObjectHandle);
+
+public:
+	SceneGraph();
+
+	// Attaches child to parent with the given local transform (relative to the parent's transform, so it includes the parent's scale).
+	// If the child was attached somewhere else it moves, along with its own children.
+	void Attach(ObjectHandle child, ObjectHandle parent, const glm::mat4& local);
+
+	// Detaches the object from its parent. Its own children stay attached to it, and it goes back to being moved by the physics.
+	void Detach(ObjectHandle);
+
+	// Changes the transform of a child relative to its parent. Only that child's subtree is recalculated in the next Propagate().
+	void SetLocalTransform(ObjectHandle, const glm::mat4&);
+
+	// Recalculates the world transform of every child whose local transform or parent changed, and writes its position and AABB into the world.
+	// Run this after the physics moved everything and before World::EndStep(), which updates the broadphase.
+	// numThreads = 0 uses one thread per core when there's enough work to be worth it.
+	void Propagate(World&, int numThreads = 0);
+
+	// The world matrix of an attached object from the last Propagate(), or nullptr if it isn't attached to anything.
+	// Use this instead of World::GetTransform for rendering, since it includes the rotation of the local transforms.
+	const glm::mat4* GetWorldTransform(ObjectHandle);
+
+	int NumNodes()
+	{
+		return (int)handles.size();
+	}
+};
+
+#endif //_SCENE_GRAPH_H
@@ -0,0 +1,435 @@
+/*
+Title: Swept AABB-2D
+File Name: ShaderLoader.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SHADER_LOADER_CPP
+#define _SHADER_LOADER_CPP
+
+#include "ShaderLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#endif
+
+#ifdef EMBEDDED_SHADERS
+// Made at build time from the .glsl files by EmbedShaders.cmake.
+#include "EmbeddedShaders.h"
+#endif
+
+// GLEW 1.13 is older than GL_KHR_parallel_shader_compile, so the one function we use from it is declared here.
+typedef void (APIENTRY *MaxShaderCompilerThreadsProc)(GLuint count);
+
+// This method reads the text from a file.
+// The shaders are normally built into the program (see loadShaderSource), but when they aren't, they're read in from the separate .glsl files with this.
+std::string readShader(std::string fileName)
+{
+	std::string shaderCode;
+	std::string line;
+
+	// We choose ifstream and std::ios::in because we are opening the file for input into our program.
+	// If we were writing to the file, we would use ofstream and std::ios::out.
+	std::ifstream file(fileName, std::ios::in);
+
+	// This checks to make sure that we didn't encounter any errors when getting the file.
+	if (!file.good())
+	{
+		std::cout << "Can't read file: " << fileName.data() << std::endl;
+
+		// Return so we don't error out.
+		return "";
+	}
+
+	// ifstream keeps an internal "get" position determining the location of the element to be read next
+	// seekg allows you to modify this location, and tellg allows you to get this location
+	// This location is stored as a streampos member type, and the parameters passed in must be of this type as well
+	// seekg parameters are (offset, direction) or you can just use an absolute (position).
+	// The offset parameter is of the type streamoff, and the direction is of the type seekdir (an enum which can be ios::beg, ios::cur, or ios::end referring to the beginning, 
+	// current position, or end of the stream).
+	file.seekg(0, std::ios::end);					// Moves the "get" position to the end of the file.
+	shaderCode.resize((unsigned int)file.tellg());	// Resizes the shaderCode string to the size of the file being read, given that tellg will give the current "get" which is at the end of the file.
+	file.seekg(0, std::ios::beg);					// Moves the "get" position to the start of the file.
+
+													// File streams contain two member functions for reading and writing binary data (read, write). The read function belongs to ifstream, and the write function belongs to ofstream.
+													// The parameters are (memoryBlock, size) where memoryBlock is of type char* and represents the address of an array of bytes are to be read from/written to.
+													// The size parameter is an integer that determines the number of characters to be read/written from/to the memory block.
+	file.read(&shaderCode[0], shaderCode.size());	// Reads from the file (starting at the "get" position which is currently at the start of the file) and writes that data to the beginning
+													// of the shaderCode variable, up until the full size of shaderCode. This is done with binary data, which is why we must ensure that the sizes are all correct.
+
+	file.close(); // Now that we're done, close the file and return the shaderCode.
+
+	return shaderCode;
+}
+
+// This method will consolidate some of the shader code we've written to return a GLuint to the compiled shader.
+// It only requires the shader source code and the shader type.
+GLuint createShader(std::string sourceCode, GLenum shaderType)
+{
+	// glCreateShader, creates a shader given a type (such as GL_VERTEX_SHADER) and returns a GLuint reference to that shader.
+	GLuint shader = glCreateShader(shaderType);
+	const char *shader_code_ptr = sourceCode.c_str(); // We establish a pointer to our shader code string
+	const int shader_code_size = sourceCode.size();   // And we get the size of that string.
+
+													  // glShaderSource replaces the source code in a shader object
+													  // It takes the reference to the shader (a GLuint), a count of the number of elements in the string array (in case you're passing in multiple strings), a pointer to the string array 
+													  // that contains your source code, and a size variable determining the length of the array.
+	glShaderSource(shader, 1, &shader_code_ptr, &shader_code_size);
+	glCompileShader(shader); // This just compiles the shader, given the source code.
+
+	// We don't check whether it compiled here, since asking blocks until the compile is done. Leaving the asking until every shader has been
+	// started (checkShader, from ProgramCache::Finish) lets a driver with parallel shader compile work on all of them at once. Nothing polls
+	// for completion in between: Finish simply blocks on each one in turn.
+	return shader;
+}
+
+// Checks whether a shader from createShader compiled. If it didn't, prints the error, deletes the shader and returns false.
+bool checkShader(GLuint shader)
+{
+	GLint isCompiled = 0;
+
+	// Check the compile status to see if the shader compiled correctly.
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+
+	if (isCompiled == GL_FALSE)
+	{
+		char infolog[1024];
+		glGetShaderInfoLog(shader, 1024, NULL, infolog);
+
+		// Print the compile error.
+		std::cout << "The shader failed to compile with the error:" << std::endl << infolog << std::endl;
+
+		// Provide the infolog in whatever manor you deem best.
+		// Exit with failure.
+		glDeleteShader(shader); // Don't leak the shader.
+
+								// NOTE: I almost always put a break point here, so that instead of the program continuing with a deleted/failed shader, it stops and gives me a chance to look at what may 
+								// have gone wrong. You can check the console output to see what the error was, and usually that will point you in the right direction.
+		return false;
+	}
+
+	return true;
+}
+
+std::string loadShaderSource(const std::string& name)
+{
+#ifdef EMBEDDED_SHADERS
+	for (int i = 0; embeddedShaders[i].name != nullptr; i++)
+	{
+		if (name == embeddedShaders[i].name)
+		{
+			return embeddedShaders[i].source;
+		}
+	}
+#endif
+
+	// Not built in, so it has to come from the file, which sits one folder up from where the program runs.
+	return readShader("../" + name);
+}
+
+std::string enableVertexPulling(std::string sourceCode)
+{
+	size_t version = sourceCode.find("#version");
+	size_t lineEnd = sourceCode.find('\n', version);
+
+	if (version == std::string::npos || lineEnd == std::string::npos)
+	{
+		return sourceCode;
+	}
+
+	return sourceCode.substr(0, version) + "#version 430 core\n#define VERTEX_PULLING" + sourceCode.substr(lineEnd);
+}
+
+// Whether the current context has the extension. This asks OpenGL itself rather than glfwExtensionSupported, which only works with a GLFW
+// window's context current, and the headless EGL context isn't one.
+static bool hasExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != nullptr && strcmp(extension, name) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Looks up an OpenGL function with whichever library made the current context: EGL for the headless context, GLFW for a window.
+static void* getGLFunction(const char* name)
+{
+#ifdef HEADLESS_EGL
+	if (eglGetCurrentContext() != EGL_NO_CONTEXT)
+	{
+		return (void*)eglGetProcAddress(name);
+	}
+#endif
+
+	return (void*)glfwGetProcAddress(name);
+}
+
+bool enableParallelShaderCompile()
+{
+	// The ARB version came first and has the same enums, only the function name differs.
+	const char* function = nullptr;
+	if (hasExtension("GL_KHR_parallel_shader_compile"))
+	{
+		function = "glMaxShaderCompilerThreadsKHR";
+	}
+	else if (hasExtension("GL_ARB_parallel_shader_compile"))
+	{
+		function = "glMaxShaderCompilerThreadsARB";
+	}
+
+	MaxShaderCompilerThreadsProc maxShaderCompilerThreads = function != nullptr ? (MaxShaderCompilerThreadsProc)getGLFunction(function) : nullptr;
+	if (maxShaderCompilerThreads == nullptr)
+	{
+		return false;
+	}
+
+	// 0xFFFFFFFF lets the driver use as many threads as it likes.
+	maxShaderCompilerThreads(0xFFFFFFFF);
+	return true;
+}
+
+// FNV-1a, which is plenty for telling shader sources apart.
+static unsigned long long hashBytes(unsigned long long hash, const std::string& bytes)
+{
+	for (unsigned int i = 0; i < bytes.size(); i++)
+	{
+		hash = (hash ^ (unsigned char)bytes[i]) * 1099511628211ull;
+	}
+
+	// A separator, so "ab" + "c" and "a" + "bc" don't hash the same.
+	return (hash ^ 0xFF) * 1099511628211ull;
+}
+
+// What a cache file starts with, to catch files that aren't ours or were cut short.
+static const unsigned int programCacheMagic = 0x42505753;	// "SWPB"
+
+struct ProgramCacheHeader
+{
+	unsigned int magic;
+	unsigned int format;
+	unsigned int length;
+};
+
+ProgramCache::ProgramCache(const std::string& cacheDirectory, bool useBinaries)
+{
+	directory = cacheDirectory;
+	loaded = 0;
+	compiled = 0;
+
+	// The driver (and its version) is part of every key: a binary from a different driver or an older version of this one won't load.
+	driver = std::string((const char*)glGetString(GL_VENDOR)) + "|" + (const char*)glGetString(GL_RENDERER) + "|" + (const char*)glGetString(GL_VERSION);
+
+	// Binaries need OpenGL 4.1 (or ARB_get_program_binary), and a driver that supports at least one binary format.
+	GLint numFormats = 0;
+	binaries = useBinaries && (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary);
+	if (binaries)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		binaries = numFormats > 0;
+	}
+
+	parallel = enableParallelShaderCompile();
+}
+
+std::string ProgramCache::FileName(unsigned long long hash)
+{
+	char name[32];
+	sprintf(name, "program_%016llx.bin", hash);
+	return directory + name;
+}
+
+bool ProgramCache::Load(GLuint program, unsigned long long hash)
+{
+	std::ifstream file(FileName(hash), std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		return false;
+	}
+
+	ProgramCacheHeader header;
+	file.read((char*)&header, sizeof(header));
+	if (!file.good() || header.magic != programCacheMagic)
+	{
+		return false;
+	}
+
+	// A damaged (or someone else's) file could claim any length at all, so check it against what's really left in the file before making room for it.
+	std::streamoff start = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff remaining = file.tellg() - start;
+	file.seekg(start);
+	if (header.length == 0 || (std::streamoff)header.length > remaining)
+	{
+		return false;
+	}
+
+	std::vector<char> binary(header.length);
+	file.read(binary.data(), header.length);
+	if (!file.good())
+	{
+		return false;
+	}
+
+	// The driver can still turn the binary down (after an update, say), in which case the program just isn't linked and we compile it instead.
+	glProgramBinary(program, header.format, binary.data(), header.length);
+
+	GLint isLinked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	return isLinked == GL_TRUE;
+}
+
+void ProgramCache::Save(GLuint program, unsigned long long hash)
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+	ProgramCacheHeader header;
+	header.magic = programCacheMagic;
+	header.format = format;
+	header.length = (unsigned int)length;
+
+	std::ofstream file(FileName(hash), std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+}
+
+GLuint ProgramCache::Begin(const std::string& vertexSource, const std::string& fragmentSource)
+{
+	PendingProgram pending;
+	pending.program = glCreateProgram();
+	pending.hash = hashBytes(hashBytes(hashBytes(14695981039346656037ull, driver), vertexSource), fragmentSource);
+	pending.vertexShader = 0;
+	pending.fragmentShader = 0;
+
+	if (binaries && Load(pending.program, pending.hash))
+	{
+		loaded++;
+		return pending.program;
+	}
+
+	pending.vertexShader = createShader(vertexSource, GL_VERTEX_SHADER);
+	pending.fragmentShader = createShader(fragmentSource, GL_FRAGMENT_SHADER);
+
+	glAttachShader(pending.program, pending.vertexShader);
+	glAttachShader(pending.program, pending.fragmentShader);
+
+	// Tell the driver we'll want the binary back, which some drivers need to know before linking.
+	if (binaries)
+	{
+		glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	glLinkProgram(pending.program);
+
+	programs.push_back(pending);
+	compiled++;
+
+	return pending.program;
+}
+
+bool ProgramCache::Finish()
+{
+	bool allLinked = true;
+
+	for (unsigned int i = 0; i < programs.size(); i++)
+	{
+		PendingProgram& pending = programs[i];
+
+		// These are the first questions asked about each shader and program, so this is where we wait for the compiles and links to finish.
+		// Both are always checked, so both get their errors printed.
+		bool vertexCompiled = checkShader(pending.vertexShader);
+		bool fragmentCompiled = checkShader(pending.fragmentShader);
+
+		GLint isLinked = 0;
+		glGetProgramiv(pending.program, GL_LINK_STATUS, &isLinked);
+
+		bool linked = vertexCompiled && fragmentCompiled && isLinked == GL_TRUE;
+
+		if (linked && binaries)
+		{
+			Save(pending.program, pending.hash);
+		}
+		else if (vertexCompiled && fragmentCompiled && isLinked != GL_TRUE)
+		{
+			char infolog[1024];
+			glGetProgramInfoLog(pending.program, 1024, NULL, infolog);
+			std::cout << "The program failed to link with the error:" << std::endl << infolog << std::endl;
+		}
+
+		// The shaders aren't needed anymore either way: a linked program keeps its own copy of the compiled code, and a failed one is thrown away.
+		// checkShader already deleted any shader that failed, but it stays around (attached to the program) until it's detached.
+		glDetachShader(pending.program, pending.vertexShader);
+		glDetachShader(pending.program, pending.fragmentShader);
+		if (vertexCompiled)
+		{
+			glDeleteShader(pending.vertexShader);
+		}
+		if (fragmentCompiled)
+		{
+			glDeleteShader(pending.fragmentShader);
+		}
+
+		if (!linked)
+		{
+			glDeleteProgram(pending.program);
+			allLinked = false;
+		}
+	}
+
+	programs.clear();
+	return allLinked;
+}
+
+#endif // _SHADER_LOADER_CPP
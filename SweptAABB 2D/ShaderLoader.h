@@ -0,0 +1,124 @@
+/*
+Title: Swept AABB-2D
+File Name: ShaderLoader.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SHADER_LOADER_H
+#define _SHADER_LOADER_H
+
+#include "GLIncludes.h"
+#include <string>
+#include <vector>
+
+// Reads a whole text file into a string. Returns an empty string (and prints why) if the file can't be read.
+std::string readShader(std::string fileName);
+
+// Creates a shader of the given type and starts compiling it. Use checkShader to find out whether it worked.
+GLuint createShader(std::string sourceCode, GLenum shaderType);
+
+// Waits for a shader from createShader to finish compiling. If it failed, prints the error, deletes the shader and returns false.
+bool checkShader(GLuint shader);
+
+// The source of one of our shaders, by file name (like "VertexShader.glsl"). Built with EMBEDDED_SHADERS defined (which CMakeLists.txt does),
+// the sources are part of the program itself. Otherwise they're read from the file one folder up, the way they always used to be.
+std::string loadShaderSource(const std::string& name);
+
+// Turns a shader's source into one that uses vertex pulling, by raising its #version to 430 (needed for shader storage buffers) and defining VERTEX_PULLING right after it.
+std::string enableVertexPulling(std::string sourceCode);
+
+// Asks the driver to compile shaders on its own threads, if it has GL_KHR_parallel_shader_compile (or the ARB version). Returns whether it does.
+bool enableParallelShaderCompile();
+
+// Builds shader programs, and saves each linked program's binary (glGetProgramBinary) so later runs can load it instead of compiling again.
+// Cache files are named after a hash of the driver's vendor, renderer and version plus the shader sources, so changing any of them just misses the cache.
+// Begin starts every program without waiting on it, and Finish does all the waiting at the end, so with parallel shader compile the driver can work
+// on all of them at once.
+class ProgramCache
+{
+	struct PendingProgram
+	{
+		GLuint program;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		unsigned long long hash;
+	};
+
+	std::string directory;
+	std::string driver;
+	bool binaries;
+	bool parallel;
+
+	std::vector<PendingProgram> programs;
+
+	unsigned int loaded;
+	unsigned int compiled;
+
+	std::string FileName(unsigned long long hash);
+	bool Load(GLuint program, unsigned long long hash);
+	void Save(GLuint program, unsigned long long hash);
+
+public:
+	// directory is put in front of the cache file names, so it needs its trailing slash (and has to exist). useBinaries = false always compiles.
+	// Needs a current OpenGL context.
+	ProgramCache(const std::string& directory = "", bool useBinaries = true);
+
+	// Returns a new program made from the two sources: loaded from the cache if it's there, otherwise compiling and linking (possibly still going
+	// when this returns). Don't use the program until Finish.
+	GLuint Begin(const std::string& vertexSource, const std::string& fragmentSource);
+
+	// Waits for every program started since the last Finish, prints any errors, and saves the binaries of the ones that were compiled.
+	// Returns false if any of them failed. The ones that failed are deleted, so check glIsProgram before deleting the programs Begin returned.
+	bool Finish();
+
+	unsigned int LoadedFromCache()
+	{
+		return loaded;
+	}
+	unsigned int Compiled()
+	{
+		return compiled;
+	}
+	bool UsingBinaries()
+	{
+		return binaries;
+	}
+	bool UsingParallelCompile()
+	{
+		return parallel;
+	}
+};
+
+#endif //_SHADER_LOADER_H
@@ -0,0 +1,184 @@
+/*
+Title: Swept AABB-2D
+File Name: SweptBatch.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SWEPT_BATCH_CPP
+#define _SWEPT_BATCH_CPP
+
+#include "SweptBatch.h"
+#include "TransformBatch.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <limits>
+
+void sweptAABBBatchScalar(unsigned int count, const SweptPairs& pairs, float* outTime, float* outNormalX, float* outNormalY)
+{
+	const float infinity = std::numeric_limits<float>::infinity();
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float velX = pairs.velX[i];
+		float velY = pairs.velY[i];
+
+		// The near and far distances, picked by the direction of travel. See SweptAABB in Collision.cpp for what each step means.
+		float xDistanceEntry = velX > 0.0f ? pairs.box2MinX[i] - pairs.box1MaxX[i] : pairs.box2MaxX[i] - pairs.box1MinX[i];
+		float xDistanceExit = velX > 0.0f ? pairs.box2MaxX[i] - pairs.box1MinX[i] : pairs.box2MinX[i] - pairs.box1MaxX[i];
+		float yDistanceEntry = velY > 0.0f ? pairs.box2MinY[i] - pairs.box1MaxY[i] : pairs.box2MaxY[i] - pairs.box1MinY[i];
+		float yDistanceExit = velY > 0.0f ? pairs.box2MaxY[i] - pairs.box1MinY[i] : pairs.box2MinY[i] - pairs.box1MaxY[i];
+
+		// Not moving on an axis means that axis is either always overlapping or never.
+		float xSizes = (pairs.box1MaxX[i] - pairs.box1MinX[i]) + (pairs.box2MaxX[i] - pairs.box2MinX[i]);
+		float ySizes = (pairs.box1MaxY[i] - pairs.box1MinY[i]) + (pairs.box2MaxY[i] - pairs.box2MinY[i]);
+		float xStill = std::max(fabsf(xDistanceEntry), fabsf(xDistanceExit)) > xSizes ? 2.0f : -infinity;
+		float yStill = std::max(fabsf(yDistanceEntry), fabsf(yDistanceExit)) > ySizes ? 2.0f : -infinity;
+
+		float xEntryTime = velX == 0.0f ? xStill : xDistanceEntry / velX;
+		float xExitTime = velX == 0.0f ? infinity : xDistanceExit / velX;
+		float yEntryTime = velY == 0.0f ? yStill : yDistanceEntry / velY;
+		float yExitTime = velY == 0.0f ? infinity : yDistanceExit / velY;
+
+		float entryTime = std::max(xEntryTime, yEntryTime);
+		float exitTime = std::min(xExitTime, yExitTime);
+
+		bool miss = entryTime > exitTime || (xEntryTime < 0.0f && yEntryTime < 0.0f) || xEntryTime > 1.0f || yEntryTime > 1.0f;
+
+		outTime[i] = miss ? 2.0f : entryTime;
+		outNormalX[i] = !miss && xEntryTime > yEntryTime ? (xDistanceEntry < 0.0f ? 1.0f : -1.0f) : 0.0f;
+		outNormalY[i] = !miss && yEntryTime > xEntryTime ? (yDistanceEntry < 0.0f ? 1.0f : -1.0f) : 0.0f;
+	}
+}
+
+// a > b ? a : b, lane by lane, picking between them the way std::max does (so b only when a < b), rather than how _mm256_max_ps does.
+// The two only differ on +0 against -0, but that's enough to give a different answer than SweptAABB.
+TARGET_AVX2 static inline __m256 stdMax(__m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(a, b, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+TARGET_AVX2 static inline __m256 stdMin(__m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(a, b, _mm256_cmp_ps(b, a, _CMP_LT_OQ));
+}
+
+TARGET_AVX2 static void sweptAABBBatchAVX2(unsigned int count, const SweptPairs& pairs, float* outTime, float* outNormalX, float* outNormalY)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+	const __m256 minusInfinity = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 box1MinX = _mm256_loadu_ps(pairs.box1MinX + i);
+		__m256 box1MinY = _mm256_loadu_ps(pairs.box1MinY + i);
+		__m256 box1MaxX = _mm256_loadu_ps(pairs.box1MaxX + i);
+		__m256 box1MaxY = _mm256_loadu_ps(pairs.box1MaxY + i);
+		__m256 box2MinX = _mm256_loadu_ps(pairs.box2MinX + i);
+		__m256 box2MinY = _mm256_loadu_ps(pairs.box2MinY + i);
+		__m256 box2MaxX = _mm256_loadu_ps(pairs.box2MaxX + i);
+		__m256 box2MaxY = _mm256_loadu_ps(pairs.box2MaxY + i);
+		__m256 velX = _mm256_loadu_ps(pairs.velX + i);
+		__m256 velY = _mm256_loadu_ps(pairs.velY + i);
+
+		// Both orders of each distance, and a mask of the lanes moving the positive way to pick with.
+		__m256 minToMaxX = _mm256_sub_ps(box2MinX, box1MaxX);
+		__m256 maxToMinX = _mm256_sub_ps(box2MaxX, box1MinX);
+		__m256 minToMaxY = _mm256_sub_ps(box2MinY, box1MaxY);
+		__m256 maxToMinY = _mm256_sub_ps(box2MaxY, box1MinY);
+		__m256 positiveX = _mm256_cmp_ps(velX, zero, _CMP_GT_OQ);
+		__m256 positiveY = _mm256_cmp_ps(velY, zero, _CMP_GT_OQ);
+
+		__m256 xDistanceEntry = _mm256_blendv_ps(maxToMinX, minToMaxX, positiveX);
+		__m256 xDistanceExit = _mm256_blendv_ps(minToMaxX, maxToMinX, positiveX);
+		__m256 yDistanceEntry = _mm256_blendv_ps(maxToMinY, minToMaxY, positiveY);
+		__m256 yDistanceExit = _mm256_blendv_ps(minToMaxY, maxToMinY, positiveY);
+
+		// The times for lanes that aren't moving on an axis. The division below is still done for them, but its result is thrown away.
+		__m256 xSizes = _mm256_add_ps(_mm256_sub_ps(box1MaxX, box1MinX), _mm256_sub_ps(box2MaxX, box2MinX));
+		__m256 ySizes = _mm256_add_ps(_mm256_sub_ps(box1MaxY, box1MinY), _mm256_sub_ps(box2MaxY, box2MinY));
+		__m256 xApart = _mm256_cmp_ps(_mm256_max_ps(_mm256_and_ps(xDistanceEntry, absMask), _mm256_and_ps(xDistanceExit, absMask)), xSizes, _CMP_GT_OQ);
+		__m256 yApart = _mm256_cmp_ps(_mm256_max_ps(_mm256_and_ps(yDistanceEntry, absMask), _mm256_and_ps(yDistanceExit, absMask)), ySizes, _CMP_GT_OQ);
+		__m256 stillX = _mm256_cmp_ps(velX, zero, _CMP_EQ_OQ);
+		__m256 stillY = _mm256_cmp_ps(velY, zero, _CMP_EQ_OQ);
+
+		__m256 xEntryTime = _mm256_blendv_ps(_mm256_div_ps(xDistanceEntry, velX), _mm256_blendv_ps(minusInfinity, two, xApart), stillX);
+		__m256 xExitTime = _mm256_blendv_ps(_mm256_div_ps(xDistanceExit, velX), infinity, stillX);
+		__m256 yEntryTime = _mm256_blendv_ps(_mm256_div_ps(yDistanceEntry, velY), _mm256_blendv_ps(minusInfinity, two, yApart), stillY);
+		__m256 yExitTime = _mm256_blendv_ps(_mm256_div_ps(yDistanceExit, velY), infinity, stillY);
+
+		__m256 entryTime = stdMax(xEntryTime, yEntryTime);
+		__m256 exitTime = stdMin(xExitTime, yExitTime);
+
+		__m256 miss = _mm256_or_ps(
+			_mm256_or_ps(_mm256_cmp_ps(entryTime, exitTime, _CMP_GT_OQ), _mm256_and_ps(_mm256_cmp_ps(xEntryTime, zero, _CMP_LT_OQ), _mm256_cmp_ps(yEntryTime, zero, _CMP_LT_OQ))),
+			_mm256_or_ps(_mm256_cmp_ps(xEntryTime, one, _CMP_GT_OQ), _mm256_cmp_ps(yEntryTime, one, _CMP_GT_OQ)));
+
+		// A normal is only set on a hit, and only on the axis that crossed last.
+		__m256 xLast = _mm256_andnot_ps(miss, _mm256_cmp_ps(xEntryTime, yEntryTime, _CMP_GT_OQ));
+		__m256 yLast = _mm256_andnot_ps(miss, _mm256_cmp_ps(yEntryTime, xEntryTime, _CMP_GT_OQ));
+		__m256 normalX = _mm256_and_ps(xLast, _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(xDistanceEntry, zero, _CMP_LT_OQ)));
+		__m256 normalY = _mm256_and_ps(yLast, _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(yDistanceEntry, zero, _CMP_LT_OQ)));
+
+		_mm256_storeu_ps(outTime + i, _mm256_blendv_ps(entryTime, two, miss));
+		_mm256_storeu_ps(outNormalX + i, normalX);
+		_mm256_storeu_ps(outNormalY + i, normalY);
+	}
+
+	// The last few pairs that didn't fill a register.
+	if (i < count)
+	{
+		sweptAABBBatchScalar(count - i, pairs.From(i), outTime + i, outNormalX + i, outNormalY + i);
+	}
+}
+
+void sweptAABBBatch(unsigned int count, const SweptPairs& pairs, float* outTime, float* outNormalX, float* outNormalY)
+{
+	if (transformBatchUsesAVX2())
+	{
+		sweptAABBBatchAVX2(count, pairs, outTime, outNormalX, outNormalY);
+	}
+	else
+	{
+		sweptAABBBatchScalar(count, pairs, outTime, outNormalX, outNormalY);
+	}
+}
+
+#endif // _SWEPT_BATCH_CPP
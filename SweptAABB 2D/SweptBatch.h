@@ -0,0 +1,89 @@
+/*
+Title: Swept AABB-2D
+File Name: SweptBatch.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SWEPT_BATCH_H
+#define _SWEPT_BATCH_H
+
+#include "GLIncludes.h"
+
+// Runs SweptAABB on a whole batch of pairs at once. The pairs come as structure of arrays, so 8 of each coordinate can be loaded into
+// a register, and every choice SweptAABB makes with an if (which way the box is moving, whether it's moving at all, hit or miss, which
+// axis hit last) is made for all 8 pairs at once by working out both sides and picking per lane. So there's no branch to mispredict,
+// however the velocities and hits are mixed. The results are exactly those of SweptAABB, with one difference: on a perfect corner hit
+// (both axes crossing at the same moment) the normals come back as zero, where SweptAABB leaves them as they were (see SweptAABBGeneric).
+// If the CPU has AVX2 (see transformBatchUsesAVX2), 8 pairs are done at a time.
+
+// Element i of every array belongs to pair i. box1 moves by vel and box2 stands still, like the arguments of SweptAABB. Only x and y are used.
+struct SweptPairs
+{
+	const float* box1MinX;
+	const float* box1MinY;
+	const float* box1MaxX;
+	const float* box1MaxY;
+	const float* box2MinX;
+	const float* box2MinY;
+	const float* box2MaxX;
+	const float* box2MaxY;
+	const float* velX;
+	const float* velY;
+
+	// The same pairs, starting first pairs in.
+	SweptPairs From(unsigned int first) const
+	{
+		SweptPairs pairs;
+		pairs.box1MinX = box1MinX + first;
+		pairs.box1MinY = box1MinY + first;
+		pairs.box1MaxX = box1MaxX + first;
+		pairs.box1MaxY = box1MaxY + first;
+		pairs.box2MinX = box2MinX + first;
+		pairs.box2MinY = box2MinY + first;
+		pairs.box2MaxX = box2MaxX + first;
+		pairs.box2MaxY = box2MaxY + first;
+		pairs.velX = velX + first;
+		pairs.velY = velY + first;
+		return pairs;
+	}
+};
+
+// outTime[i], outNormalX[i] and outNormalY[i] get what SweptAABB would return for pair i (2.0f and zero normals for a miss).
+void sweptAABBBatch(unsigned int count, const SweptPairs& pairs, float* outTime, float* outNormalX, float* outNormalY);
+
+// The plain C++ version, always available. It makes the same choices the same way, one pair at a time.
+void sweptAABBBatchScalar(unsigned int count, const SweptPairs& pairs, float* outTime, float* outNormalX, float* outNormalY);
+
+#endif //_SWEPT_BATCH_H
@@ -0,0 +1,265 @@
+/*
+Title: Swept AABB-2D
+File Name: SweptCapture.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SWEPT_CAPTURE_CPP
+#define _SWEPT_CAPTURE_CPP
+
+#include "SweptCapture.h"
+#include <climits>
+#include <cstring>
+
+static const unsigned int sweptCaptureVersion = 1;
+static const unsigned int floatsPerSample = 13;
+
+// The floats of a sample in the order the file has them.
+static void sampleToFloats(const SweptSample& sample, float* out)
+{
+	out[0] = sample.box1Min.x;
+	out[1] = sample.box1Min.y;
+	out[2] = sample.box1Max.x;
+	out[3] = sample.box1Max.y;
+	out[4] = sample.box2Min.x;
+	out[5] = sample.box2Min.y;
+	out[6] = sample.box2Max.x;
+	out[7] = sample.box2Max.y;
+	out[8] = sample.velocity.x;
+	out[9] = sample.velocity.y;
+	out[10] = sample.time;
+	out[11] = sample.normalx;
+	out[12] = sample.normaly;
+}
+
+static void floatsToSample(const float* in, SweptSample& sample)
+{
+	sample.box1Min = glm::vec2(in[0], in[1]);
+	sample.box1Max = glm::vec2(in[2], in[3]);
+	sample.box2Min = glm::vec2(in[4], in[5]);
+	sample.box2Max = glm::vec2(in[6], in[7]);
+	sample.velocity = glm::vec2(in[8], in[9]);
+	sample.time = in[10];
+	sample.normalx = in[11];
+	sample.normaly = in[12];
+}
+
+static void putU32(unsigned char* out, unsigned int value)
+{
+	out[0] = (unsigned char)value;
+	out[1] = (unsigned char)(value >> 8);
+	out[2] = (unsigned char)(value >> 16);
+	out[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned int getU32(const unsigned char* in)
+{
+	return in[0] | (in[1] << 8) | (in[2] << 16) | ((unsigned int)in[3] << 24);
+}
+
+SweptCapture::SweptCapture()
+{
+	file = nullptr;
+	sampleEvery = 1;
+	maxSamples = 0;
+
+	// With no file open, the countdown only runs out every 4 billion tests, and Take() just starts it over.
+	countdown = UINT_MAX;
+	gap = UINT_MAX;
+	random = 12345;
+
+	tests = 0;
+	samples = 0;
+}
+
+SweptCapture::~SweptCapture()
+{
+	Close();
+}
+
+bool SweptCapture::Open(const std::string& path, unsigned int inSampleEvery, unsigned long long inMaxSamples)
+{
+	Close();
+
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	unsigned char header[12];
+	memcpy(header, "SWPT", 4);
+	putU32(header + 4, sweptCaptureVersion);
+	putU32(header + 8, floatsPerSample * 4);
+	fwrite(header, 1, sizeof(header), file);
+
+	sampleEvery = inSampleEvery > 0 ? inSampleEvery : 1;
+	maxSamples = inMaxSamples;
+	tests = 0;
+	samples = 0;
+	pending.clear();
+	pending.reserve(PendingSize);
+
+	countdown = gap;
+	NextGap();
+	return true;
+}
+
+void SweptCapture::Close()
+{
+	if (file == nullptr)
+	{
+		return;
+	}
+
+	Flush();
+	fclose(file);
+	file = nullptr;
+
+	tests += gap - countdown;
+	countdown = gap = UINT_MAX;
+}
+
+void SweptCapture::NextGap()
+{
+	tests += gap - countdown;
+
+	if (file == nullptr || samples >= maxSamples)
+	{
+		gap = UINT_MAX;
+	}
+	else if (sampleEvery == 1)
+	{
+		gap = 1;
+	}
+	else
+	{
+		// Anywhere from 1 to 2 * sampleEvery - 1 tests, which is sampleEvery on average.
+		random = random * 1664525u + 1013904223u;
+		gap = 1 + (random >> 8) % (2 * sampleEvery - 1);
+	}
+
+	countdown = gap;
+}
+
+void SweptCapture::Take(const AABB& box1, const AABB& box2, const glm::vec3& vel1, float time, float normalx, float normaly)
+{
+	if (file != nullptr && samples < maxSamples)
+	{
+		SweptSample sample;
+		sample.box1Min = glm::vec2(box1.min);
+		sample.box1Max = glm::vec2(box1.max);
+		sample.box2Min = glm::vec2(box2.min);
+		sample.box2Max = glm::vec2(box2.max);
+		sample.velocity = glm::vec2(vel1);
+		sample.time = time;
+		sample.normalx = normalx;
+		sample.normaly = normaly;
+		pending.push_back(sample);
+		samples++;
+
+		if (pending.size() >= PendingSize || samples == maxSamples)
+		{
+			Flush();
+		}
+	}
+
+	NextGap();
+}
+
+void SweptCapture::Flush()
+{
+	if (pending.empty())
+	{
+		return;
+	}
+
+	// Written a float at a time, so the file comes out the same on any machine.
+	std::vector<unsigned char> bytes(pending.size() * floatsPerSample * 4);
+	for (unsigned int i = 0; i < pending.size(); i++)
+	{
+		float values[floatsPerSample];
+		sampleToFloats(pending[i], values);
+
+		for (unsigned int v = 0; v < floatsPerSample; v++)
+		{
+			unsigned int bits;
+			memcpy(&bits, &values[v], sizeof(bits));
+			putU32(&bytes[(i * floatsPerSample + v) * 4], bits);
+		}
+	}
+
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	pending.clear();
+}
+
+bool loadSweptCapture(const std::string& path, std::vector<SweptSample>& out)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	unsigned char header[12];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "SWPT", 4) != 0
+		|| getU32(header + 4) != sweptCaptureVersion || getU32(header + 8) != floatsPerSample * 4)
+	{
+		fclose(file);
+		return false;
+	}
+
+	out.clear();
+
+	unsigned char bytes[floatsPerSample * 4];
+	while (fread(bytes, 1, sizeof(bytes), file) == sizeof(bytes))
+	{
+		float values[floatsPerSample];
+		for (unsigned int v = 0; v < floatsPerSample; v++)
+		{
+			unsigned int bits = getU32(&bytes[v * 4]);
+			memcpy(&values[v], &bits, sizeof(bits));
+		}
+
+		SweptSample sample;
+		floatsToSample(values, sample);
+		out.push_back(sample);
+	}
+
+	fclose(file);
+	return true;
+}
+
+#endif // _SWEPT_CAPTURE_CPP
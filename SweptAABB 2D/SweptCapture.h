@@ -0,0 +1,124 @@
+/*
+Title: Swept AABB-2D
+File Name: SweptCapture.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _SWEPT_CAPTURE_H
+#define _SWEPT_CAPTURE_H
+
+#include "GameObject.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// One swept test as it really happened: what SweptAABB was given and what it gave back. Only x and y, since that's all it looks at.
+struct SweptSample
+{
+	glm::vec2 box1Min, box1Max;
+	glm::vec2 box2Min, box2Max;
+	glm::vec2 velocity;
+	float time;
+	float normalx, normaly;
+};
+
+// Writes a sample of the swept tests a running game makes to a file, so benchmarks can replay the pairs a real scene produces
+// (how many hit, how many move along one axis only, how many just touch) instead of made up ones.
+// Only about one test in sampleEvery is kept, picked at random gaps so that it doesn't line up with any pattern in the order the tests come in.
+// The tests in between cost a decrement and a compare, the kept ones are written out a few thousand at a time, and the capture stops
+// after maxSamples, so the overhead and the file size both have a limit.
+// It can be passed to a PhysicsWorld as its capture policy (see PhysicsConfig), or fed by hand. Only use it from one thread.
+//     header:  "SWPT" version sampleBytes    (3 x 4 bytes, little-endian)
+//     samples: box1 min x y, max x y, box2 min x y, max x y, velocity x y, time, normal x y (13 little-endian floats each)
+class SweptCapture
+{
+	FILE* file;
+	unsigned int sampleEvery;
+	unsigned long long maxSamples;
+
+	// Tests left until the next sample, and how long the current gap was.
+	unsigned int countdown;
+	unsigned int gap;
+	unsigned int random;
+
+	unsigned long long tests;
+	unsigned long long samples;
+
+	std::vector<SweptSample> pending;
+	static const unsigned int PendingSize = 4096;
+
+	void Take(const AABB& box1, const AABB& box2, const glm::vec3& vel1, float time, float normalx, float normaly);
+	void NextGap();
+	void Flush();
+
+public:
+	SweptCapture();
+	~SweptCapture();
+
+	// Starts writing to a new file. Returns false if it couldn't be made.
+	bool Open(const std::string& path, unsigned int sampleEvery = 64, unsigned long long maxSamples = 1000000);
+
+	// Writes out what's left and closes the file.
+	void Close();
+
+	bool IsOpen()
+	{
+		return file != nullptr;
+	}
+
+	// Call with the arguments and results of each swept test. box1 is the moving one, as in SweptAABB.
+	void OnSweptTest(const AABB& box1, const AABB& box2, const glm::vec3& vel1, float time, float normalx, float normaly)
+	{
+		if (--countdown == 0)
+		{
+			Take(box1, box2, vel1, time, normalx, normaly);
+		}
+	}
+
+	// How many tests went past since Open, and how many of them were kept.
+	unsigned long long Tests()
+	{
+		return tests + (gap - countdown);
+	}
+	unsigned long long Samples()
+	{
+		return samples;
+	}
+};
+
+// Reads every sample of a capture file. Returns false if it can't be read or isn't a capture.
+bool loadSweptCapture(const std::string& path, std::vector<SweptSample>& out);
+
+#endif //_SWEPT_CAPTURE_H
@@ -0,0 +1,738 @@
+/*
+Title: Swept AABB-2D
+File Name: TrajectoryRecorder.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _TRAJECTORY_RECORDER_CPP
+#define _TRAJECTORY_RECORDER_CPP
+
+#include "TrajectoryRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX	// Otherwise windows.h defines min and max macros that break std::min
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const unsigned int trajectoryVersion = 1;
+static const unsigned int headerBytes = 16;
+static const unsigned int chunkHeaderBytes = 12 + 4 * TRAJECTORY_COLUMNS;
+
+// A float's bits as an unsigned integer that goes up as the float does: positive floats get the top bit set, and negative ones
+// have all their bits flipped so that the more negative they are the smaller they get. So floats close together, on either side
+// of zero as well, become integers close together, and their difference is small.
+static unsigned int orderedBits(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+static float fromOrderedBits(unsigned int ordered)
+{
+	unsigned int bits = (ordered & 0x80000000u) ? (ordered & 0x7FFFFFFFu) : ~ordered;
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// Zig-zag encoding interleaves the negative numbers with the positive ones (0, -1, 1, -2, 2, ... become 0, 1, 2, 3, 4, ...),
+// so a difference that's small either way is a small number, and a short varint.
+static unsigned int zigZag(unsigned int difference)
+{
+	return (difference << 1) ^ (unsigned int)((int)difference >> 31);
+}
+
+static unsigned int unZigZag(unsigned int encoded)
+{
+	return (encoded >> 1) ^ (0u - (encoded & 1));
+}
+
+// 7 bits a byte, lowest first, with the top bit set on every byte but the last.
+static void putVarint(std::vector<unsigned char>& out, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((unsigned char)value);
+}
+
+static void putU32(unsigned char* out, unsigned int value)
+{
+	out[0] = (unsigned char)value;
+	out[1] = (unsigned char)(value >> 8);
+	out[2] = (unsigned char)(value >> 16);
+	out[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned int getU32(const unsigned char* in)
+{
+	return in[0] | (in[1] << 8) | (in[2] << 16) | ((unsigned int)in[3] << 24);
+}
+
+// Reads varints out of one column, and remembers if it ever ran off the end or found something that isn't a varint.
+struct VarintReader
+{
+	const unsigned char* next;
+	const unsigned char* end;
+	bool failed;
+
+	VarintReader(const unsigned char* data, unsigned int bytes)
+	{
+		next = data;
+		end = data + bytes;
+		failed = false;
+	}
+
+	unsigned int Read()
+	{
+		unsigned int value = 0;
+		for (unsigned int shift = 0; shift < 35; shift += 7)
+		{
+			if (next == end)
+			{
+				break;
+			}
+
+			unsigned char byte = *next++;
+			value |= (unsigned int)(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+
+		failed = true;
+		return 0;
+	}
+};
+
+// The float a value column holds for one object.
+static float& tickValue(TrajectoryTick& tick, unsigned int value, unsigned int object)
+{
+	return value < 3 ? tick.positions[object][value] : tick.velocities[object][value - 3];
+}
+
+TrajectoryRecorder::TrajectoryRecorder()
+{
+	file = nullptr;
+	stopping.store(false);
+
+	// Every tick starts out spare. The writer thread takes over handing them back once it's running.
+	for (unsigned int i = 0; i < QueueSize; i++)
+	{
+		spare.Push(&ticks[i]);
+	}
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+	Close();
+}
+
+bool TrajectoryRecorder::Open(const std::string& path, unsigned int inTicksPerChunk)
+{
+	Close();
+
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	ticksPerChunk = std::max(inTicksPerChunk, 1u);
+	chunkTicks = 0;
+	chunkFirstStep = 0;
+	havePrevious = false;
+	previousStep = 0;
+
+	ticksRecorded.store(0);
+	ticksDropped.store(0);
+	rawBytes.store(0);
+	fileBytes.store(headerBytes);
+
+	unsigned char header[headerBytes];
+	memcpy(header, "TRAJ", 4);
+	putU32(header + 4, trajectoryVersion);
+	putU32(header + 8, ticksPerChunk);
+	putU32(header + 12, TRAJECTORY_COLUMNS);
+	fwrite(header, 1, sizeof(header), file);
+
+	stopping.store(false);
+	writer = std::thread(&TrajectoryRecorder::WriterLoop, this);
+
+	return true;
+}
+
+void TrajectoryRecorder::Close()
+{
+	if (file == nullptr)
+	{
+		return;
+	}
+
+	// Record() runs on this same thread, so everything it queued is in by now. The writer finishes those off before it stops.
+	stopping.store(true);
+	writer.join();
+
+	fclose(file);
+	file = nullptr;
+}
+
+void TrajectoryRecorder::Record(World& world)
+{
+	TrajectoryTick** slot = spare.Peek();
+	if (slot == nullptr)
+	{
+		ticksDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	TrajectoryTick* tick = *slot;
+	spare.Pop();
+
+	// EndStep() has already moved the world on to the next step.
+	unsigned int count = world.NumObjects();
+	tick->step = world.CurrentStep() - 1;
+	tick->handles.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		tick->handles[i] = world.HandleAt(i);
+	}
+	tick->positions.assign(world.Positions(), world.Positions() + count);
+	tick->velocities.assign(world.Velocities(), world.Velocities() + count);
+
+	// There are only QueueSize ticks, so there's always room for this one.
+	filled.Push(tick);
+}
+
+TrajectoryRecorderStats TrajectoryRecorder::Stats()
+{
+	TrajectoryRecorderStats stats;
+	stats.ticksRecorded = ticksRecorded.load();
+	stats.ticksDropped = ticksDropped.load();
+	stats.rawBytes = rawBytes.load();
+	stats.fileBytes = fileBytes.load();
+	return stats;
+}
+
+void TrajectoryRecorder::WriterLoop()
+{
+	while (true)
+	{
+		TrajectoryTick** slot = filled.Peek();
+
+		if (slot != nullptr)
+		{
+			TrajectoryTick* tick = *slot;
+			filled.Pop();
+
+			Encode(*tick);
+			spare.Push(tick);
+			continue;
+		}
+
+		// Only stop once the queue is empty, having seen stopping. Nothing more gets queued after Close() sets it.
+		if (stopping.load())
+		{
+			if (filled.Peek() == nullptr)
+			{
+				break;
+			}
+			continue;
+		}
+
+		// A step only comes along every 12 ms, so there's no point in spinning.
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	FlushChunk();
+	fflush(file);
+}
+
+void TrajectoryRecorder::Encode(const TrajectoryTick& tick)
+{
+	unsigned int count = (unsigned int)tick.handles.size();
+
+	// A chunk's first tick, or one where objects came or went (or were reordered), can't be predicted from the tick before.
+	// Its handles are written out, and each value is predicted from the object before it instead.
+	bool keyframe = chunkTicks == 0 || !havePrevious || count != previousHandles.size();
+	for (unsigned int i = 0; i < count && !keyframe; i++)
+	{
+		keyframe = tick.handles[i].index != previousHandles[i].index || tick.handles[i].generation != previousHandles[i].generation;
+	}
+
+	if (chunkTicks == 0)
+	{
+		chunkFirstStep = tick.step;
+	}
+
+	std::vector<unsigned char>& table = columns[TRAJECTORY_TICKS];
+	putVarint(table, chunkTicks == 0 ? 0 : tick.step - previousStep);
+	putVarint(table, count);
+	table.push_back(keyframe ? 1 : 0);
+
+	if (keyframe)
+	{
+		unsigned int index = 0;
+		unsigned int generation = 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			putVarint(columns[TRAJECTORY_HANDLE_INDEX], zigZag(tick.handles[i].index - index));
+			putVarint(columns[TRAJECTORY_HANDLE_GENERATION], zigZag(tick.handles[i].generation - generation));
+			index = tick.handles[i].index;
+			generation = tick.handles[i].generation;
+		}
+
+		previousHandles = tick.handles;
+	}
+
+	for (unsigned int value = 0; value < 6; value++)
+	{
+		std::vector<unsigned char>& column = columns[TRAJECTORY_POSITION_X + value];
+		std::vector<unsigned int>& previous = previousValues[value];
+		std::vector<unsigned int>& trend = previousTrends[value];
+		previous.resize(count);
+		trend.resize(count);
+
+		const glm::vec3* source = value < 3 ? tick.positions.data() : tick.velocities.data();
+		unsigned int axis = value % 3;
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			unsigned int bits = orderedBits(source[i][axis]);
+
+			// previous[i - 1] has already been overwritten with this tick's value, which is the one a keyframe wants.
+			// Otherwise the value is expected to change by as much as it did last tick (nothing, on the tick after a keyframe).
+			unsigned int predicted;
+			if (keyframe)
+			{
+				predicted = i > 0 ? previous[i - 1] : 0;
+				trend[i] = 0;
+			}
+			else
+			{
+				predicted = previous[i] + trend[i];
+				trend[i] = bits - previous[i];
+			}
+
+			putVarint(column, zigZag(bits - predicted));
+			previous[i] = bits;
+		}
+	}
+
+	havePrevious = true;
+	previousStep = tick.step;
+	chunkTicks++;
+
+	ticksRecorded.fetch_add(1);
+	rawBytes.fetch_add(sizeof(unsigned int) + count * (sizeof(ObjectHandle) + 2 * sizeof(glm::vec3)));
+
+	if (chunkTicks >= ticksPerChunk)
+	{
+		FlushChunk();
+	}
+}
+
+void TrajectoryRecorder::FlushChunk()
+{
+	if (chunkTicks == 0)
+	{
+		return;
+	}
+
+	unsigned char header[chunkHeaderBytes];
+	memcpy(header, "TCHK", 4);
+	putU32(header + 4, chunkTicks);
+	putU32(header + 8, chunkFirstStep);
+
+	unsigned long long bytes = chunkHeaderBytes;
+	for (unsigned int c = 0; c < TRAJECTORY_COLUMNS; c++)
+	{
+		putU32(header + 12 + 4 * c, (unsigned int)columns[c].size());
+		bytes += columns[c].size();
+	}
+
+	fwrite(header, 1, sizeof(header), file);
+	for (unsigned int c = 0; c < TRAJECTORY_COLUMNS; c++)
+	{
+		if (!columns[c].empty())
+		{
+			fwrite(columns[c].data(), 1, columns[c].size(), file);
+		}
+		columns[c].clear();
+	}
+
+	fileBytes.fetch_add(bytes);
+	chunkTicks = 0;
+}
+
+TrajectoryReader::TrajectoryReader()
+{
+	data = nullptr;
+	size = 0;
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#else
+	fileHandle = -1;
+#endif
+	numTicks = 0;
+	decodedChunk = -1;
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+	Close();
+}
+
+bool TrajectoryReader::Map(const std::string& path)
+{
+#ifdef _WIN32
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+
+	data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	return data != nullptr;
+#else
+	fileHandle = open(path.c_str(), O_RDONLY);
+	if (fileHandle < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fileHandle, &info) != 0 || info.st_size == 0)
+	{
+		return false;
+	}
+	size = (size_t)info.st_size;
+
+	void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileHandle, 0);
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = (const unsigned char*)mapped;
+	return true;
+#endif
+}
+
+bool TrajectoryReader::Open(const std::string& path)
+{
+	Close();
+
+	if (!Map(path) || size < headerBytes || memcmp(data, "TRAJ", 4) != 0 || getU32(data + 4) != trajectoryVersion || getU32(data + 12) != TRAJECTORY_COLUMNS)
+	{
+		Close();
+		return false;
+	}
+
+	// Each chunk says how big its columns are, so finding them all is just a hop from one header to the next.
+	size_t offset = headerBytes;
+	while (size - offset >= chunkHeaderBytes && memcmp(data + offset, "TCHK", 4) == 0)
+	{
+		Chunk chunk;
+		chunk.tickCount = getU32(data + offset + 4);
+		chunk.firstStep = getU32(data + offset + 8);
+		chunk.firstTick = numTicks;
+
+		size_t next = offset + chunkHeaderBytes;
+		for (unsigned int c = 0; c < TRAJECTORY_COLUMNS; c++)
+		{
+			chunk.columnBytes[c] = getU32(data + offset + 12 + 4 * c);
+			chunk.columns[c] = data + next;
+			next += chunk.columnBytes[c];
+		}
+
+		// The last chunk is incomplete if the recording was cut off while it was being written.
+		if (next > size || chunk.tickCount == 0)
+		{
+			break;
+		}
+
+		chunks.push_back(chunk);
+		numTicks += chunk.tickCount;
+		offset = next;
+	}
+
+	return true;
+}
+
+void TrajectoryReader::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mapping != nullptr)
+	{
+		CloseHandle(mapping);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+	fileHandle = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#else
+	if (data != nullptr)
+	{
+		munmap((void*)data, size);
+	}
+	if (fileHandle >= 0)
+	{
+		close(fileHandle);
+	}
+	fileHandle = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+	chunks.clear();
+	numTicks = 0;
+	decodedChunk = -1;
+}
+
+bool TrajectoryReader::DecodeChunk(unsigned int index)
+{
+	if ((int)index == decodedChunk)
+	{
+		return true;
+	}
+
+	const Chunk& chunk = chunks[index];
+	decodedChunk = -1;
+
+	// The counts come from the file, so a damaged one could ask for any amount of memory. Every tick takes at least 3 bytes of the ticks column
+	// (its step, count and keyframe flag), and every object at least one byte of each value column, which puts a limit on both.
+	if (chunk.tickCount > chunk.columnBytes[TRAJECTORY_TICKS] / 3)
+	{
+		return false;
+	}
+	decoded.resize(chunk.tickCount);
+
+	VarintReader readers[TRAJECTORY_COLUMNS] =
+	{
+		VarintReader(chunk.columns[0], chunk.columnBytes[0]), VarintReader(chunk.columns[1], chunk.columnBytes[1]), VarintReader(chunk.columns[2], chunk.columnBytes[2]),
+		VarintReader(chunk.columns[3], chunk.columnBytes[3]), VarintReader(chunk.columns[4], chunk.columnBytes[4]), VarintReader(chunk.columns[5], chunk.columnBytes[5]),
+		VarintReader(chunk.columns[6], chunk.columnBytes[6]), VarintReader(chunk.columns[7], chunk.columnBytes[7]), VarintReader(chunk.columns[8], chunk.columnBytes[8])
+	};
+	VarintReader& table = readers[TRAJECTORY_TICKS];
+
+	// The same integers the recorder predicted from.
+	std::vector<unsigned int> previous[6];
+	std::vector<unsigned int> trend[6];
+	unsigned int step = chunk.firstStep;
+
+	for (unsigned int t = 0; t < chunk.tickCount; t++)
+	{
+		TrajectoryTick& tick = decoded[t];
+
+		step += table.Read();
+		unsigned int count = table.Read();
+
+		if (table.failed || table.next == table.end || count > chunk.columnBytes[TRAJECTORY_POSITION_X])
+		{
+			return false;
+		}
+		bool keyframe = *table.next++ != 0;
+
+		// Only a keyframe can change the objects, and every chunk starts with one.
+		if (!keyframe && (t == 0 || count != decoded[t - 1].handles.size()))
+		{
+			return false;
+		}
+
+		tick.step = step;
+
+		if (keyframe)
+		{
+			tick.handles.resize(count);
+
+			unsigned int index = 0;
+			unsigned int generation = 0;
+			for (unsigned int i = 0; i < count; i++)
+			{
+				index += unZigZag(readers[TRAJECTORY_HANDLE_INDEX].Read());
+				generation += unZigZag(readers[TRAJECTORY_HANDLE_GENERATION].Read());
+				tick.handles[i] = ObjectHandle(index, generation);
+			}
+		}
+		else
+		{
+			tick.handles = decoded[t - 1].handles;
+		}
+
+		tick.positions.resize(count);
+		tick.velocities.resize(count);
+
+		for (unsigned int value = 0; value < 6; value++)
+		{
+			VarintReader& column = readers[TRAJECTORY_POSITION_X + value];
+			previous[value].resize(count);
+			trend[value].resize(count);
+
+			for (unsigned int i = 0; i < count; i++)
+			{
+				unsigned int predicted;
+				if (keyframe)
+				{
+					predicted = i > 0 ? previous[value][i - 1] : 0;
+				}
+				else
+				{
+					predicted = previous[value][i] + trend[value][i];
+				}
+
+				unsigned int bits = predicted + unZigZag(column.Read());
+				trend[value][i] = keyframe ? 0 : bits - previous[value][i];
+				previous[value][i] = bits;
+				tickValue(tick, value, i) = fromOrderedBits(bits);
+			}
+		}
+	}
+
+	for (unsigned int c = 0; c < TRAJECTORY_COLUMNS; c++)
+	{
+		if (readers[c].failed)
+		{
+			return false;
+		}
+	}
+
+	decodedChunk = (int)index;
+	return true;
+}
+
+bool TrajectoryReader::ReadTick(unsigned int tick, TrajectoryTick& out)
+{
+	if (tick >= numTicks)
+	{
+		return false;
+	}
+
+	// The last chunk that starts at or before the tick.
+	unsigned int low = 0;
+	unsigned int high = (unsigned int)chunks.size() - 1;
+	while (low < high)
+	{
+		unsigned int middle = (low + high + 1) / 2;
+		if (chunks[middle].firstTick <= tick)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	if (!DecodeChunk(low))
+	{
+		return false;
+	}
+
+	out = decoded[tick - chunks[low].firstTick];
+	return true;
+}
+
+unsigned int TrajectoryReader::FindStep(unsigned int step)
+{
+	if (chunks.empty() || step <= chunks[0].firstStep)
+	{
+		return 0;
+	}
+
+	// The last chunk that starts at or before the step. The step is either in it, or it's the first tick of the next one.
+	unsigned int low = 0;
+	unsigned int high = (unsigned int)chunks.size() - 1;
+	while (low < high)
+	{
+		unsigned int middle = (low + high + 1) / 2;
+		if (chunks[middle].firstStep <= step)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	if (DecodeChunk(low))
+	{
+		for (unsigned int t = 0; t < decoded.size(); t++)
+		{
+			if (decoded[t].step >= step)
+			{
+				return chunks[low].firstTick + t;
+			}
+		}
+	}
+
+	return chunks[low].firstTick + chunks[low].tickCount;
+}
+
+#endif // _TRAJECTORY_RECORDER_CPP
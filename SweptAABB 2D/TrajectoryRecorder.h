@@ -0,0 +1,219 @@
+/*
+Title: Swept AABB-2D
+File Name: TrajectoryRecorder.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _TRAJECTORY_RECORDER_H
+#define _TRAJECTORY_RECORDER_H
+
+#include "CommandQueue.h"
+#include "World.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The positions and velocities of every object at the end of one physics step, in the world's dense order.
+struct TrajectoryTick
+{
+	unsigned int step;
+
+	std::vector<ObjectHandle> handles;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> velocities;
+
+	TrajectoryTick()
+	{
+		step = 0;
+	}
+};
+
+// How much a recorder has done since it was opened.
+struct TrajectoryRecorderStats
+{
+	unsigned long long ticksRecorded;	// Ticks the writer thread has encoded
+	unsigned long long ticksDropped;	// Ticks Record() skipped because the writer had fallen behind
+	unsigned long long rawBytes;		// What the recorded ticks would take as plain handles and floats
+	unsigned long long fileBytes;		// What was actually written
+};
+
+// Trajectory files are split into chunks of up to ticksPerChunk ticks, and each chunk stores its ticks column by column:
+// a small table of steps and object counts, the handle indices, the handle generations, and then position x, y, z and velocity x, y, z.
+// Every column of a chunk is compressed the same way. A value is turned into an integer (floats by their bits, reordered so that
+// close floats get close integers, so this is lossless), the value it is predicted to be is subtracted from it (the same object's value
+// on the tick before plus however much it changed on that tick, or the object before it on the first tick of a chunk or after the objects
+// changed), the difference is zig-zag encoded so small negative numbers become small positive ones, and then written as a varint, 7 bits
+// a byte. Objects at rest or moving steadily cost about a byte per value and the handles cost nothing at all, and since every chunk starts
+// afresh a reader can jump straight to any of them.
+// All the numbers in the file are little-endian.
+//     header:  "TRAJ" version ticksPerChunk columns                       (4 x 4 bytes)
+//     chunk:   "TCHK" tickCount firstStep columnBytes[columns] columns... (the column bytes follow one after the other)
+enum TrajectoryColumn
+{
+	TRAJECTORY_TICKS,
+	TRAJECTORY_HANDLE_INDEX,
+	TRAJECTORY_HANDLE_GENERATION,
+	TRAJECTORY_POSITION_X,
+	TRAJECTORY_POSITION_Y,
+	TRAJECTORY_POSITION_Z,
+	TRAJECTORY_VELOCITY_X,
+	TRAJECTORY_VELOCITY_Y,
+	TRAJECTORY_VELOCITY_Z,
+	TRAJECTORY_COLUMNS
+};
+
+// Streams the world into a trajectory file, one tick per physics step, for looking at afterwards (see TrajectoryReader).
+// Record() is all the physics thread does: it copies the world's arrays into a spare tick and hands it to a writer thread through
+// a lock-free queue, and that thread does the compressing and the writing. Ticks go round between the two threads through a second
+// queue, so once they've grown to the size of the world nothing is allocated either. If the writer ever falls so far behind that there's
+// no spare tick, that step is dropped (and counted) rather than making physics wait.
+class TrajectoryRecorder
+{
+	// Ticks in flight between the physics thread and the writer. At 83 steps a second that's a fifth of a second of slack, and few enough
+	// that the tick Record() fills next was used recently and is likely still in the cache.
+	static const unsigned int QueueSize = 16;
+
+	TrajectoryTick ticks[QueueSize];
+
+	// Filled ticks from the physics thread to the writer, and emptied ones back again.
+	SPSCQueue<TrajectoryTick*, QueueSize> filled;
+	SPSCQueue<TrajectoryTick*, QueueSize> spare;
+
+	std::thread writer;
+	std::atomic<bool> stopping;
+	FILE* file;
+
+	// Everything below belongs to the writer thread while it's running.
+	unsigned int ticksPerChunk;
+	unsigned int chunkTicks;
+	unsigned int chunkFirstStep;
+	std::vector<unsigned char> columns[TRAJECTORY_COLUMNS];
+
+	// The tick before, which the next one is predicted from, and how much each value changed on it.
+	// Values are kept as the integers they're encoded as.
+	bool havePrevious;
+	unsigned int previousStep;
+	std::vector<ObjectHandle> previousHandles;
+	std::vector<unsigned int> previousValues[6];
+	std::vector<unsigned int> previousTrends[6];
+
+	std::atomic<unsigned long long> ticksRecorded;
+	std::atomic<unsigned long long> ticksDropped;
+	std::atomic<unsigned long long> rawBytes;
+	std::atomic<unsigned long long> fileBytes;
+
+	void WriterLoop();
+	void Encode(const TrajectoryTick&);
+	void FlushChunk();
+
+public:
+	TrajectoryRecorder();
+	~TrajectoryRecorder();
+
+	// Creates the file and starts the writer thread. Returns false if the file couldn't be made.
+	bool Open(const std::string& path, unsigned int ticksPerChunk = 64);
+
+	// Waits for the writer to catch up, writes the last chunk and closes the file.
+	void Close();
+
+	bool IsOpen()
+	{
+		return file != nullptr;
+	}
+
+	// Records the step the world just finished. Call on the physics thread, right after EndStep().
+	void Record(World&);
+
+	TrajectoryRecorderStats Stats();
+};
+
+// Reads a trajectory file back. The file is memory mapped rather than read in, so opening even a long session only costs
+// a walk over the chunk headers, and then any tick can be read by decoding just the chunk it's in (the last chunk is kept decoded,
+// so reading ticks in order only decodes each chunk once). A file that was cut short, say by a crash, reads up to its last whole chunk.
+// Not safe to use from more than one thread at a time.
+class TrajectoryReader
+{
+	struct Chunk
+	{
+		const unsigned char* columns[TRAJECTORY_COLUMNS];
+		unsigned int columnBytes[TRAJECTORY_COLUMNS];
+		unsigned int firstTick;
+		unsigned int tickCount;
+		unsigned int firstStep;
+	};
+
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mapping;
+#else
+	int fileHandle;
+#endif
+
+	std::vector<Chunk> chunks;
+	unsigned int numTicks;
+
+	// The chunk decoded last, and its ticks.
+	int decodedChunk;
+	std::vector<TrajectoryTick> decoded;
+
+	bool DecodeChunk(unsigned int chunk);
+	bool Map(const std::string& path);
+
+public:
+	TrajectoryReader();
+	~TrajectoryReader();
+
+	// Maps the file and finds its chunks. Returns false if it isn't a trajectory file.
+	bool Open(const std::string& path);
+	void Close();
+
+	// How many ticks the file holds. They're numbered from 0 in the order they were recorded.
+	unsigned int NumTicks()
+	{
+		return numTicks;
+	}
+
+	// Reads tick number tick. Returns false if there's no such tick or its chunk is damaged.
+	bool ReadTick(unsigned int tick, TrajectoryTick& out);
+
+	// The number of the first tick recorded at or after step, or NumTicks() if there isn't one. Steps can have gaps if the recorder dropped any.
+	unsigned int FindStep(unsigned int step);
+};
+
+#endif //_TRAJECTORY_RECORDER_H
@@ -0,0 +1,184 @@
+/*
+Title: Swept AABB-2D
+File Name: TransformBatch.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _TRANSFORM_BATCH_CPP
+#define _TRANSFORM_BATCH_CPP
+
+#include "TransformBatch.h"
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Asks the CPU (and the operating system, which has to save the wider registers when switching threads) whether AVX2 and FMA can be used.
+static bool detectAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool osSavesYMM = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	return osSavesYMM && fma && avx2;
+#elif defined(__GNUC__)
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+bool transformBatchUsesAVX2()
+{
+	static const bool avx2 = detectAVX2();
+	return avx2;
+}
+
+void computeTransformsScalar(unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		glm::mat4& m = out[i];
+		m[0] = glm::vec4(scales[i].x, 0.0f, 0.0f, 0.0f);
+		m[1] = glm::vec4(0.0f, scales[i].y, 0.0f, 0.0f);
+		m[2] = glm::vec4(0.0f, 0.0f, scales[i].z, 0.0f);
+		m[3] = glm::vec4(positions[i], 1.0f);
+	}
+}
+
+void computeMVPsScalar(const glm::mat4& PV, unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		glm::mat4& m = out[i];
+		m[0] = PV[0] * scales[i].x;
+		m[1] = PV[1] * scales[i].y;
+		m[2] = PV[2] * scales[i].z;
+		m[3] = PV[0] * positions[i].x + PV[1] * positions[i].y + PV[2] * positions[i].z + PV[3];
+	}
+}
+
+// glm::mat4 is 16 floats in column order, so columns 0 and 1 fill the first 8-wide register and columns 2 and 3 the second.
+// glm doesn't line its matrices up to 32 bytes, so the loads and stores are the unaligned kind (no slower when the data does happen to be aligned).
+
+TARGET_AVX2 static void computeTransformsAVX2(unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	// Where each scale component lands in the first half: x on the diagonal of column 0, y on the diagonal of column 1.
+	const __m256 diagonalX = _mm256_setr_ps(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	const __m256 diagonalY = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+	const __m256 diagonalZ = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	const __m256 translationW = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float* m = &out[i][0][0];
+
+		__m256 low = _mm256_fmadd_ps(_mm256_broadcast_ss(&scales[i].x), diagonalX, _mm256_mul_ps(_mm256_broadcast_ss(&scales[i].y), diagonalY));
+		__m256 high = _mm256_fmadd_ps(_mm256_broadcast_ss(&scales[i].z), diagonalZ, translationW);
+
+		// The position goes in the top half (column 3). Loading 4 floats from the position would read past the end of the last one,
+		// so the three components are broadcast and blended in one at a time instead.
+		high = _mm256_blend_ps(high, _mm256_broadcast_ss(&positions[i].x), 0x10);
+		high = _mm256_blend_ps(high, _mm256_broadcast_ss(&positions[i].y), 0x20);
+		high = _mm256_blend_ps(high, _mm256_broadcast_ss(&positions[i].z), 0x40);
+
+		_mm256_storeu_ps(m, low);
+		_mm256_storeu_ps(m + 8, high);
+	}
+}
+
+TARGET_AVX2 static void computeMVPsAVX2(const glm::mat4& PV, unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	const float* pv = &PV[0][0];
+
+	// PV's columns, paired up the way the results are: [PV0 | PV1] and [PV2 | PV3].
+	const __m256 pv01 = _mm256_loadu_ps(pv);
+	const __m256 pv23 = _mm256_loadu_ps(pv + 8);
+
+	// Each column duplicated into both halves, for building the translation column.
+	const __m256 pv00 = _mm256_permute2f128_ps(pv01, pv01, 0x00);
+	const __m256 pv11 = _mm256_permute2f128_ps(pv01, pv01, 0x11);
+	const __m256 pv22 = _mm256_permute2f128_ps(pv23, pv23, 0x00);
+	const __m256 pv33 = _mm256_permute2f128_ps(pv23, pv23, 0x11);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float* m = &out[i][0][0];
+
+		// [scale.x * PV0 | scale.y * PV1]. Broadcasting straight from memory is a single instruction, where building a register out of 8 separate floats is many.
+		__m256 scaleXY = _mm256_blend_ps(_mm256_broadcast_ss(&scales[i].x), _mm256_broadcast_ss(&scales[i].y), 0xF0);
+		__m256 low = _mm256_mul_ps(pv01, scaleXY);
+
+		// The translation column: position.x * PV0 + position.y * PV1 + position.z * PV2 + PV3. It's worked out in both halves,
+		// then the scale.z * PV2 column is blended into the bottom half.
+		__m256 translation = _mm256_fmadd_ps(pv00, _mm256_broadcast_ss(&positions[i].x), pv33);
+		translation = _mm256_fmadd_ps(pv11, _mm256_broadcast_ss(&positions[i].y), translation);
+		translation = _mm256_fmadd_ps(pv22, _mm256_broadcast_ss(&positions[i].z), translation);
+		__m256 high = _mm256_blend_ps(translation, _mm256_mul_ps(pv22, _mm256_broadcast_ss(&scales[i].z)), 0x0F);
+
+		_mm256_storeu_ps(m, low);
+		_mm256_storeu_ps(m + 8, high);
+	}
+}
+
+void computeTransforms(unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	if (transformBatchUsesAVX2())
+	{
+		computeTransformsAVX2(count, positions, scales, out);
+	}
+	else
+	{
+		computeTransformsScalar(count, positions, scales, out);
+	}
+}
+
+void computeMVPs(const glm::mat4& PV, unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out)
+{
+	if (transformBatchUsesAVX2())
+	{
+		computeMVPsAVX2(PV, count, positions, scales, out);
+	}
+	else
+	{
+		computeMVPsScalar(PV, count, positions, scales, out);
+	}
+}
+
+#endif // _TRANSFORM_BATCH_CPP
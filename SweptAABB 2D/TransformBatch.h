@@ -0,0 +1,73 @@
+/*
+Title: Swept AABB-2D
+File Name: TransformBatch.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _TRANSFORM_BATCH_H
+#define _TRANSFORM_BATCH_H
+
+#include "GLIncludes.h"
+
+// Builds the transform (and MVP) matrices of a whole array of bodies at once, like World::GetTransform and PV * GetTransform do one at a time.
+// Our bodies only have a position and a scale, so instead of building a translation and a scale matrix and multiplying full 4x4 matrices together,
+// each column of the result is worked out directly:
+//     transform = [ scale.x * X,  scale.y * Y,  scale.z * Z,  position + W ]  (X, Y, Z, W being the columns of the identity)
+//     PV * transform = [ scale.x * PV[0],  scale.y * PV[1],  scale.z * PV[2],  position.x * PV[0] + position.y * PV[1] + position.z * PV[2] + PV[3] ]
+// That's 24 multiplies and adds per MVP instead of 128 for two matrix products.
+// If the CPU has AVX2 (checked once at run time), each matrix is built with two 8-wide registers, one for each half of the matrix.
+
+// Marks a function that uses AVX2 intrinsics. GCC and Clang only let us use them inside functions marked for it (unless the whole program
+// is built with -mavx2, which would then crash on older CPUs). MSVC allows them anywhere. Only call such a function when transformBatchUsesAVX2() says so.
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define TARGET_AVX2
+#endif
+
+// Whether the AVX2 versions are being used. The other batch kernels (BoundsBatch, SweptBatch) go by this too.
+bool transformBatchUsesAVX2();
+
+// out[i] = translate(positions[i]) * scale(scales[i]) for count bodies.
+void computeTransforms(unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out);
+
+// out[i] = PV * translate(positions[i]) * scale(scales[i]) for count bodies.
+void computeMVPs(const glm::mat4& PV, unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out);
+
+// The plain C++ versions, always available. The functions above pick between these and the AVX2 ones.
+void computeTransformsScalar(unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out);
+void computeMVPsScalar(const glm::mat4& PV, unsigned int count, const glm::vec3* positions, const glm::vec3* scales, glm::mat4* out);
+
+#endif //_TRANSFORM_BATCH_H
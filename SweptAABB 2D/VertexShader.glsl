@@ -42,10 +42,34 @@ layout(location = 1) in vec4 in_color;		// Get in a vec4 for color
 
 out vec4 color; // Our vec4 color variable containing r, g, b, a
 
+#ifdef VERTEX_PULLING
+// When the program defines VERTEX_PULLING (see GLRender.h), the transform isn't passed in as a matrix. Instead every body's position and scale
+// sit in a shader storage buffer (filled by BodyBuffer), and each instance reads its own.
+struct Body
+{
+	vec2 position;
+	vec2 scale;
+};
+
+layout(std430, binding = 0) readonly buffer Bodies
+{
+	Body bodies[];
+};
+
+uniform mat4 PV;		// Projection * view, the same for every body
+uniform int firstBody;	// Where the bodies of the model being drawn start
+#else
 uniform mat4 MVP; // Our uniform MVP matrix to modify our position values
+#endif
 
 void main(void)
 {
 	color = in_color;	// Pass the color through
+#ifdef VERTEX_PULLING
+	// The transform of a 2D body is only a scale and then a translation, so there's no need to build a matrix for it.
+	Body body = bodies[firstBody + gl_InstanceID];
+	gl_Position = PV * vec4(in_position.xy * body.scale + body.position, in_position.z, 1.0);
+#else
 	gl_Position = MVP * vec4(in_position, 1.0); //w is 1.0, also notice cast to a vec4
+#endif
 }
\ No newline at end of file
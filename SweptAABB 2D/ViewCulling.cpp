@@ -0,0 +1,121 @@
+/*
+Title: Swept AABB-2D
+File Name: ViewCulling.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _VIEW_CULLING_CPP
+#define _VIEW_CULLING_CPP
+
+#include "ViewCulling.h"
+#include <algorithm>
+#include <cfloat>
+
+// Shared by ViewRectangle and PointOnPlane, so the rectangle's corners can reuse one inverse.
+static bool unprojectOntoPlane(const glm::mat4& inversePV, float ndcX, float ndcY, float planeZ, glm::vec3& out)
+{
+	// The same point of the screen on the near and far clipping planes, in world space.
+	glm::vec4 nearPoint = inversePV * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+	glm::vec4 farPoint = inversePV * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+	glm::vec3 start = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 end = glm::vec3(farPoint) / farPoint.w;
+
+	// Where the line between them crosses the plane.
+	float deltaZ = end.z - start.z;
+	if (deltaZ == 0.0f)
+	{
+		return false;
+	}
+
+	float t = (planeZ - start.z) / deltaZ;
+	out = start + (end - start) * t;
+	return true;
+}
+
+AABB ViewCuller::ViewRectangle(const glm::mat4& proj, const glm::mat4& view, float planeZ)
+{
+	glm::mat4 inversePV = glm::inverse(proj * view);
+
+	AABB rectangle(glm::vec3(FLT_MAX, FLT_MAX, -FLT_MAX), glm::vec3(-FLT_MAX, -FLT_MAX, FLT_MAX));
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+	for (int c = 0; c < 4; c++)
+	{
+		glm::vec3 hit;
+		if (!unprojectOntoPlane(inversePV, corners[c][0], corners[c][1], planeZ, hit))
+		{
+			continue;
+		}
+
+		rectangle.min.x = std::min(rectangle.min.x, hit.x);
+		rectangle.min.y = std::min(rectangle.min.y, hit.y);
+		rectangle.max.x = std::max(rectangle.max.x, hit.x);
+		rectangle.max.y = std::max(rectangle.max.y, hit.y);
+	}
+
+	return rectangle;
+}
+
+bool ViewCuller::PointOnPlane(const glm::mat4& proj, const glm::mat4& view, float ndcX, float ndcY, glm::vec3& out, float planeZ)
+{
+	return unprojectOntoPlane(glm::inverse(proj * view), ndcX, ndcY, planeZ, out);
+}
+
+const std::vector<unsigned int>& ViewCuller::Cull(World& world, const AABB& rectangle)
+{
+	found.clear();
+	visible.clear();
+
+	world.Query(rectangle, found);
+
+	// The broadphase gives us everything in the cells the rectangle touches, so check the actual boxes.
+	for (unsigned int i = 0; i < found.size(); i++)
+	{
+		unsigned int dense = world.DenseIndex(found[i]);
+		const AABB& box = world.Boxes()[dense];
+
+		if (box.max.x >= rectangle.min.x && box.min.x <= rectangle.max.x && box.max.y >= rectangle.min.y && box.min.y <= rectangle.max.y)
+		{
+			visible.push_back(dense);
+		}
+	}
+
+	// Going through the world's arrays in order is kinder to the cache than the grid's order.
+	std::sort(visible.begin(), visible.end());
+
+	return visible;
+}
+
+#endif // _VIEW_CULLING_CPP
@@ -0,0 +1,73 @@
+/*
+Title: Swept AABB-2D
+File Name: ViewCulling.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _VIEW_CULLING_H
+#define _VIEW_CULLING_H
+
+#include "World.h"
+#include <vector>
+
+// Works out which objects are on screen by asking the world's broadphase grid for everything inside the camera's view rectangle,
+// so drawing costs depend on how much is visible rather than on how big the whole world is.
+class ViewCuller
+{
+	std::vector<ObjectHandle> found;
+	std::vector<unsigned int> visible;
+
+public:
+	// The rectangle of the z = planeZ plane that the camera can see. Every corner of the screen is turned back into a ray through the
+	// inverse of proj * view, and the rectangle is the bounds of where those rays hit the plane. Works for perspective and orthographic cameras
+	// looking at the plane (if a corner ray never hits the plane, that corner is left out).
+	static AABB ViewRectangle(const glm::mat4& proj, const glm::mat4& view, float planeZ = 0.0f);
+
+	// Where the ray through a point on the screen (in normalized device coordinates, -1 to 1) hits the z = planeZ plane.
+	// Returns false if the ray runs parallel to the plane.
+	static bool PointOnPlane(const glm::mat4& proj, const glm::mat4& view, float ndcX, float ndcY, glm::vec3& out, float planeZ = 0.0f);
+
+	// Finds every object whose AABB overlaps the rectangle (in x and y) and returns their dense indices in increasing order.
+	// The broadphase only has to be up to date, which it is after World::EndStep.
+	const std::vector<unsigned int>& Cull(World&, const AABB& rectangle);
+
+	// The result of the last Cull.
+	const std::vector<unsigned int>& Visible()
+	{
+		return visible;
+	}
+};
+
+#endif //_VIEW_CULLING_H
@@ -0,0 +1,358 @@
+/*
+Title: Swept AABB-2D
+File Name: World.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _WORLD_CPP
+#define _WORLD_CPP
+
+#include "World.h"
+#include <algorithm>
+
+World::World()
+{
+	currentStep = 0;
+}
+
+// The bounds of the model's vertices. The model works them out once when it's made, so this is just a copy no matter how many vertices it has.
+// A null model gets the -1 to 1 square.
+static AABB computeLocalBox(Model* model)
+{
+	AABB localBox(glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f));
+
+	if (model != nullptr && model->NumVertices() > 0)
+	{
+		localBox.min = model->LocalMin();
+		localBox.max = model->LocalMax();
+	}
+
+	return localBox;
+}
+
+void World::Reserve(unsigned int count)
+{
+	pool.Reserve(count);
+	positions.reserve(count);
+	velocities.reserve(count);
+	accelerations.reserve(count);
+	scales.reserve(count);
+	localBoxes.reserve(count);
+	boxes.reserve(count);
+	models.reserve(count);
+}
+
+ObjectHandle World::Spawn(Model* model, glm::vec3 pos, glm::vec3 vel, glm::vec3 scale)
+{
+	// The pool always puts new objects at the end of the dense arrays, so we just push_back onto every array.
+	ObjectHandle handle = pool.Allocate();
+
+	positions.push_back(pos);
+	velocities.push_back(vel);
+	accelerations.push_back(glm::vec3(0.0f));
+	scales.push_back(scale);
+	localBoxes.push_back(computeLocalBox(model));
+	boxes.push_back(AABB());
+	models.push_back(model);
+
+	unsigned int dense = pool.Size() - 1;
+	CalculateAABB(dense);
+	broadphase.Insert(handle.index, boxes[dense]);
+
+	return handle;
+}
+
+void World::SpawnBulk(unsigned int count, Model* model, const glm::vec3* inPositions, const glm::vec3* inVelocities, const glm::vec3* inScales, ObjectHandle* outHandles)
+{
+	unsigned int first = pool.Size();
+
+	// Every object in the batch shares the model, so its bounds only get calculated once.
+	AABB localBox = computeLocalBox(model);
+
+	// Copy each input array straight onto the end of the matching world array.
+	positions.insert(positions.end(), inPositions, inPositions + count);
+	velocities.insert(velocities.end(), inVelocities, inVelocities + count);
+	scales.insert(scales.end(), inScales, inScales + count);
+	accelerations.resize(first + count, glm::vec3(0.0f));
+	localBoxes.resize(first + count, localBox);
+	boxes.resize(first + count);
+	models.resize(first + count, model);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		ObjectHandle handle = pool.Allocate();
+
+		if (outHandles != nullptr)
+		{
+			outHandles[i] = handle;
+		}
+	}
+
+	// Now that everything is in place, do all of the AABB work in one loop.
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		CalculateAABB(i);
+	}
+
+	// If the batch is a big part of the world, building the grid from scratch is cheaper than inserting into it one at a time.
+	if (count * 4 >= pool.Size())
+	{
+		RebuildBroadphase();
+	}
+	else
+	{
+		for (unsigned int i = first; i < first + count; i++)
+		{
+			broadphase.Insert(pool.HandleAt(i).index, boxes[i]);
+		}
+	}
+}
+
+void World::DestroyBulk(unsigned int count, const ObjectHandle* handles)
+{
+	// Same idea as SpawnBulk: with a big batch, don't bother removing objects from the broadphase one by one. Rebuild it once at the end.
+	bool rebuild = count * 4 >= pool.Size();
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (!pool.IsValid(handles[i]))
+		{
+			continue;
+		}
+
+		if (!rebuild)
+		{
+			broadphase.Remove(handles[i].index);
+		}
+
+		RemoveDense(pool.Free(handles[i]));
+	}
+
+	if (rebuild)
+	{
+		RebuildBroadphase();
+	}
+}
+
+void World::Query(const AABB& box, std::vector<ObjectHandle>& out)
+{
+	std::vector<unsigned int> ids;
+	broadphase.Query(box, ids);
+
+	for (unsigned int i = 0; i < ids.size(); i++)
+	{
+		out.push_back(pool.SlotHandle(ids[i]));
+	}
+}
+
+void World::UpdateBroadphase()
+{
+	for (unsigned int i = 0; i < pool.Size(); i++)
+	{
+		broadphase.Update(pool.HandleAt(i).index, boxes[i]);
+	}
+}
+
+void World::RebuildBroadphase()
+{
+	std::vector<unsigned int> ids(pool.Size());
+	for (unsigned int i = 0; i < pool.Size(); i++)
+	{
+		ids[i] = pool.HandleAt(i).index;
+	}
+
+	broadphase.Build(ids.data(), boxes.data(), pool.Size());
+}
+
+void World::Teleport(ObjectHandle handle, glm::vec3 pos)
+{
+	if (!pool.IsValid(handle))
+	{
+		return;
+	}
+
+	unsigned int dense = pool.DenseIndex(handle);
+	positions[dense] = pos;
+	CalculateAABB(dense);
+	broadphase.Update(handle.index, boxes[dense]);
+}
+
+void World::Destroy(ObjectHandle handle)
+{
+	// If a producer sends Destroy twice for the same object, the second one is stale and does nothing.
+	if (!pool.IsValid(handle))
+	{
+		return;
+	}
+
+	broadphase.Remove(handle.index);
+
+	RemoveDense(pool.Free(handle));
+}
+
+void World::RemoveDense(unsigned int dense)
+{
+	// Swap and pop: move the last object into the hole and shrink every array by one.
+	unsigned int last = (unsigned int)positions.size() - 1;
+
+	positions[dense] = positions[last];
+	velocities[dense] = velocities[last];
+	accelerations[dense] = accelerations[last];
+	scales[dense] = scales[last];
+	localBoxes[dense] = localBoxes[last];
+	boxes[dense] = boxes[last];
+	models[dense] = models[last];
+
+	positions.pop_back();
+	velocities.pop_back();
+	accelerations.pop_back();
+	scales.pop_back();
+	localBoxes.pop_back();
+	boxes.pop_back();
+	models.pop_back();
+}
+
+void World::UpdateObject(unsigned int dense, float dt)
+{
+	velocities[dense] += accelerations[dense] * dt;
+	positions[dense] += velocities[dense] * dt;
+}
+
+void World::CalculateAABB(unsigned int dense)
+{
+	// With only a position and a scale there's no need to transform every vertex like GameObject::CalculateAABB does.
+	// Scaling the model's own bounds gives the same box. (A negative scale flips min and max, hence the min/max.)
+	glm::vec3 a = localBoxes[dense].min * scales[dense];
+	glm::vec3 b = localBoxes[dense].max * scales[dense];
+
+	boxes[dense].min = positions[dense] + glm::min(a, b);
+	boxes[dense].max = positions[dense] + glm::max(a, b);
+}
+
+glm::mat4 World::GetTransform(unsigned int dense)
+{
+	// Same order as GameObject::CalculateMatrices, just without a rotation.
+	return glm::scale(glm::translate(glm::mat4(), positions[dense]), scales[dense]);
+}
+
+void World::ApplyCommand(WorldCommand* command)
+{
+	if (command->type == COMMAND_SPAWN)
+	{
+		Spawn(command->model, command->position, command->velocity, command->scale);
+		return;
+	}
+
+	// The rest of the commands refer to an existing object, so make sure it hasn't already been destroyed.
+	// Thanks to the generation in the handle, this also catches a handle whose slot has since been given to a new object.
+	if (!pool.IsValid(command->target))
+	{
+		return;
+	}
+
+	unsigned int dense = pool.DenseIndex(command->target);
+
+	switch (command->type)
+	{
+	case COMMAND_DESTROY:
+		Destroy(command->target);
+		break;
+	case COMMAND_SET_VELOCITY:
+		velocities[dense] = command->velocity;
+		break;
+	case COMMAND_ADD_VELOCITY:
+		velocities[dense] += command->velocity;
+		break;
+	case COMMAND_TELEPORT:
+		positions[dense] = command->position;
+		CalculateAABB(dense);
+		break;
+	default:
+		break;
+	}
+}
+
+void World::BeginStep()
+{
+	// Drain the producers in the order they were created, and each producer's commands in the order they were pushed.
+	// That way the result doesn't depend on which thread happened to get there first.
+	int numProducers = commands.NumProducers();
+
+	for (int i = 0; i < numProducers; i++)
+	{
+		// Take at most one queue's worth per producer, so a thread that never stops pushing can't keep the physics thread here forever.
+		for (unsigned int n = 0; n < CommandQueue::Size; n++)
+		{
+			WorldCommand* command = commands.Next(i, currentStep);
+
+			if (command == nullptr)
+			{
+				break;
+			}
+
+			ApplyCommand(command);
+			commands.Pop(i);
+		}
+	}
+}
+
+void World::EndStep()
+{
+	// Objects have moved, so the grid needs to catch up before anyone queries it.
+	UpdateBroadphase();
+
+	// If slow readers are holding on to every spare slot we skip this snapshot. They'll get the next one.
+	WorldSnapshot* snapshot = snapshots.BeginWrite();
+
+	if (snapshot != nullptr)
+	{
+		// The arrays are already packed, so a snapshot is just a copy of each of them.
+		snapshot->step = currentStep;
+		snapshot->handles.resize(pool.Size());
+		for (unsigned int i = 0; i < pool.Size(); i++)
+		{
+			snapshot->handles[i] = pool.HandleAt(i);
+		}
+		snapshot->positions.assign(positions.begin(), positions.end());
+		snapshot->velocities.assign(velocities.begin(), velocities.end());
+		snapshot->boxes.assign(boxes.begin(), boxes.end());
+
+		snapshots.Publish(snapshot);
+	}
+
+	currentStep++;
+}
+
+#endif // _WORLD_CPP
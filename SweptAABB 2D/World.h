@@ -0,0 +1,240 @@
+/*
+Title: Swept AABB-2D
+File Name: World.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include "GameObject.h"
+#include "ObjectPool.h"
+#include "Broadphase.h"
+#include "CommandQueue.h"
+#include "WorldSnapshot.h"
+#include <vector>
+
+// The World owns every object that takes part in the physics simulation.
+// Objects are referred to by ObjectHandle. Their data is stored as a structure of arrays: one tightly packed array per property,
+// where dense index i in every array belongs to the same object. The arrays never have holes, so a physics step is just a loop from 0 to NumObjects().
+// World objects only have a position and a scale (no rotation), which is all our 2D bodies need.
+//
+// Other threads must not touch the objects directly while a step may be running. Instead they push commands through a CommandProducer,
+// and the physics thread applies them all at once in BeginStep(), before it moves anything.
+class World
+{
+	ObjectPool pool;
+
+	// The dense arrays, all NumObjects() long.
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> velocities;
+	std::vector<glm::vec3> accelerations;
+	std::vector<glm::vec3> scales;
+	std::vector<AABB> localBoxes;	// The bounds of the model itself, before position and scale.
+	std::vector<AABB> boxes;		// The world-space AABB, kept up to date by CalculateAABB().
+	std::vector<Model*> models;
+
+	// Finds the objects near a box. Objects are stored in it by the slot index of their handle.
+	Broadphase broadphase;
+
+	CommandBuffer commands;
+
+	// Copies of the world from the last finished steps, for threads that want to read while the next step runs.
+	SnapshotBuffer snapshots;
+
+	// The number of physics steps that have been started. Commands tagged with a step wait until this reaches it.
+	unsigned int currentStep;
+
+	void ApplyCommand(WorldCommand*);
+
+	// Swap and pop the dense arrays after the pool freed the object at this dense index.
+	void RemoveDense(unsigned int);
+
+public:
+	World();
+
+	// Makes room for this many objects up front, so spawning doesn't reallocate in the middle of a game.
+	void Reserve(unsigned int);
+
+	// Creates an object from the model at the given position, velocity and scale. Only call this from the physics thread.
+	// A null model is treated as a square from -1 to 1, like the one the demo uses.
+	ObjectHandle Spawn(Model*, glm::vec3, glm::vec3, glm::vec3);
+
+	// Removes the object. Stale or null handles are ignored. Only call this from the physics thread.
+	// Note that this moves the last object into the removed object's dense index.
+	void Destroy(ObjectHandle);
+
+	// Spawns count objects at once from arrays of positions, velocities and scales, all using the same model, and writes their handles to outHandles (if it isn't null).
+	// The AABBs and broadphase are only updated once at the end. If the batch is big compared to the world, the broadphase is rebuilt from scratch instead.
+	void SpawnBulk(unsigned int count, Model*, const glm::vec3* positions, const glm::vec3* velocities, const glm::vec3* scales, ObjectHandle* outHandles);
+
+	// Destroys count objects at once. Like Destroy, stale handles are skipped. Rebuilds the broadphase instead of removing one by one when the batch is big.
+	void DestroyBulk(unsigned int count, const ObjectHandle* handles);
+
+	// Finds the handles of every object that might overlap the box (adding them to out). Uses the broadphase as it was at the end of the last step or spawn.
+	void Query(const AABB&, std::vector<ObjectHandle>& out);
+
+	// Brings the broadphase up to date with everyone's current AABB. EndStep() does this for you.
+	void UpdateBroadphase();
+
+	// Throws the broadphase away and builds it again from every object in one pass.
+	void RebuildBroadphase();
+
+	// Moves the object right now, outside of a step, and puts its new AABB straight into the broadphase so queries (and view culling) see it
+	// before the next EndStep. Meant for late changes just before drawing. Inside a step, SetPosition or a teleport command does the job.
+	void Teleport(ObjectHandle, glm::vec3 pos);
+
+	bool IsValid(ObjectHandle handle)
+	{
+		return pool.IsValid(handle);
+	}
+
+	// Gives a thread its own lock-free queue to send commands to the world through.
+	CommandProducer CreateProducer()
+	{
+		return commands.CreateProducer();
+	}
+
+	// Applies all of the queued commands that are due. Call this on the physics thread at the start of every step.
+	void BeginStep();
+
+	// Marks the step as finished and publishes a snapshot of it for reader threads.
+	void EndStep();
+
+	// Reader threads use this (through a SnapshotReader) to look at the last finished step.
+	SnapshotBuffer& Snapshots()
+	{
+		return snapshots;
+	}
+
+	unsigned int CurrentStep()
+	{
+		return currentStep;
+	}
+
+	// These work on dense indices, from 0 to NumObjects() - 1.
+	unsigned int NumObjects()
+	{
+		return pool.Size();
+	}
+	ObjectHandle HandleAt(unsigned int dense)
+	{
+		return pool.HandleAt(dense);
+	}
+	unsigned int DenseIndex(ObjectHandle handle)
+	{
+		return pool.DenseIndex(handle);
+	}
+
+	// Does basic physics calculations based on dt for the object at the dense index, like GameObject::Update.
+	void UpdateObject(unsigned int, float);
+
+	// Recalculates the world-space AABB of the object at the dense index from its position and scale.
+	void CalculateAABB(unsigned int);
+
+	// Builds the object's transformation matrix (translation * scale).
+	glm::mat4 GetTransform(unsigned int);
+
+	// Our get and set functions. The handle must be valid.
+	glm::vec3 GetPosition(ObjectHandle handle)
+	{
+		return positions[pool.DenseIndex(handle)];
+	}
+	glm::vec3 GetVelocity(ObjectHandle handle)
+	{
+		return velocities[pool.DenseIndex(handle)];
+	}
+	glm::vec3 GetScale(ObjectHandle handle)
+	{
+		return scales[pool.DenseIndex(handle)];
+	}
+	AABB GetAABB(ObjectHandle handle)
+	{
+		return boxes[pool.DenseIndex(handle)];
+	}
+	AABB GetLocalBox(unsigned int dense)
+	{
+		return localBoxes[dense];
+	}
+	Model* GetModel(ObjectHandle handle)
+	{
+		return models[pool.DenseIndex(handle)];
+	}
+
+	void SetPosition(ObjectHandle handle, glm::vec3 pos)
+	{
+		positions[pool.DenseIndex(handle)] = pos;
+	}
+	void SetVelocity(ObjectHandle handle, glm::vec3 vel)
+	{
+		velocities[pool.DenseIndex(handle)] = vel;
+	}
+	void AddVelocity(ObjectHandle handle, glm::vec3 vel)
+	{
+		velocities[pool.DenseIndex(handle)] += vel;
+	}
+	void SetAcceleration(ObjectHandle handle, glm::vec3 accel)
+	{
+		accelerations[pool.DenseIndex(handle)] = accel;
+	}
+	void SetScale(ObjectHandle handle, glm::vec3 scale)
+	{
+		scales[pool.DenseIndex(handle)] = scale;
+	}
+
+	// Direct access to the dense arrays, for systems that loop over every object.
+	glm::vec3* Positions()
+	{
+		return positions.data();
+	}
+	glm::vec3* Velocities()
+	{
+		return velocities.data();
+	}
+	glm::vec3* Scales()
+	{
+		return scales.data();
+	}
+	AABB* Boxes()
+	{
+		return boxes.data();
+	}
+	Model** Models()
+	{
+		return models.data();
+	}
+};
+
+#endif //_WORLD_H
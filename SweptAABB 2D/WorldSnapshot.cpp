@@ -0,0 +1,106 @@
+/*
+Title: Swept AABB-2D
+File Name: WorldSnapshot.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _WORLD_SNAPSHOT_CPP
+#define _WORLD_SNAPSHOT_CPP
+
+#include "WorldSnapshot.h"
+
+SnapshotBuffer::SnapshotBuffer()
+{
+	for (int i = 0; i < NumSlots; i++)
+	{
+		readers[i].store(0);
+	}
+
+	published.store(-1);
+}
+
+WorldSnapshot* SnapshotBuffer::BeginWrite()
+{
+	int current = published.load();
+
+	for (int i = 0; i < NumSlots; i++)
+	{
+		// Never touch the published slot, since new readers may grab it at any moment.
+		// Any other slot with no readers is safe: a reader that picks it up late will see it's no longer published and let go of it again.
+		if (i != current && readers[i].load() == 0)
+		{
+			return &slots[i];
+		}
+	}
+
+	return nullptr;
+}
+
+void SnapshotBuffer::Publish(WorldSnapshot* snapshot)
+{
+	// This is the only place the published slot changes. Everything written into the slot before this is visible to readers that see the new value.
+	published.exchange((int)(snapshot - slots));
+}
+
+const WorldSnapshot* SnapshotBuffer::Acquire(int& slot)
+{
+	while (true)
+	{
+		slot = published.load();
+
+		if (slot < 0)
+		{
+			return nullptr;
+		}
+
+		// Mark the slot as being read, then check that it is still the published one.
+		// If the writer published something else in between, it may already be writing into this slot, so let go and try again with the new one.
+		readers[slot].fetch_add(1);
+
+		if (published.load() == slot)
+		{
+			return &slots[slot];
+		}
+
+		readers[slot].fetch_sub(1);
+	}
+}
+
+void SnapshotBuffer::Release(int slot)
+{
+	readers[slot].fetch_sub(1);
+}
+
+#endif // _WORLD_SNAPSHOT_CPP
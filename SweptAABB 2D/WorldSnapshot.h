@@ -0,0 +1,144 @@
+/*
+Title: Swept AABB-2D
+File Name: WorldSnapshot.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Swept Axis Aligned Bounding Box collision test. This goes beyond a standard
+AABB test to determine the time and axis of collision. This is in 2D.
+Contains two squares, one that is stationary and one that is moving. They are bounded
+by AABBs (Axis-Aligned Bounding Boxes) and when these AABBs collide the moving object
+"bounces" on the axis of collision.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The Swept portion of this algorithm determines
+when the collision will actually happen (so if your velocity is 10, and you are a distance
+of 5 away from the collision, it will detect this) and will perform the collision response
+(bounce, in this case) before the end of the frame, so you can prevent tunneling (where the
+object passes through or into the middle of the colliding object).
+*/
+
+
+#ifndef _WORLD_SNAPSHOT_H
+#define _WORLD_SNAPSHOT_H
+
+#include "GameObject.h"
+#include "ObjectPool.h"
+#include <atomic>
+#include <vector>
+
+// A read-only copy of the world at the end of one physics step.
+// Index i in every array refers to the same object, in the same (dense) order the world had them when the snapshot was taken.
+struct WorldSnapshot
+{
+	unsigned int step;
+
+	std::vector<ObjectHandle> handles;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> velocities;
+	std::vector<AABB> boxes;
+
+	WorldSnapshot()
+	{
+		step = 0;
+	}
+
+	int NumObjects() const
+	{
+		return (int)positions.size();
+	}
+};
+
+// Lets renderers, AI and query threads read the last finished step while the physics thread is already computing the next one.
+// There is one writer (the physics thread) and any number of readers. The writer fills in a slot nobody is reading and then publishes it
+// with a single atomic exchange, so readers never wait on the writer and the writer never waits on readers.
+class SnapshotBuffer
+{
+public:
+	// One slot is published, one is being written, and the rest are there for readers that hold on to an older snapshot for a while.
+	static const int NumSlots = 4;
+
+private:
+	WorldSnapshot slots[NumSlots];
+
+	// How many readers are currently looking at each slot. The writer only reuses slots with no readers.
+	std::atomic<int> readers[NumSlots];
+
+	// The slot readers should use, or -1 if nothing has been published yet.
+	std::atomic<int> published;
+
+public:
+	SnapshotBuffer();
+
+	// Writer side. Returns a slot that is safe to overwrite, or nullptr if readers are holding on to all of them (then just skip publishing this step).
+	WorldSnapshot* BeginWrite();
+
+	// Writer side. Makes the slot from BeginWrite the one new readers will see.
+	void Publish(WorldSnapshot*);
+
+	// Reader side. Returns the latest published snapshot and fills in its slot, or returns nullptr if there isn't one yet.
+	// Every successful Acquire must be paired with a Release of the same slot. SnapshotReader does this for you.
+	const WorldSnapshot* Acquire(int& slot);
+	void Release(int slot);
+};
+
+// Holds on to the latest snapshot for as long as it is in scope.
+// Usage:
+//     SnapshotReader reader(world.Snapshots());
+//     if (reader.IsValid()) { ... reader->positions[i] ... }
+class SnapshotReader
+{
+	SnapshotBuffer* buffer;
+	const WorldSnapshot* snapshot;
+	int slot;
+
+	// Copying would release the same slot twice.
+	SnapshotReader(const SnapshotReader&);
+	SnapshotReader& operator=(const SnapshotReader&);
+
+public:
+	SnapshotReader(SnapshotBuffer& inBuffer)
+	{
+		buffer = &inBuffer;
+		snapshot = buffer->Acquire(slot);
+	}
+	~SnapshotReader()
+	{
+		if (snapshot != nullptr)
+		{
+			buffer->Release(slot);
+		}
+	}
+
+	bool IsValid()
+	{
+		return snapshot != nullptr;
+	}
+	const WorldSnapshot* operator->()
+	{
+		return snapshot;
+	}
+	const WorldSnapshot& operator*()
+	{
+		return *snapshot;
+	}
+};
+
+#endif //_WORLD_SNAPSHOT_H